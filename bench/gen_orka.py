@@ -0,0 +1,130 @@
+#!/usr/bin/python3
+##
+## Generates a large, synthetic Orka source file for the benchmarks
+##
+## Usage: gen_orka.py <output> [lines] [--parse | --scopes]
+##
+## By default the output only has to lex; with --parse, it is a program that
+## the parser accepts as well. With --scopes, it is a program with thousands
+## of global constants and functions made of deeply nested loops, to measure
+## the cost of symbol lookups across scopes.
+##
+import sys
+
+output = sys.argv[1]
+line_count = 1000000
+if len(sys.argv) > 2:
+    line_count = int(sys.argv[2])
+parse = "--parse" in sys.argv[3:]
+scopes = "--scopes" in sys.argv[3:]
+
+# Each function body is made of these statements, which together cover
+# keywords, identifiers, literals, comments, and one- and two-char symbols
+body = [
+    "    var x{n} : int := {n} + y * (z - 3);",
+    "    var s{n} : str := \"value {n}\\n\";",
+    "    # Comment line {n}",
+    "    if x{n} >= 10 and y <= 20 then",
+    "        y := y + x{n} % 7;",
+    "    elif x{n} != 0 or flag then",
+    "        arr[{n} % 10] := 0x1F;",
+    "    else",
+    "        printf(\"%d|\", x{n});",
+    "    end",
+    "    while y < {n} do",
+    "        y := y + 1;",
+    "        continue;",
+    "    end",
+    "    for i in 0 .. 10 step 2 do",
+    "        ch := 'a';",
+    "    end",
+    "    f := 3.14 * 2.0;",
+]
+
+# The same kind of statements, limited to what the parser accepts
+parse_body = [
+    "    var x{f} : int := {n} + y * (z - 3);",
+    "    var s{f} : str := \"value {n}\";",
+    "    # Comment line {n}",
+    "    if x{f} >= 10 and y <= 20 then",
+    "        y := y + x{f} % 7;",
+    "    elif x{f} != 0 or flag then",
+    "        arr[{n} % 10] := 0x1F;",
+    "    else",
+    "        y := bench{f}(x{f}, z);",
+    "    end",
+    "    while y < {n} do",
+    "        y := y + 1;",
+    "        continue;",
+    "    end",
+    "    for i in 0 .. 10 step 2 do",
+    "        ch := 'a';",
+    "    end",
+    "    f := 3.14 * 2.0;",
+]
+
+if parse:
+    body = parse_body
+
+# The nesting depth of the loops in each --scopes function
+depth = 8
+
+def write_scopes(writer):
+    globals = line_count // 4
+    for i in range(globals):
+        writer.write("const G" + str(i) + " : int := " + str(i) + ";\n")
+    writer.write("\n")
+
+    written = globals + 1
+    func_num = 0
+    while written < line_count:
+        writer.write("func scope" + str(func_num) + "(y:int) -> int is\n")
+        for d in range(depth):
+            indent = "    " * (d + 1)
+            g = (func_num * depth + d) % globals
+            writer.write(indent + "var a" + str(d) + " : int := G" + str(g) + " + y;\n")
+            writer.write(indent + "while a" + str(d) + " < 10 do\n")
+
+        indent = "    " * (depth + 1)
+        writer.write(indent + "y := y + scope" + str(func_num) + "(a0 + a" + str(depth - 1) + ");\n")
+
+        for d in reversed(range(depth)):
+            indent = "    " * (d + 1)
+            writer.write(indent + "    a" + str(d) + " := a" + str(d) + " + 1;\n")
+            writer.write(indent + "end\n")
+
+        writer.write("    return y;\n")
+        writer.write("end\n")
+        writer.write("\n")
+        written += depth * 4 + 5
+        func_num += 1
+
+if scopes:
+    with open(output, "w") as writer:
+        write_scopes(writer)
+    sys.exit(0)
+
+with open(output, "w") as writer:
+    written = 0
+    func_num = 0
+    while written < line_count:
+        writer.write("func bench" + str(func_num) + "(y:int, z:int) -> int is\n")
+        writer.write("    var flag : bool := true;\n")
+        if parse:
+            writer.write("    array arr : int[10];\n")
+            writer.write("    var ch : char := 'a';\n")
+            writer.write("    var f : double := 0.0;\n")
+            written += 2
+        else:
+            writer.write("    var arr : int[10];\n")
+        written += 3
+
+        for i, line in enumerate(body):
+            writer.write(line.format(n = func_num * len(body) + i, f = func_num) + "\n")
+        written += len(body)
+
+        writer.write("    return y;\n")
+        writer.write("end\n")
+        writer.write("\n")
+        written += 3
+        func_num += 1
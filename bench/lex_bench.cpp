@@ -0,0 +1,50 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+
+#include <lex/lex.hpp>
+
+//
+// Lexes an Orka source file several times and reports the best throughput
+//
+// Usage: orka_lex_bench <file> [runs]
+//
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cerr << "Error: No input file specified." << std::endl;
+        return 1;
+    }
+
+    std::string input = argv[1];
+    int runs = 5;
+    if (argc > 2) runs = std::atoi(argv[2]);
+
+    double best = 0;
+    size_t count = 0;
+
+    for (int i = 0; i<runs; i++) {
+        auto start = std::chrono::steady_clock::now();
+
+        Lex lex(input);
+        count = 0;
+        int t = lex.get_next();
+        while (t != t_eof) {
+            ++count;
+            t = lex.get_next();
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        double rate = count / elapsed.count();
+        if (rate > best) best = rate;
+    }
+
+    std::cout << "Tokens: " << count << std::endl;
+    std::cout << "Tokens/sec: " << (size_t)best << std::endl;
+    return 0;
+}
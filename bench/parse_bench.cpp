@@ -0,0 +1,71 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#include <iostream>
+#include <string>
+#include <memory>
+#include <chrono>
+#include <cstdlib>
+
+#include <malloc.h>
+#include <sys/resource.h>
+
+#include <parser/Parser.hpp>
+
+//
+// Parses an Orka source file several times and reports the best times to
+// build and to free the tree, the heap memory the tree holds, and the peak
+// memory use
+//
+// Usage: orka_parse_bench <file> [runs]
+//
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cerr << "Error: No input file specified." << std::endl;
+        return 1;
+    }
+
+    std::string input = argv[1];
+    int runs = 5;
+    if (argc > 2) runs = std::atoi(argv[2]);
+
+    double best_parse = 0;
+    double best_free = 0;
+    size_t tree_bytes = 0;
+
+    for (int i = 0; i<runs; i++) {
+        size_t heap_start = mallinfo2().uordblks;
+        auto start = std::chrono::steady_clock::now();
+
+        auto parser = std::make_unique<Parser>(input);
+        if (!parser->parse()) {
+            std::cerr << "Error: Unable to parse " << input << "." << std::endl;
+            return 1;
+        }
+        std::shared_ptr<AstTree> tree = parser->getTree();
+
+        std::chrono::duration<double> parse_time = std::chrono::steady_clock::now() - start;
+
+        parser.reset();
+        tree_bytes = mallinfo2().uordblks - heap_start;
+        start = std::chrono::steady_clock::now();
+
+        tree.reset();
+
+        std::chrono::duration<double> free_time = std::chrono::steady_clock::now() - start;
+
+        if (i == 0 || parse_time.count() < best_parse) best_parse = parse_time.count();
+        if (i == 0 || free_time.count() < best_free) best_free = free_time.count();
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    std::cout << "Parse: " << (size_t)(best_parse * 1000) << " ms" << std::endl;
+    std::cout << "Free: " << (size_t)(best_free * 1000) << " ms" << std::endl;
+    std::cout << "Tree: " << tree_bytes / (1024 * 1024) << " MB" << std::endl;
+    std::cout << "Peak RSS: " << usage.ru_maxrss / 1024 << " MB" << std::endl;
+    return 0;
+}
@@ -0,0 +1,114 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <memory>
+#include <chrono>
+#include <functional>
+#include <vector>
+#include <cstdlib>
+
+#include <parser/Parser.hpp>
+#include <intr/interpreter.hpp>
+#include <intr/bytecode.hpp>
+
+//
+// Runs Riya programs with the tree interpreter and with the bytecode VM, and
+// reports the best time of each, the time to compile the bytecode, and the
+// speedup. The output of the programs is thrown away.
+//
+// Usage: riyai_bench [-runs=N] <files...>
+//
+static double best_of(int runs, std::function<void()> body) {
+    double best = 0;
+    for (int i = 0; i<runs; i++) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+        if (i == 0 || time.count() < best) best = time.count();
+    }
+    return best;
+}
+
+int main(int argc, char **argv) {
+    int runs = 5;
+    std::vector<std::string> inputs;
+    for (int i = 1; i<argc; i++) {
+        std::string arg = argv[i];
+        if (arg.find("-runs=") == 0) runs = std::atoi(arg.c_str() + 6);
+        else inputs.push_back(arg);
+    }
+
+    if (inputs.empty()) {
+        std::cerr << "Error: No input file specified." << std::endl;
+        return 1;
+    }
+
+    std::cout << std::left << std::setw(24) << "program" << std::right;
+    std::cout << std::setw(12) << "tree (us)" << std::setw(12) << "compile" << std::setw(12) << "vm (us)";
+    std::cout << std::setw(10) << "speedup" << std::endl;
+
+    double tree_total = 0;
+    double vm_total = 0;
+
+    for (auto const &input : inputs) {
+        auto parser = std::make_unique<Parser>(input, true);
+        if (!parser->parse()) {
+            std::cerr << "Error: Unable to parse " << input << "." << std::endl;
+            return 1;
+        }
+        auto tree = parser->getTree();
+
+        std::string name = input.substr(input.find_last_of('/') + 1);
+        std::shared_ptr<BcProgram> program;
+        auto compiler = std::make_unique<BytecodeCompiler>(tree);
+
+        std::ostringstream discard;
+        auto *saved = std::cout.rdbuf(discard.rdbuf());
+
+        double tree_time = best_of(runs, [&]() {
+            auto intr = std::make_unique<AstInterpreter>(tree);
+            intr->run();
+            discard.str("");
+        });
+
+        double compile_time = best_of(runs, [&]() {
+            compiler = std::make_unique<BytecodeCompiler>(tree);
+            program = compiler->compile();
+        });
+
+        double vm_time = 0;
+        if (program) {
+            vm_time = best_of(runs, [&]() {
+                auto vm = std::make_unique<BytecodeVM>(program);
+                vm->run();
+                discard.str("");
+            });
+        }
+
+        std::cout.rdbuf(saved);
+
+        std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(0);
+        std::cout << std::setw(12) << tree_time * 1e6;
+        if (!program) {
+            std::cout << "   (" << compiler->error() << ")" << std::endl;
+            continue;
+        }
+
+        std::cout << std::setw(12) << compile_time * 1e6 << std::setw(12) << vm_time * 1e6;
+        std::cout << std::setprecision(1) << std::setw(9) << tree_time / (compile_time + vm_time) << "x" << std::endl;
+
+        tree_total += tree_time;
+        vm_total += compile_time + vm_time;
+    }
+
+    if (vm_total > 0) {
+        std::cout << std::endl << "Total speedup: " << std::setprecision(1) << tree_total / vm_total << "x" << std::endl;
+    }
+    return 0;
+}
@@ -4,6 +4,7 @@
 // See COPYING for more info.
 //
 #include <iostream>
+#include <algorithm>
 
 #include <ast/ast.hpp>
 
@@ -97,7 +98,13 @@ void AstBlock::print(int indent) {
     for (int i = 0; i<indent; i++) std::cout << " ";
     std::cout << "[" << std::endl;
     
-    for (auto const &x : symbolTable) {
+    // The table is unordered, so sort by name for stable output
+    std::vector<std::pair<Symbol, std::shared_ptr<AstDataType>>> symbols(symbolTable.begin(), symbolTable.end());
+    std::sort(symbols.begin(), symbols.end(), [](auto const &a, auto const &b) {
+        return a.first.str() < b.first.str();
+    });
+    
+    for (auto const &x : symbols) {
         for (int i = 0; i<indent+2; i++) std::cout << " ";
         std::cout << "SYM: " << x.first << " : ";
         if (x.second) x.second->print();
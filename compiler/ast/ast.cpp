@@ -5,6 +5,7 @@
 //
 #include <algorithm>
 #include <vector>
+#include <unordered_set>
 
 #include <ast/ast.hpp>
 
@@ -34,14 +35,14 @@ AstPointerType::AstPointerType(std::shared_ptr<AstDataType> base_type) : AstData
 //
 // AstStructType
 //
-AstStructType::AstStructType(std::string name) : AstDataType(V_AstType::Struct) {
+AstStructType::AstStructType(Symbol name) : AstDataType(V_AstType::Struct) {
     this->name = name;
 }
 
 //
 // AstObjectType
 //
-AstObjectType::AstObjectType(std::string name) : AstDataType(V_AstType::Object) {
+AstObjectType::AstObjectType(Symbol name) : AstDataType(V_AstType::Object) {
     this->name = name;
 }
 
@@ -49,7 +50,7 @@ AstObjectType::AstObjectType(std::string name) : AstDataType(V_AstType::Object)
 // Var
 //
 Var::Var() {}
-Var::Var(std::shared_ptr<AstDataType> type, std::string name) {
+Var::Var(std::shared_ptr<AstDataType> type, Symbol name) {
     this->type = type;
     this->name = name;
 }
@@ -57,7 +58,7 @@ Var::Var(std::shared_ptr<AstDataType> type, std::string name) {
 //
 // AstStruct
 //
-AstStruct::AstStruct(std::string name) : AstNode(V_AstType::StructDef) {
+AstStruct::AstStruct(Symbol name) : AstNode(V_AstType::StructDef) {
     this->name = name;
 }
 
@@ -85,18 +86,59 @@ void AstStruct::addItem(Var var, std::shared_ptr<AstExpression> default_expressi
 //
 AstTree::AstTree(std::string file) {
     this-> file = file;
-    this->block = std::make_shared<AstBlock>();
+    this->context = std::make_shared<AstContext>();
+    this->block = context->create<AstBlock>();
 }
 
 AstTree::~AstTree() {}
 
-bool AstTree::hasStruct(std::string name) {
+bool AstTree::hasStruct(Symbol name) {
     for (auto const &s : structs) {
         if (s->name == name) return true;
     }
     return false;
 }
 
+//
+// Merges another translation unit into this one
+//
+// Statements are appended in order. An extern is dropped when an earlier
+// statement already declares or defines the function; structures and
+// classes are kept once per name.
+//
+void AstTree::merge(std::shared_ptr<AstTree> other) {
+    std::unordered_set<Symbol> declared;
+    std::vector<std::shared_ptr<AstStatement>> merged;
+    
+    for (auto const &unit : { block->block, other->block->block }) {
+        for (auto const &stmt : unit) {
+            if (stmt->type == V_AstType::ExternFunc) {
+                auto func = std::static_pointer_cast<AstExternFunction>(stmt);
+                if (declared.find(func->name) != declared.end()) continue;
+                declared.insert(func->name);
+            } else if (stmt->type == V_AstType::Func) {
+                declared.insert(std::static_pointer_cast<AstFunction>(stmt)->name);
+            }
+            merged.push_back(stmt);
+        }
+    }
+    block->block = merged;
+    block->mergeSymbols(other->block);
+    block->linkScopes();
+    
+    for (auto const &s : other->structs) {
+        if (!hasStruct(s->name)) addStruct(s);
+    }
+    
+    for (auto const &c : other->classes) {
+        bool found = false;
+        for (auto const &c2 : classes) {
+            if (c2->name == c->name) found = true;
+        }
+        if (!found) addClass(c);
+    }
+}
+
 //
 // AstBlock
 //
@@ -128,66 +170,106 @@ void AstBlock::insertAt(std::shared_ptr<AstStatement> stmt, size_t pos) {
     block.insert(block.begin() + pos, stmt);
 }
 
-void AstBlock::addSymbol(std::string name, std::shared_ptr<AstDataType> dataType) {
+void AstBlock::addSymbol(Symbol name, std::shared_ptr<AstDataType> dataType) {
     symbolTable[name] = dataType;
-    vars.push_back(name);
 }
 
-void AstBlock::mergeSymbols(std::shared_ptr<AstBlock> parent) {
-    // Scoped variables
-    auto map = parent->getSymbolTable();
-    for (auto const &element : map) {
+//
+// Copies the names declared in another block into this one
+//
+// This is for blocks that are not nested, such as an imported tree or a
+// function's argument list. Nested blocks use setParent instead.
+//
+void AstBlock::mergeSymbols(std::shared_ptr<AstBlock> other) {
+    for (auto const &element : other->symbolTable) {
         symbolTable[element.first] = element.second;
-        vars.push_back(element.first);
     }
     
-    // Global constants
-    for (auto const &element : parent->globalConsts) {
+    for (auto const &element : other->globalConsts) {
         globalConsts[element.first] = element.second;
     }
     
-    // Scoped constants
-    for (auto const &element : parent->localConsts) {
+    for (auto const &element : other->localConsts) {
         localConsts[element.first] = element.second;
     }
     
-    // Functions
-    auto parent_funcs = parent->funcs;
-    for (auto func : parent_funcs) {
-        this->funcs.push_back(func);
-    }
+    funcs.insert(other->funcs.begin(), other->funcs.end());
 }
 
-std::map<std::string, std::shared_ptr<AstDataType>> AstBlock::getSymbolTable() {
-    return symbolTable;
+void AstBlock::setParent(std::shared_ptr<AstBlock> parent) {
+    this->parent = parent.get();
 }
 
-std::shared_ptr<AstDataType> AstBlock::getDataType(std::string name) {
-    return symbolTable[name];
+//
+// Points every nested block back at the block that holds it
+//
+// This is needed when statements are moved to another block, so that no
+// block is left pointing at a parent that no longer exists.
+//
+static void link_child(AstBlock *parent, const std::shared_ptr<AstBlock> &child) {
+    if (child == nullptr) return;
+    child->parent = parent;
+    child->linkScopes();
 }
 
-bool AstBlock::isVar(std::string name) {
-    if (std::find(vars.begin(), vars.end(), name) != vars.end()) {
-        return true;
+void AstBlock::linkScopes() {
+    for (auto const &stmt : block) {
+        switch (stmt->type) {
+            case V_AstType::Func: link_child(this, std::static_pointer_cast<AstFunction>(stmt)->block); break;
+            case V_AstType::BlockStmt: link_child(this, std::static_pointer_cast<AstBlockStmt>(stmt)->block); break;
+            case V_AstType::While: link_child(this, std::static_pointer_cast<AstWhileStmt>(stmt)->block); break;
+            case V_AstType::Repeat: link_child(this, std::static_pointer_cast<AstRepeatStmt>(stmt)->block); break;
+            case V_AstType::For: link_child(this, std::static_pointer_cast<AstForStmt>(stmt)->block); break;
+            case V_AstType::ForAll: link_child(this, std::static_pointer_cast<AstForAllStmt>(stmt)->block); break;
+            
+            case V_AstType::If: {
+                auto cond = std::static_pointer_cast<AstIfStmt>(stmt);
+                link_child(this, cond->true_block);
+                link_child(this, cond->false_block);
+            } break;
+            
+            default: {}
+        }
     }
-    return false;
 }
 
-int AstBlock::isConstant(std::string name) {
-    if (globalConsts.find(name) != globalConsts.end()) {
-        return 1;
+std::shared_ptr<AstDataType> AstBlock::getDataType(Symbol name) {
+    for (AstBlock *scope = this; scope != nullptr; scope = scope->parent) {
+        auto found = scope->symbolTable.find(name);
+        if (found != scope->symbolTable.end()) return found->second;
     }
-    
-    if (localConsts.find(name) != localConsts.end()) {
-        return 2;
+    return nullptr;
+}
+
+bool AstBlock::isVar(Symbol name) {
+    for (AstBlock *scope = this; scope != nullptr; scope = scope->parent) {
+        if (scope->symbolTable.find(name) != scope->symbolTable.end()) return true;
+    }
+    return false;
+}
+
+int AstBlock::isConstant(Symbol name) {
+    for (AstBlock *scope = this; scope != nullptr; scope = scope->parent) {
+        if (scope->globalConsts.find(name) != scope->globalConsts.end()) return 1;
+        if (scope->localConsts.find(name) != scope->localConsts.end()) return 2;
     }
-    
     return 0;
 }
 
-bool AstBlock::isFunc(std::string name) {
-    if (std::find(funcs.begin(), funcs.end(), name) != funcs.end()) {
-        return true;
+std::shared_ptr<AstExpression> AstBlock::getConstant(Symbol name) {
+    for (AstBlock *scope = this; scope != nullptr; scope = scope->parent) {
+        auto global = scope->globalConsts.find(name);
+        if (global != scope->globalConsts.end()) return global->second.second;
+        
+        auto local = scope->localConsts.find(name);
+        if (local != scope->localConsts.end()) return local->second.second;
+    }
+    return nullptr;
+}
+
+bool AstBlock::isFunc(Symbol name) {
+    for (AstBlock *scope = this; scope != nullptr; scope = scope->parent) {
+        if (scope->funcs.find(name) != scope->funcs.end()) return true;
     }
     return false;
 }
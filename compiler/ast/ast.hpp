@@ -9,6 +9,10 @@
 #include <vector>
 #include <memory>
 #include <map>
+#include <unordered_set>
+
+#include <ast/symbol.hpp>
+#include <ast/ast_context.hpp>
 
 //
 // Contains the variants for all AST nodes
@@ -155,26 +159,26 @@ struct AstPointerType : AstDataType {
 
 // Represents a structure type
 struct AstStructType : AstDataType {
-    explicit AstStructType(std::string name);
+    explicit AstStructType(Symbol name);
     void print() override;
     
-    std::string name = "";
+    Symbol name;
 };
 
 // Represents an object type
 struct AstObjectType : AstDataType {
-    explicit AstObjectType(std::string name);
+    explicit AstObjectType(Symbol name);
     void print() override;
     
-    std::string name = "";
+    Symbol name;
 };
 
 // Var
 struct Var {
     explicit Var();
-    explicit Var(std::shared_ptr<AstDataType> type, std::string name = "");
+    explicit Var(std::shared_ptr<AstDataType> type, Symbol name = Symbol());
     
-    std::string name;
+    Symbol name;
     std::shared_ptr<AstDataType> type;
 };
 
@@ -183,7 +187,7 @@ struct Var {
 // Represents a struct
 //
 struct AstStruct : AstNode {
-    explicit AstStruct(std::string name);
+    explicit AstStruct(Symbol name);
     
     void addItem(Var var, std::shared_ptr<AstExpression> default_expression);
     
@@ -191,9 +195,9 @@ struct AstStruct : AstNode {
     std::string dot(std::string parent);
     
     // Member variables
-    std::string name;
+    Symbol name;
     std::vector<Var> items;
-    std::map<std::string, std::shared_ptr<AstExpression>> default_expressions;
+    SymbolMap<std::shared_ptr<AstExpression>> default_expressions;
     int size = 0;
 };
 
@@ -202,7 +206,7 @@ struct AstStruct : AstNode {
 // Represents a class
 //
 struct AstClass {
-    explicit AstClass(std::string name) {
+    explicit AstClass(Symbol name) {
         this->name = name;
     }
     
@@ -212,7 +216,7 @@ struct AstClass {
     
     void print();
     
-    std::string name = "";
+    Symbol name;
     std::vector<std::shared_ptr<AstFunction>> functions;
 };
 
@@ -221,15 +225,20 @@ struct AstClass {
 // Represents an enumeration
 //
 struct AstEnum {
-    std::string name;
+    Symbol name;
     std::shared_ptr<AstDataType> type;
-    std::map<std::string, std::shared_ptr<AstExpression>> values;
+    SymbolMap<std::shared_ptr<AstExpression>> values;
 };
 
 //
 // Represents an AstBlock
 // Blocks hold tables and symbol information
 //
+// A block only holds the names declared in it. Names from the enclosing
+// scopes are found by following the parent pointer, so nested blocks share
+// their parents' tables instead of copying them. The parent owns the block
+// through its statements, so the pointer back to it is not owning.
+//
 struct AstBlock : AstNode {
     AstBlock() : AstNode(V_AstType::Block) {}
 
@@ -243,26 +252,29 @@ struct AstBlock : AstNode {
     void removeAt(size_t pos);
     void insertAt(std::shared_ptr<AstStatement> stmt, size_t pos);
     
-    void addSymbol(std::string name, std::shared_ptr<AstDataType> dataType);
-    void mergeSymbols(std::shared_ptr<AstBlock> parent);
-    std::map<std::string, std::shared_ptr<AstDataType>> getSymbolTable();
-    std::shared_ptr<AstDataType> getDataType(std::string name);
+    void addSymbol(Symbol name, std::shared_ptr<AstDataType> dataType);
+    void mergeSymbols(std::shared_ptr<AstBlock> other);
+    void setParent(std::shared_ptr<AstBlock> parent);
+    void linkScopes();
+    std::shared_ptr<AstDataType> getDataType(Symbol name);
     
-    bool isVar(std::string name);
-    int isConstant(std::string name);
-    bool isFunc(std::string name);
+    bool isVar(Symbol name);
+    int isConstant(Symbol name);
+    std::shared_ptr<AstExpression> getConstant(Symbol name);
+    bool isFunc(Symbol name);
     
     void print(int indent = 4);
     std::string dot(std::string parent);
     
     // Members
     std::vector<std::shared_ptr<AstStatement>> block;
-    std::map<std::string, std::shared_ptr<AstDataType>> symbolTable;
-    std::vector<std::string> vars;
+    SymbolMap<std::shared_ptr<AstDataType>> symbolTable;
     
-    std::map<std::string, std::pair<std::shared_ptr<AstDataType>, std::shared_ptr<AstExpression>>> globalConsts;
-    std::map<std::string, std::pair<std::shared_ptr<AstDataType>, std::shared_ptr<AstExpression>>> localConsts;
-    std::vector<std::string> funcs;
+    SymbolMap<std::pair<std::shared_ptr<AstDataType>, std::shared_ptr<AstExpression>>> globalConsts;
+    SymbolMap<std::pair<std::shared_ptr<AstDataType>, std::shared_ptr<AstExpression>>> localConsts;
+    std::unordered_set<Symbol> funcs;
+    
+    AstBlock *parent = nullptr;
 };
 
 //
@@ -605,57 +617,57 @@ struct AstString : AstExpression {
 
 // Represents a variable reference
 struct AstID: AstExpression {
-    explicit AstID(std::string val) : AstExpression(V_AstType::ID) {
+    explicit AstID(Symbol val) : AstExpression(V_AstType::ID) {
         this->value = val;
     }
     
     void print();
     std::string dot(std::string parent) override;
     
-    std::string value = "";
+    Symbol value;
 };
 
 
 // Represents a function reference
 struct AstFuncRef : AstExpression {
-    explicit AstFuncRef(std::string value) : AstExpression(V_AstType::FuncRef) {
+    explicit AstFuncRef(Symbol value) : AstExpression(V_AstType::FuncRef) {
         this->value = value;
     }
     
     void print();
     std::string dot(std::string parent) override;
     
-    std::string value = "";
+    Symbol value;
 };
 
 // Represents a pointer to something
 struct AstPtrTo : AstExpression {
-    explicit AstPtrTo(std::string value) : AstExpression(V_AstType::PtrTo) {
+    explicit AstPtrTo(Symbol value) : AstExpression(V_AstType::PtrTo) {
         this->value = value;
     }
     
     void print();
     std::string dot(std::string parent) override;
     
-    std::string value = "";
+    Symbol value;
 };
 
 
 // Represents a reference to something
 struct AstRef : AstExpression {
-    explicit AstRef(std::string value) : AstExpression(V_AstType::Ref) {
+    explicit AstRef(Symbol value) : AstExpression(V_AstType::Ref) {
         this->value = value;
     }
     
     void print();
     std::string dot(std::string parent) override;
     
-    std::string value = "";
+    Symbol value;
 };
 
 // Represents an array access
 struct AstArrayAccess : AstExpression {
-    explicit AstArrayAccess(std::string value) : AstExpression(V_AstType::ArrayAccess) {
+    explicit AstArrayAccess(Symbol value) : AstExpression(V_AstType::ArrayAccess) {
         this->value = value;
     }
     
@@ -663,13 +675,13 @@ struct AstArrayAccess : AstExpression {
     std::string dot(std::string parent) override;
     
     // Member variables
-    std::string value = "";
+    Symbol value;
     std::shared_ptr<AstExpression> index;
 };
 
 // Represents a structure access
 struct AstStructAccess : AstExpression {
-    explicit AstStructAccess(std::string var, std::string member) : AstExpression(V_AstType::StructAccess) {
+    explicit AstStructAccess(Symbol var, Symbol member) : AstExpression(V_AstType::StructAccess) {
         this->var = var;
         this->member = member;
     }
@@ -678,8 +690,8 @@ struct AstStructAccess : AstExpression {
     std::string dot(std::string parent) override;
     
     // Member variables
-    std::string var = "";
-    std::string member = "";
+    Symbol var;
+    Symbol member;
     
     // TODO: I don't love this
     // This is specific for members that are arrays
@@ -688,7 +700,7 @@ struct AstStructAccess : AstExpression {
 
 // Represents a function call
 struct AstFuncCallExpr : AstExpression {
-    explicit AstFuncCallExpr(std::string name) : AstExpression(V_AstType::FuncCallExpr) {
+    explicit AstFuncCallExpr(Symbol name) : AstExpression(V_AstType::FuncCallExpr) {
         this->name = name;
     }
     
@@ -697,8 +709,8 @@ struct AstFuncCallExpr : AstExpression {
     
     // Member variables
     std::shared_ptr<AstExpression> args;
-    std::string name = "";
-    std::string object_name;
+    Symbol name;
+    Symbol object_name;
 };
 
 // Represents the sizeof operator
@@ -728,11 +740,12 @@ struct AstStatement : AstNode {
     virtual std::string dot(std::string parent) { return ""; }
     
     std::shared_ptr<AstExpression> expression = nullptr;
+    int line = 0;       // The source line the statement starts on, or 0
 };
 
 // Represents an extern function
 struct AstExternFunction : AstStatement {
-    explicit AstExternFunction(std::string name) : AstStatement(V_AstType::ExternFunc) {
+    explicit AstExternFunction(Symbol name) : AstStatement(V_AstType::ExternFunc) {
         this->name = name;
     }
     
@@ -742,7 +755,7 @@ struct AstExternFunction : AstStatement {
     std::string dot(std::string parent) override;
     
     // Member variables
-    std::string name = "";
+    Symbol name;
     std::vector<Var> args;
     std::shared_ptr<AstDataType> data_type;
     bool varargs = false;
@@ -750,15 +763,15 @@ struct AstExternFunction : AstStatement {
 
 // Represents a function
 struct AstFunction : AstStatement {
-    explicit AstFunction(std::string name) : AstStatement(V_AstType::Func) {
+    explicit AstFunction(Symbol name) : AstStatement(V_AstType::Func) {
         this->name = name;
-        block = std::make_shared<AstBlock>();
+        block = AstContext::make<AstBlock>();
     }
     
-    explicit AstFunction(std::string name, std::shared_ptr<AstDataType> data_type) : AstStatement(V_AstType::Func) {
+    explicit AstFunction(Symbol name, std::shared_ptr<AstDataType> data_type) : AstStatement(V_AstType::Func) {
         this->name = name;
         this->data_type = data_type;
-        block = std::make_shared<AstBlock>();
+        block = AstContext::make<AstBlock>();
     }
     
     void addStatement(std::shared_ptr<AstStatement> statement) {
@@ -769,7 +782,7 @@ struct AstFunction : AstStatement {
     std::string dot(std::string parent) override;
 
     // Member variables
-    std::string name = "";
+    Symbol name;
     std::vector<Var> args;
     std::shared_ptr<AstBlock> block;
     std::shared_ptr<AstDataType> data_type;
@@ -785,7 +798,7 @@ struct AstFunction : AstStatement {
 struct AstBlockStmt : AstStatement {
     explicit AstBlockStmt(std::string name = "") : AstStatement(V_AstType::BlockStmt) {
         this->name = name;
-        block = std::make_shared<AstBlock>();
+        block = AstContext::make<AstBlock>();
     }
     
     void print(int indent = 0);
@@ -820,18 +833,18 @@ struct AstExprStatement : AstStatement {
 
 // Represents a function call statement
 struct AstFuncCallStmt : AstStatement {
-    explicit AstFuncCallStmt(std::string name) : AstStatement(V_AstType::FuncCallStmt) {
+    explicit AstFuncCallStmt(Symbol name) : AstStatement(V_AstType::FuncCallStmt) {
         this->name = name;
     }
     
-    std::string getName() { return name; }
+    Symbol getName() { return name; }
     void print();
     std::string dot(std::string parent) override;
     
-    std::string name = "";
+    Symbol name;
     
     // Language-specific attributes
-    std::string object_name = "";
+    Symbol object_name;
 };
 
 // Represents a return statement
@@ -844,7 +857,7 @@ struct AstReturnStmt : AstStatement {
 
 // Represents a variable declaration
 struct AstVarDec : AstStatement {
-    explicit AstVarDec(std::string name, std::shared_ptr<AstDataType> data_type) : AstStatement(V_AstType::VarDec) {
+    explicit AstVarDec(Symbol name, std::shared_ptr<AstDataType> data_type) : AstStatement(V_AstType::VarDec) {
         this->name = name;
         this->data_type = data_type;
     }
@@ -852,16 +865,16 @@ struct AstVarDec : AstStatement {
     void print();
     std::string dot(std::string parent) override;
     
-    std::string name = "";
+    Symbol name;
     std::shared_ptr<AstDataType> data_type;
     
     // Language-specific attributes
-    std::string class_name = "";
+    Symbol class_name;
 };
 
 // Represents a structure declaration
 struct AstStructDec : AstStatement {
-    explicit AstStructDec(std::string var_name, std::string struct_name) : AstStatement(V_AstType::StructDec) {
+    explicit AstStructDec(Symbol var_name, Symbol struct_name) : AstStatement(V_AstType::StructDec) {
         this->var_name = var_name;
         this->struct_name = struct_name;
     }
@@ -869,8 +882,8 @@ struct AstStructDec : AstStatement {
     void print();
     std::string dot(std::string parent) override;
     
-    std::string var_name = "";
-    std::string struct_name = "";
+    Symbol var_name;
+    Symbol struct_name;
     bool no_init = false;
 };
 
@@ -907,8 +920,8 @@ struct AstRepeatStmt : public AstStatement {
 // Represents a for loop
 struct AstForStmt : public AstStatement {
     explicit AstForStmt() : AstStatement(V_AstType::For) {
-        step = std::make_shared<AstInt>(1);
-        block = std::make_shared<AstBlock>();
+        step = AstContext::make<AstInt>(1);
+        block = AstContext::make<AstBlock>();
     }
     
     void print(int indent = 0);
@@ -953,7 +966,7 @@ struct AstContinue : AstStatement {
 struct AstTree {
     explicit AstTree(std::string file);
     ~AstTree();
-    bool hasStruct(std::string name);
+    bool hasStruct(Symbol name);
     
     void addGlobalStatement(std::shared_ptr<AstStatement> stmt) {
         block->addStatement(stmt);
@@ -967,10 +980,13 @@ struct AstTree {
         classes.push_back(c);
     }
     
+    void merge(std::shared_ptr<AstTree> other);
+    
     void print();
     void dot();
     
     std::string file = "";
+    std::shared_ptr<AstContext> context;
     std::shared_ptr<AstBlock> block;
     std::vector<std::shared_ptr<AstStruct>> structs;
     std::vector<std::shared_ptr<AstClass>> classes;
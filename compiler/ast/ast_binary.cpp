@@ -0,0 +1,888 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+#include <string_view>
+#include <fstream>
+
+#include <ast/ast_binary.hpp>
+#include <parser/source_buffer.hpp>
+
+namespace AstBinary {
+
+static const char magic[4] = { 'O', 'A', 'S', 'T' };
+
+// Written in place of a tag when a node pointer is null
+static const uint8_t null_node = 0xFF;
+
+// Symbol tables are unordered, so they are written sorted by name to keep the
+// output the same from run to run
+template<class T>
+static std::vector<std::pair<Symbol, T>> sorted(const SymbolMap<T> &map) {
+    std::vector<std::pair<Symbol, T>> entries(map.begin(), map.end());
+    std::sort(entries.begin(), entries.end(), [](auto const &a, auto const &b) {
+        return a.first.str() < b.first.str();
+    });
+    return entries;
+}
+
+static bool is_binary_op(V_AstType type) {
+    switch (type) {
+        case V_AstType::Assign:
+        case V_AstType::Add:
+        case V_AstType::Sub:
+        case V_AstType::Mul:
+        case V_AstType::Div:
+        case V_AstType::Mod:
+        case V_AstType::And:
+        case V_AstType::Or:
+        case V_AstType::Xor:
+        case V_AstType::Lsh:
+        case V_AstType::Rsh:
+        case V_AstType::EQ:
+        case V_AstType::NEQ:
+        case V_AstType::GT:
+        case V_AstType::LT:
+        case V_AstType::GTE:
+        case V_AstType::LTE:
+        case V_AstType::LogicalAnd:
+        case V_AstType::LogicalOr: return true;
+
+        default: {}
+    }
+    return false;
+}
+
+static std::shared_ptr<AstBinaryOp> make_binary_op(V_AstType type) {
+    switch (type) {
+        case V_AstType::Assign: return AstContext::make<AstAssignOp>();
+        case V_AstType::Add: return AstContext::make<AstAddOp>();
+        case V_AstType::Sub: return AstContext::make<AstSubOp>();
+        case V_AstType::Mul: return AstContext::make<AstMulOp>();
+        case V_AstType::Div: return AstContext::make<AstDivOp>();
+        case V_AstType::Mod: return AstContext::make<AstModOp>();
+        case V_AstType::And: return AstContext::make<AstAndOp>();
+        case V_AstType::Or: return AstContext::make<AstOrOp>();
+        case V_AstType::Xor: return AstContext::make<AstXorOp>();
+        case V_AstType::Lsh: return AstContext::make<AstLshOp>();
+        case V_AstType::Rsh: return AstContext::make<AstRshOp>();
+        case V_AstType::EQ: return AstContext::make<AstEQOp>();
+        case V_AstType::NEQ: return AstContext::make<AstNEQOp>();
+        case V_AstType::GT: return AstContext::make<AstGTOp>();
+        case V_AstType::LT: return AstContext::make<AstLTOp>();
+        case V_AstType::GTE: return AstContext::make<AstGTEOp>();
+        case V_AstType::LTE: return AstContext::make<AstLTEOp>();
+        case V_AstType::LogicalAnd: return AstContext::make<AstLogicalAndOp>();
+        case V_AstType::LogicalOr: return AstContext::make<AstLogicalOrOp>();
+
+        default: {}
+    }
+    return nullptr;
+}
+
+//
+// Writer
+//
+class Writer {
+public:
+    void write_tree(std::shared_ptr<AstTree> tree);
+    void write_statement(std::shared_ptr<AstStatement> stmt) { statement(stmt); }
+    void write_struct(std::shared_ptr<AstStruct> s) { structure(s); }
+    std::string finish();
+    
+    const std::vector<std::string_view> &names() { return strings; }
+private:
+    void byte(uint8_t b) { body.push_back((char)b); }
+    void number(uint64_t n);
+    void fixed64(uint64_t n);
+    void text(std::string_view s);
+    void symbol(Symbol s) { text(s.str()); }
+
+    void data_type(std::shared_ptr<AstDataType> type);
+    void var(const Var &v);
+    void vars(const std::vector<Var> &list);
+    void expression(std::shared_ptr<AstExpression> expr);
+    void statement(std::shared_ptr<AstStatement> stmt);
+    void block(std::shared_ptr<AstBlock> block);
+    void structure(std::shared_ptr<AstStruct> s);
+    void class_def(std::shared_ptr<AstClass> c);
+
+    std::string body;
+    std::vector<std::string_view> strings;
+    std::unordered_map<std::string_view, uint32_t> string_ids;
+};
+
+void Writer::number(uint64_t n) {
+    while (n >= 0x80) {
+        byte((n & 0x7F) | 0x80);
+        n >>= 7;
+    }
+    byte(n);
+}
+
+void Writer::fixed64(uint64_t n) {
+    for (int i = 0; i<8; i++) {
+        byte(n & 0xFF);
+        n >>= 8;
+    }
+}
+
+// The strings are owned by the tree, which outlives the writer
+void Writer::text(std::string_view s) {
+    auto found = string_ids.find(s);
+    if (found != string_ids.end()) {
+        number(found->second);
+        return;
+    }
+
+    uint32_t id = strings.size();
+    strings.push_back(s);
+    string_ids[s] = id;
+    number(id);
+}
+
+void Writer::data_type(std::shared_ptr<AstDataType> type) {
+    if (type == nullptr) {
+        byte(null_node);
+        return;
+    }
+
+    byte((uint8_t)type->type);
+    byte(type->is_unsigned);
+
+    switch (type->type) {
+        case V_AstType::Ptr: {
+            data_type(std::static_pointer_cast<AstPointerType>(type)->base_type);
+        } break;
+
+        case V_AstType::Struct: symbol(std::static_pointer_cast<AstStructType>(type)->name); break;
+        case V_AstType::Object: symbol(std::static_pointer_cast<AstObjectType>(type)->name); break;
+
+        default: {}
+    }
+}
+
+void Writer::var(const Var &v) {
+    symbol(v.name);
+    data_type(v.type);
+}
+
+void Writer::vars(const std::vector<Var> &list) {
+    number(list.size());
+    for (auto const &v : list) var(v);
+}
+
+void Writer::expression(std::shared_ptr<AstExpression> expr) {
+    if (expr == nullptr) {
+        byte(null_node);
+        return;
+    }
+
+    byte((uint8_t)expr->type);
+
+    if (is_binary_op(expr->type)) {
+        auto op = std::static_pointer_cast<AstBinaryOp>(expr);
+        expression(op->lval);
+        expression(op->rval);
+        number(op->precedence);
+        return;
+    }
+
+    switch (expr->type) {
+        case V_AstType::ExprList: {
+            auto list = std::static_pointer_cast<AstExprList>(expr);
+            number(list->list.size());
+            for (auto const &item : list->list) expression(item);
+        } break;
+
+        case V_AstType::Neg: expression(std::static_pointer_cast<AstNegOp>(expr)->value); break;
+
+        case V_AstType::CharL: byte(std::static_pointer_cast<AstChar>(expr)->value); break;
+
+        case V_AstType::IntL: {
+            auto i = std::static_pointer_cast<AstInt>(expr);
+            number(i->value);
+            number(i->size);
+        } break;
+
+        case V_AstType::FloatL: {
+            uint64_t bits;
+            double value = std::static_pointer_cast<AstFloat>(expr)->value;
+            memcpy(&bits, &value, sizeof(bits));
+            fixed64(bits);
+        } break;
+
+        case V_AstType::StringL: text(std::static_pointer_cast<AstString>(expr)->value); break;
+        case V_AstType::ID: symbol(std::static_pointer_cast<AstID>(expr)->value); break;
+        case V_AstType::FuncRef: symbol(std::static_pointer_cast<AstFuncRef>(expr)->value); break;
+        case V_AstType::PtrTo: symbol(std::static_pointer_cast<AstPtrTo>(expr)->value); break;
+        case V_AstType::Ref: symbol(std::static_pointer_cast<AstRef>(expr)->value); break;
+
+        case V_AstType::ArrayAccess: {
+            auto acc = std::static_pointer_cast<AstArrayAccess>(expr);
+            symbol(acc->value);
+            expression(acc->index);
+        } break;
+
+        case V_AstType::StructAccess: {
+            auto acc = std::static_pointer_cast<AstStructAccess>(expr);
+            symbol(acc->var);
+            symbol(acc->member);
+            expression(acc->access_expression);
+        } break;
+
+        case V_AstType::FuncCallExpr: {
+            auto fc = std::static_pointer_cast<AstFuncCallExpr>(expr);
+            symbol(fc->name);
+            symbol(fc->object_name);
+            expression(fc->args);
+        } break;
+
+        case V_AstType::Sizeof: expression(std::static_pointer_cast<AstSizeof>(expr)->value); break;
+
+        default: {}
+    }
+}
+
+void Writer::statement(std::shared_ptr<AstStatement> stmt) {
+    byte((uint8_t)stmt->type);
+    expression(stmt->expression);
+
+    switch (stmt->type) {
+        case V_AstType::ExternFunc: {
+            auto func = std::static_pointer_cast<AstExternFunction>(stmt);
+            symbol(func->name);
+            vars(func->args);
+            data_type(func->data_type);
+            byte(func->varargs);
+        } break;
+
+        case V_AstType::Func: {
+            auto func = std::static_pointer_cast<AstFunction>(stmt);
+            symbol(func->name);
+            vars(func->args);
+            data_type(func->data_type);
+            text(func->dtName);
+            byte((uint8_t)func->attr);
+            byte(func->routine);
+            block(func->block);
+        } break;
+
+        case V_AstType::BlockStmt: {
+            auto bs = std::static_pointer_cast<AstBlockStmt>(stmt);
+            text(bs->name);
+            number(bs->clauses.size());
+            for (auto const &clause : bs->clauses) text(clause);
+            block(bs->block);
+        } break;
+
+        case V_AstType::ExprStmt: {
+            auto es = std::static_pointer_cast<AstExprStatement>(stmt);
+            data_type(es->dataType);
+            text(es->name);
+        } break;
+
+        case V_AstType::FuncCallStmt: {
+            auto fc = std::static_pointer_cast<AstFuncCallStmt>(stmt);
+            symbol(fc->name);
+            symbol(fc->object_name);
+        } break;
+
+        case V_AstType::VarDec: {
+            auto vd = std::static_pointer_cast<AstVarDec>(stmt);
+            symbol(vd->name);
+            data_type(vd->data_type);
+            symbol(vd->class_name);
+        } break;
+
+        case V_AstType::StructDec: {
+            auto sd = std::static_pointer_cast<AstStructDec>(stmt);
+            symbol(sd->var_name);
+            symbol(sd->struct_name);
+            byte(sd->no_init);
+        } break;
+
+        case V_AstType::If: {
+            auto cond = std::static_pointer_cast<AstIfStmt>(stmt);
+            block(cond->true_block);
+            block(cond->false_block);
+        } break;
+
+        case V_AstType::While: block(std::static_pointer_cast<AstWhileStmt>(stmt)->block); break;
+        case V_AstType::Repeat: block(std::static_pointer_cast<AstRepeatStmt>(stmt)->block); break;
+
+        case V_AstType::For: {
+            auto loop = std::static_pointer_cast<AstForStmt>(stmt);
+            expression(loop->index);
+            expression(loop->start);
+            expression(loop->end);
+            expression(loop->step);
+            data_type(loop->data_type);
+            block(loop->block);
+        } break;
+
+        case V_AstType::ForAll: {
+            auto loop = std::static_pointer_cast<AstForAllStmt>(stmt);
+            expression(loop->index);
+            expression(loop->array);
+            data_type(loop->data_type);
+            block(loop->block);
+        } break;
+
+        default: {}
+    }
+}
+
+void Writer::block(std::shared_ptr<AstBlock> block) {
+    if (block == nullptr) {
+        byte(null_node);
+        return;
+    }
+    byte((uint8_t)V_AstType::Block);
+
+    number(block->block.size());
+    for (auto const &stmt : block->block) statement(stmt);
+
+    auto symbols = sorted(block->symbolTable);
+    number(symbols.size());
+    for (auto const &entry : symbols) {
+        symbol(entry.first);
+        data_type(entry.second);
+    }
+
+    for (auto const &table : { &block->globalConsts, &block->localConsts }) {
+        auto consts = sorted(*table);
+        number(consts.size());
+        for (auto const &entry : consts) {
+            symbol(entry.first);
+            data_type(entry.second.first);
+            expression(entry.second.second);
+        }
+    }
+
+    std::vector<Symbol> funcs(block->funcs.begin(), block->funcs.end());
+    std::sort(funcs.begin(), funcs.end(), [](Symbol a, Symbol b) {
+        return a.str() < b.str();
+    });
+    number(funcs.size());
+    for (auto const &name : funcs) symbol(name);
+}
+
+void Writer::structure(std::shared_ptr<AstStruct> s) {
+    symbol(s->name);
+    number(s->items.size());
+    for (auto const &item : s->items) {
+        var(item);
+
+        auto found = s->default_expressions.find(item.name);
+        if (found == s->default_expressions.end()) expression(nullptr);
+        else expression(found->second);
+    }
+    number(s->size);
+}
+
+void Writer::class_def(std::shared_ptr<AstClass> c) {
+    symbol(c->name);
+    number(c->functions.size());
+    for (auto const &func : c->functions) statement(func);
+}
+
+void Writer::write_tree(std::shared_ptr<AstTree> tree) {
+    text(tree->file);
+    block(tree->block);
+
+    number(tree->structs.size());
+    for (auto const &s : tree->structs) structure(s);
+
+    number(tree->classes.size());
+    for (auto const &c : tree->classes) class_def(c);
+}
+
+//
+// The string table goes in front of the nodes, so the reader has every string
+// before the first node refers to one
+//
+std::string Writer::finish() {
+    std::string nodes;
+    nodes.swap(body);
+
+    body.append(magic, sizeof(magic));
+    for (int i = 0; i<4; i++) byte((version >> (i * 8)) & 0xFF);
+
+    number(strings.size());
+    for (auto const &s : strings) {
+        number(s.length());
+        body.append(s.data(), s.length());
+    }
+
+    body += nodes;
+    return body;
+}
+
+std::string write(std::shared_ptr<AstTree> tree) {
+    Writer writer;
+    writer.write_tree(tree);
+    return writer.finish();
+}
+
+std::string write(std::shared_ptr<AstStatement> stmt, std::vector<std::string> *names) {
+    Writer writer;
+    writer.write_statement(stmt);
+    if (names != nullptr) names->assign(writer.names().begin(), writer.names().end());
+    return writer.finish();
+}
+
+std::string write(std::shared_ptr<AstStruct> s) {
+    Writer writer;
+    writer.write_struct(s);
+    return writer.finish();
+}
+
+//
+// Reader
+//
+// Any read past the end of the data marks the input as bad; the caller checks
+// once at the end instead of after every field.
+//
+class Reader {
+public:
+    explicit Reader(const char *data, size_t size) {
+        this->pos = data;
+        this->end = data + size;
+    }
+
+    std::shared_ptr<AstTree> read_tree();
+private:
+    uint8_t byte();
+    uint64_t number();
+    uint64_t fixed64();
+    std::string_view text();
+    Symbol symbol();
+
+    std::shared_ptr<AstDataType> data_type();
+    Var var();
+    std::vector<Var> vars();
+    std::shared_ptr<AstExpression> expression();
+    std::shared_ptr<AstID> id();
+    std::shared_ptr<AstStatement> statement();
+    std::shared_ptr<AstBlock> block();
+    std::shared_ptr<AstStruct> structure();
+    std::shared_ptr<AstClass> class_def();
+
+    const char *pos;
+    const char *end;
+    bool ok = true;
+
+    // Strings point into the input; each is interned the first time it is
+    // used as a symbol
+    std::vector<std::string_view> strings;
+    std::vector<Symbol> symbols;
+    std::vector<bool> interned;
+};
+
+uint8_t Reader::byte() {
+    if (pos >= end) {
+        ok = false;
+        return null_node;
+    }
+    return (uint8_t)*pos++;
+}
+
+uint64_t Reader::number() {
+    uint64_t n = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t b = byte();
+        n |= (uint64_t)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) return n;
+    }
+    ok = false;
+    return 0;
+}
+
+uint64_t Reader::fixed64() {
+    uint64_t n = 0;
+    for (int i = 0; i<8; i++) n |= (uint64_t)byte() << (i * 8);
+    return n;
+}
+
+std::string_view Reader::text() {
+    uint64_t id = number();
+    if (id >= strings.size()) {
+        ok = false;
+        return std::string_view();
+    }
+    return strings[id];
+}
+
+Symbol Reader::symbol() {
+    uint64_t id = number();
+    if (id >= strings.size()) {
+        ok = false;
+        return Symbol();
+    }
+
+    if (!interned[id]) {
+        symbols[id] = Symbol(strings[id]);
+        interned[id] = true;
+    }
+    return symbols[id];
+}
+
+std::shared_ptr<AstDataType> Reader::data_type() {
+    uint8_t tag = byte();
+    if (tag == null_node) return nullptr;
+
+    V_AstType type = (V_AstType)tag;
+    bool is_unsigned = byte();
+
+    std::shared_ptr<AstDataType> result;
+    switch (type) {
+        case V_AstType::Ptr: result = AstContext::make<AstPointerType>(data_type()); break;
+        case V_AstType::Struct: result = AstContext::make<AstStructType>(symbol()); break;
+        case V_AstType::Object: result = AstContext::make<AstObjectType>(symbol()); break;
+        default: result = AstContext::make<AstDataType>(type);
+    }
+
+    result->is_unsigned = is_unsigned;
+    return result;
+}
+
+Var Reader::var() {
+    Symbol name = symbol();
+    return Var(data_type(), name);
+}
+
+std::vector<Var> Reader::vars() {
+    std::vector<Var> list;
+    uint64_t count = number();
+    for (uint64_t i = 0; i<count && ok; i++) list.push_back(var());
+    return list;
+}
+
+std::shared_ptr<AstExpression> Reader::expression() {
+    uint8_t tag = byte();
+    if (tag == null_node) return nullptr;
+
+    V_AstType type = (V_AstType)tag;
+
+    if (is_binary_op(type)) {
+        auto op = make_binary_op(type);
+        op->lval = expression();
+        op->rval = expression();
+        op->precedence = number();
+        return op;
+    }
+
+    switch (type) {
+        case V_AstType::ExprList: {
+            auto list = AstContext::make<AstExprList>();
+            uint64_t count = number();
+            for (uint64_t i = 0; i<count && ok; i++) list->add_expression(expression());
+            return list;
+        }
+
+        case V_AstType::Neg: {
+            auto op = AstContext::make<AstNegOp>();
+            op->value = expression();
+            return op;
+        }
+
+        case V_AstType::CharL: return AstContext::make<AstChar>(byte());
+
+        case V_AstType::IntL: {
+            uint64_t value = number();
+            return AstContext::make<AstInt>(value, number());
+        }
+
+        case V_AstType::FloatL: {
+            uint64_t bits = fixed64();
+            double value;
+            memcpy(&value, &bits, sizeof(value));
+            return AstContext::make<AstFloat>(value);
+        }
+
+        case V_AstType::StringL: return AstContext::make<AstString>(std::string(text()));
+        case V_AstType::ID: return AstContext::make<AstID>(symbol());
+        case V_AstType::FuncRef: return AstContext::make<AstFuncRef>(symbol());
+        case V_AstType::PtrTo: return AstContext::make<AstPtrTo>(symbol());
+        case V_AstType::Ref: return AstContext::make<AstRef>(symbol());
+
+        case V_AstType::ArrayAccess: {
+            auto acc = AstContext::make<AstArrayAccess>(symbol());
+            acc->index = expression();
+            return acc;
+        }
+
+        case V_AstType::StructAccess: {
+            Symbol var = symbol();
+            auto acc = AstContext::make<AstStructAccess>(var, symbol());
+            acc->access_expression = expression();
+            return acc;
+        }
+
+        case V_AstType::FuncCallExpr: {
+            auto fc = AstContext::make<AstFuncCallExpr>(symbol());
+            fc->object_name = symbol();
+            fc->args = expression();
+            return fc;
+        }
+
+        case V_AstType::Sizeof: return AstContext::make<AstSizeof>(id());
+
+        default: {}
+    }
+
+    return AstContext::make<AstExpression>(type);
+}
+
+std::shared_ptr<AstID> Reader::id() {
+    auto expr = expression();
+    if (expr == nullptr) return nullptr;
+    if (expr->type != V_AstType::ID) {
+        ok = false;
+        return nullptr;
+    }
+    return std::static_pointer_cast<AstID>(expr);
+}
+
+std::shared_ptr<AstStatement> Reader::statement() {
+    V_AstType type = (V_AstType)byte();
+    auto expr = expression();
+    std::shared_ptr<AstStatement> stmt;
+
+    switch (type) {
+        case V_AstType::ExternFunc: {
+            auto func = AstContext::make<AstExternFunction>(symbol());
+            func->args = vars();
+            func->data_type = data_type();
+            func->varargs = byte();
+            stmt = func;
+        } break;
+
+        case V_AstType::Func: {
+            auto func = AstContext::make<AstFunction>(symbol());
+            func->args = vars();
+            func->data_type = data_type();
+            func->dtName = std::string(text());
+            func->attr = (Attr)byte();
+            func->routine = byte();
+            func->block = block();
+            stmt = func;
+        } break;
+
+        case V_AstType::BlockStmt: {
+            auto bs = AstContext::make<AstBlockStmt>(std::string(text()));
+            uint64_t count = number();
+            for (uint64_t i = 0; i<count && ok; i++) bs->clauses.push_back(std::string(text()));
+            bs->block = block();
+            stmt = bs;
+        } break;
+
+        case V_AstType::ExprStmt: {
+            auto es = AstContext::make<AstExprStatement>();
+            es->dataType = data_type();
+            es->name = std::string(text());
+            stmt = es;
+        } break;
+
+        case V_AstType::FuncCallStmt: {
+            auto fc = AstContext::make<AstFuncCallStmt>(symbol());
+            fc->object_name = symbol();
+            stmt = fc;
+        } break;
+
+        case V_AstType::Return: stmt = AstContext::make<AstReturnStmt>(); break;
+        case V_AstType::Break: stmt = AstContext::make<AstBreak>(); break;
+        case V_AstType::Continue: stmt = AstContext::make<AstContinue>(); break;
+
+        case V_AstType::VarDec: {
+            Symbol name = symbol();
+            auto vd = AstContext::make<AstVarDec>(name, data_type());
+            vd->class_name = symbol();
+            stmt = vd;
+        } break;
+
+        case V_AstType::StructDec: {
+            Symbol var_name = symbol();
+            auto sd = AstContext::make<AstStructDec>(var_name, symbol());
+            sd->no_init = byte();
+            stmt = sd;
+        } break;
+
+        case V_AstType::If: {
+            auto cond = AstContext::make<AstIfStmt>();
+            cond->true_block = block();
+            cond->false_block = block();
+            stmt = cond;
+        } break;
+
+        case V_AstType::While: {
+            auto loop = AstContext::make<AstWhileStmt>();
+            loop->block = block();
+            stmt = loop;
+        } break;
+
+        case V_AstType::Repeat: {
+            auto loop = AstContext::make<AstRepeatStmt>();
+            loop->block = block();
+            stmt = loop;
+        } break;
+
+        case V_AstType::For: {
+            auto loop = AstContext::make<AstForStmt>();
+            loop->index = id();
+            loop->start = expression();
+            loop->end = expression();
+            loop->step = expression();
+            loop->data_type = data_type();
+            loop->block = block();
+            stmt = loop;
+        } break;
+
+        case V_AstType::ForAll: {
+            auto loop = AstContext::make<AstForAllStmt>();
+            loop->index = id();
+            loop->array = id();
+            loop->data_type = data_type();
+            loop->block = block();
+            stmt = loop;
+        } break;
+
+        default: stmt = AstContext::make<AstStatement>(type);
+    }
+
+    stmt->expression = expr;
+    return stmt;
+}
+
+std::shared_ptr<AstBlock> Reader::block() {
+    uint8_t tag = byte();
+    if (tag == null_node) return nullptr;
+    if (tag != (uint8_t)V_AstType::Block) {
+        ok = false;
+        return nullptr;
+    }
+
+    auto block = AstContext::make<AstBlock>();
+
+    uint64_t count = number();
+    for (uint64_t i = 0; i<count && ok; i++) block->addStatement(statement());
+
+    count = number();
+    for (uint64_t i = 0; i<count && ok; i++) {
+        Symbol name = symbol();
+        block->symbolTable[name] = data_type();
+    }
+
+    for (auto table : { &block->globalConsts, &block->localConsts }) {
+        count = number();
+        for (uint64_t i = 0; i<count && ok; i++) {
+            Symbol name = symbol();
+            auto type = data_type();
+            (*table)[name] = std::make_pair(type, expression());
+        }
+    }
+
+    count = number();
+    for (uint64_t i = 0; i<count && ok; i++) block->funcs.insert(symbol());
+
+    return block;
+}
+
+std::shared_ptr<AstStruct> Reader::structure() {
+    auto s = AstContext::make<AstStruct>(symbol());
+
+    uint64_t count = number();
+    for (uint64_t i = 0; i<count && ok; i++) {
+        Var item = var();
+        auto expr = expression();
+        if (item.type == nullptr) {
+            ok = false;
+            break;
+        }
+        s->addItem(item, expr);
+    }
+
+    s->size = number();
+    return s;
+}
+
+std::shared_ptr<AstClass> Reader::class_def() {
+    auto c = AstContext::make<AstClass>(symbol());
+
+    uint64_t count = number();
+    for (uint64_t i = 0; i<count && ok; i++) {
+        auto func = statement();
+        if (func->type != V_AstType::Func) {
+            ok = false;
+            break;
+        }
+        c->addFunction(std::static_pointer_cast<AstFunction>(func));
+    }
+
+    return c;
+}
+
+std::shared_ptr<AstTree> Reader::read_tree() {
+    if (end - pos < 8 || memcmp(pos, magic, sizeof(magic)) != 0) return nullptr;
+    pos += sizeof(magic);
+
+    uint32_t file_version = 0;
+    for (int i = 0; i<4; i++) file_version |= (uint32_t)byte() << (i * 8);
+    if (file_version != version) return nullptr;
+
+    uint64_t count = number();
+    if (count > (uint64_t)(end - pos)) return nullptr;
+    strings.reserve(count);
+
+    for (uint64_t i = 0; i<count && ok; i++) {
+        uint64_t length = number();
+        if (length > (uint64_t)(end - pos)) return nullptr;
+        strings.push_back(std::string_view(pos, length));
+        pos += length;
+    }
+    symbols.resize(strings.size());
+    interned.resize(strings.size());
+
+    auto tree = std::make_shared<AstTree>(std::string(text()));
+    AstContext::Scope scope(tree->context);
+    tree->block = block();
+    if (tree->block == nullptr) return nullptr;
+
+    count = number();
+    for (uint64_t i = 0; i<count && ok; i++) tree->addStruct(structure());
+
+    count = number();
+    for (uint64_t i = 0; i<count && ok; i++) tree->addClass(class_def());
+
+    if (!ok) return nullptr;
+    tree->block->linkScopes();
+    return tree;
+}
+
+std::shared_ptr<AstTree> read(const char *data, size_t size) {
+    Reader reader(data, size);
+    return reader.read_tree();
+}
+
+bool save(std::shared_ptr<AstTree> tree, std::string path) {
+    std::string data = write(tree);
+
+    std::ofstream writer(path, std::ios::binary);
+    if (!writer.is_open()) return false;
+    writer.write(data.data(), data.size());
+    writer.close();
+    return (bool)writer;
+}
+
+std::shared_ptr<AstTree> load(std::string path) {
+    SourceBuffer buffer(path);
+    if (!buffer.is_open()) return nullptr;
+    return read(buffer.begin(), buffer.size());
+}
+
+}
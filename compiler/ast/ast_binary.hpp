@@ -0,0 +1,43 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include <ast/ast.hpp>
+
+//
+// A compact binary form of an AST tree
+//
+// The file starts with a magic number and the format version, followed by a
+// table of every string in the tree, and then the nodes in pre-order. Symbols
+// and strings are written as indices into the table; integers are written as
+// variable-length numbers.
+//
+// Bump the version whenever the layout of a node changes, so that older files
+// are rejected instead of misread.
+//
+namespace AstBinary {
+    constexpr uint32_t version = 2;
+
+    std::string write(std::shared_ptr<AstTree> tree);
+
+    // Writes a single declaration, to compare it with one written earlier.
+    // The names it refers to are stored in names, in the order they appear.
+    std::string write(std::shared_ptr<AstStatement> stmt, std::vector<std::string> *names = nullptr);
+    std::string write(std::shared_ptr<AstStruct> s);
+
+    // Returns null if the data is not a valid tree of the current version
+    std::shared_ptr<AstTree> read(const char *data, size_t size);
+
+    // The file is memory-mapped while it is read, and strings are interned
+    // straight from the mapping, so nothing is copied besides the nodes
+    bool save(std::shared_ptr<AstTree> tree, std::string path);
+    std::shared_ptr<AstTree> load(std::string path);
+}
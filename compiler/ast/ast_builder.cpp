@@ -14,47 +14,47 @@ namespace AstBuilder {
 // The builders for data types
 //
 std::shared_ptr<AstDataType> buildVoidType() {
-    return std::make_shared<AstDataType>(V_AstType::Void);
+    return AstContext::make<AstDataType>(V_AstType::Void);
 }
 
 std::shared_ptr<AstDataType> buildBoolType() {
-    return std::make_shared<AstDataType>(V_AstType::Bool);
+    return AstContext::make<AstDataType>(V_AstType::Bool);
 }
 
 std::shared_ptr<AstDataType> buildCharType() {
-    return std::make_shared<AstDataType>(V_AstType::Char);
+    return AstContext::make<AstDataType>(V_AstType::Char);
 }
 
 std::shared_ptr<AstDataType> buildInt8Type(bool isUnsigned) {
-    return std::make_shared<AstDataType>(V_AstType::Int8, isUnsigned);
+    return AstContext::make<AstDataType>(V_AstType::Int8, isUnsigned);
 }
 
 std::shared_ptr<AstDataType> buildInt16Type(bool isUnsigned) {
-    return std::make_shared<AstDataType>(V_AstType::Int16, isUnsigned);
+    return AstContext::make<AstDataType>(V_AstType::Int16, isUnsigned);
 }
 
 std::shared_ptr<AstDataType> buildInt32Type(bool isUnsigned) {
-    return std::make_shared<AstDataType>(V_AstType::Int32, isUnsigned);
+    return AstContext::make<AstDataType>(V_AstType::Int32, isUnsigned);
 }
 
 std::shared_ptr<AstDataType> buildInt64Type(bool isUnsigned) {
-    return std::make_shared<AstDataType>(V_AstType::Int64, isUnsigned);
+    return AstContext::make<AstDataType>(V_AstType::Int64, isUnsigned);
 }
 
 std::shared_ptr<AstDataType> buildFloat32Type() {
-    return std::make_shared<AstDataType>(V_AstType::Float32);
+    return AstContext::make<AstDataType>(V_AstType::Float32);
 }
 
 std::shared_ptr<AstDataType> buildFloat64Type() {
-    return std::make_shared<AstDataType>(V_AstType::Float64);
+    return AstContext::make<AstDataType>(V_AstType::Float64);
 }
 
 std::shared_ptr<AstDataType> buildStringType() {
-    return std::make_shared<AstDataType>(V_AstType::String);
+    return AstContext::make<AstDataType>(V_AstType::String);
 }
 
 std::shared_ptr<AstPointerType> buildPointerType(std::shared_ptr<AstDataType> base) {
-    return std::make_shared<AstPointerType>(base);
+    return AstContext::make<AstPointerType>(base);
 }
 
 std::shared_ptr<AstPointerType> buildInt32PointerType() {
@@ -63,11 +63,11 @@ std::shared_ptr<AstPointerType> buildInt32PointerType() {
 }
 
 std::shared_ptr<AstStructType> buildStructType(std::string name) {
-    return std::make_shared<AstStructType>(name);
+    return AstContext::make<AstStructType>(Symbol(name));
 }
 
 std::shared_ptr<AstObjectType> buildObjectType(std::string name) {
-    return std::make_shared<AstObjectType>(name);
+    return AstContext::make<AstObjectType>(Symbol(name));
 }
 
 } // End AstBuilder
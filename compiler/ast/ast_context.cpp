@@ -0,0 +1,37 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#include <cstdlib>
+
+#include <ast/ast_context.hpp>
+
+thread_local AstContext *AstContext::current = nullptr;
+
+AstArena::~AstArena() {
+    for (char *block : blocks) free(block);
+}
+
+//
+// Starts a new block; an allocation larger than a block gets a block of its
+// own, so the current block can still be filled
+//
+void *AstArena::allocate_slow(size_t size, size_t align) {
+    size_t length = size + align;
+    if (length > block_size) {
+        char *block = (char *)malloc(length);
+        blocks.push_back(block);
+        used += size;
+        return (void *)(((uintptr_t)block + align - 1) & ~(uintptr_t)(align - 1));
+    }
+
+    char *block = (char *)malloc(block_size);
+    blocks.push_back(block);
+    end = block + block_size;
+
+    char *start = (char *)(((uintptr_t)block + align - 1) & ~(uintptr_t)(align - 1));
+    pos = start + size;
+    used += size;
+    return start;
+}
@@ -0,0 +1,147 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+//
+// A bump allocator for the nodes of one tree
+//
+// Memory is handed out from large blocks and is never reused; the blocks are
+// all freed at once, after the last node allocated from them is gone. Each
+// node holds a reference to its arena, so nodes that are moved into another
+// tree (by an import, for instance) keep their memory alive.
+//
+// An arena may only allocate on one thread at a time; nodes may be released
+// from any thread.
+//
+class AstArena {
+public:
+    AstArena() {}
+
+    AstArena(const AstArena &) = delete;
+    AstArena &operator=(const AstArena &) = delete;
+
+    void *allocate(size_t size, size_t align) {
+        char *start = (char *)(((uintptr_t)pos + align - 1) & ~(uintptr_t)(align - 1));
+        if (start + size > end) return allocate_slow(size, align);
+        pos = start + size;
+        used += size;
+        return start;
+    }
+
+    void retain() { refs.fetch_add(1, std::memory_order_relaxed); }
+    void release() {
+        if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+    }
+
+    size_t size() { return used; }
+private:
+    ~AstArena();
+    void *allocate_slow(size_t size, size_t align);
+
+    static constexpr size_t block_size = 256 * 1024;
+
+    std::vector<char *> blocks;
+    char *pos = nullptr;
+    char *end = nullptr;
+    size_t used = 0;
+    std::atomic<size_t> refs{1};
+};
+
+//
+// The allocator handed to std::allocate_shared
+//
+// The node and its reference counts go in a single arena allocation.
+//
+template<class T>
+struct AstAllocator {
+    using value_type = T;
+
+    explicit AstAllocator(AstArena *arena) : arena(arena) {}
+
+    template<class U>
+    AstAllocator(const AstAllocator<U> &other) : arena(other.arena) {}
+
+    T *allocate(size_t n) {
+        arena->retain();
+        return (T *)arena->allocate(n * sizeof(T), alignof(T));
+    }
+
+    void deallocate(T *, size_t) {
+        arena->release();
+    }
+
+    template<class U>
+    bool operator==(const AstAllocator<U> &other) const { return arena == other.arena; }
+    template<class U>
+    bool operator!=(const AstAllocator<U> &other) const { return arena != other.arena; }
+
+    AstArena *arena;
+};
+
+//
+// Owns the memory of one AST tree
+//
+// Parsers and midends allocate nodes with AstContext::make, which uses the
+// context made current by an AstContext::Scope on the calling thread. With no
+// current context, nodes are allocated on the heap as before.
+//
+class AstContext {
+public:
+    AstContext() {
+        arena = new AstArena;
+    }
+
+    ~AstContext() {
+        arena->release();
+    }
+
+    AstContext(const AstContext &) = delete;
+    AstContext &operator=(const AstContext &) = delete;
+
+    template<class T, class... Args>
+    std::shared_ptr<T> create(Args &&...args) {
+        return std::allocate_shared<T>(AstAllocator<T>(arena), std::forward<Args>(args)...);
+    }
+
+    template<class T, class... Args>
+    static std::shared_ptr<T> make(Args &&...args) {
+        if (current == nullptr) return std::make_shared<T>(std::forward<Args>(args)...);
+        return current->create<T>(std::forward<Args>(args)...);
+    }
+
+    // The number of bytes handed out so far
+    size_t size() { return arena->size(); }
+
+    //
+    // Makes a context current on this thread until the scope ends
+    //
+    class Scope {
+    public:
+        explicit Scope(const std::shared_ptr<AstContext> &context) {
+            previous = current;
+            current = context.get();
+        }
+
+        ~Scope() {
+            current = previous;
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    private:
+        AstContext *previous;
+    };
+private:
+    AstArena *arena;
+
+    static thread_local AstContext *current;
+};
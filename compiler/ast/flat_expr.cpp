@@ -0,0 +1,130 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#include <cstring>
+
+#include <ast/flat_expr.hpp>
+
+FlatExpr::FlatExpr(const std::shared_ptr<AstExpression> &expr) {
+    add(expr);
+}
+
+void FlatExpr::reset(const std::shared_ptr<AstExpression> &expr) {
+    ops.clear();
+    lhs.clear();
+    rhs.clear();
+    sizes.clear();
+    values.clear();
+    nodes.clear();
+    add(expr);
+}
+
+bool FlatExpr::is_operator(V_AstType type) {
+    switch (type) {
+        case V_AstType::Neg:
+        case V_AstType::Add:
+        case V_AstType::Sub:
+        case V_AstType::Mul:
+        case V_AstType::Div:
+        case V_AstType::Mod:
+        case V_AstType::And:
+        case V_AstType::Or:
+        case V_AstType::Xor:
+        case V_AstType::Lsh:
+        case V_AstType::Rsh:
+        case V_AstType::EQ:
+        case V_AstType::NEQ:
+        case V_AstType::GT:
+        case V_AstType::LT:
+        case V_AstType::GTE:
+        case V_AstType::LTE: return true;
+
+        default: {}
+    }
+
+    return false;
+}
+
+bool FlatExpr::is_literal(V_AstType type) {
+    switch (type) {
+        case V_AstType::IntL:
+        case V_AstType::FloatL:
+        case V_AstType::CharL:
+        case V_AstType::ID: return true;
+
+        default: {}
+    }
+
+    return false;
+}
+
+double FlatExpr::float_value(uint32_t i) const {
+    double value;
+    memcpy(&value, &values[i], sizeof(double));
+    return value;
+}
+
+//
+// Adds a node after its children, and returns its number
+//
+uint32_t FlatExpr::add(const std::shared_ptr<AstExpression> &expr) {
+    uint32_t left = none;
+    uint32_t right = none;
+    uint64_t value = 0;
+    uint8_t size = 0;
+    V_AstType type = expr ? expr->type : V_AstType::None;
+
+    switch (type) {
+        case V_AstType::Neg: {
+            auto op = std::static_pointer_cast<AstNegOp>(expr);
+            left = add(op->value);
+        } break;
+
+        case V_AstType::IntL: {
+            auto i = std::static_pointer_cast<AstInt>(expr);
+            value = i->value;
+            size = i->size;
+        } break;
+
+        case V_AstType::FloatL: {
+            auto flt = std::static_pointer_cast<AstFloat>(expr);
+            memcpy(&value, &flt->value, sizeof(double));
+        } break;
+
+        case V_AstType::CharL: {
+            auto c = std::static_pointer_cast<AstChar>(expr);
+            value = (uint8_t)c->value;
+        } break;
+
+        case V_AstType::ID: {
+            auto id = std::static_pointer_cast<AstID>(expr);
+            value = id->value.id;
+        } break;
+
+        default: {
+            if (is_operator(type)) {
+                auto op = std::static_pointer_cast<AstBinaryOp>(expr);
+                left = add(op->lval);
+                right = add(op->rval);
+            } else {
+                value = nodes.size();
+                nodes.push_back(expr);
+            }
+        }
+    }
+
+    ops.push_back(type);
+    lhs.push_back(left);
+    rhs.push_back(right);
+    sizes.push_back(size);
+    values.push_back(value);
+    return ops.size() - 1;
+}
+
+const FlatExpr &FlatExprTable::get(const std::shared_ptr<AstExpression> &expr) {
+    auto found = table.find(expr.get());
+    if (found != table.end()) return found->second;
+    return table.emplace(expr.get(), FlatExpr(expr)).first->second;
+}
@@ -0,0 +1,70 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include <ast/ast.hpp>
+
+//
+// A linear form of an expression tree
+//
+// The nodes are stored in post-order, so every child comes before its parent
+// and the last node is the root. Each field is its own array, indexed by the
+// node number: a backend walks the arrays front to back, keeping the result
+// of each node in a slot of the same number.
+//
+// Only operators and simple literals are flattened. Any other node (a call,
+// an array access, and so on) is kept as a leaf that points back into the
+// tree, and is handled by the normal recursive code.
+//
+struct FlatExpr {
+    static constexpr uint32_t none = UINT32_MAX;
+
+    FlatExpr() {}
+    explicit FlatExpr(const std::shared_ptr<AstExpression> &expr);
+
+    // Flattens another expression in place, keeping the arrays' storage
+    void reset(const std::shared_ptr<AstExpression> &expr);
+
+    // Whether the node kind is stored inline, rather than as a tree leaf
+    static bool is_operator(V_AstType type);
+    static bool is_literal(V_AstType type);
+
+    size_t size() const { return ops.size(); }
+    uint32_t root() const { return ops.size() - 1; }
+
+    // The literal payloads
+    int64_t int_value(uint32_t i) const { return (int64_t)values[i]; }
+    double float_value(uint32_t i) const;
+    Symbol symbol(uint32_t i) const { return Symbol::from_id((uint32_t)values[i]); }
+    const std::shared_ptr<AstExpression> &node(uint32_t i) const { return nodes[values[i]]; }
+
+    std::vector<V_AstType> ops;
+    std::vector<uint32_t> lhs;
+    std::vector<uint32_t> rhs;
+    std::vector<uint8_t> sizes;     // The width of integer literals
+    std::vector<uint64_t> values;   // Literal, symbol ID, or index into nodes
+
+    std::vector<std::shared_ptr<AstExpression>> nodes;
+private:
+    uint32_t add(const std::shared_ptr<AstExpression> &expr);
+};
+
+//
+// Flattens each expression the first time it is asked for
+//
+// The table is keyed on the root node, so the tree must outlive it.
+//
+class FlatExprTable {
+public:
+    const FlatExpr &get(const std::shared_ptr<AstExpression> &expr);
+private:
+    std::unordered_map<const AstExpression *, FlatExpr> table;
+};
@@ -0,0 +1,77 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#include <mutex>
+#include <unordered_map>
+#include <iostream>
+#include <cstdlib>
+
+#include <ast/symbol.hpp>
+
+namespace SymbolPool {
+
+std::atomic<std::string *> pages[max_pages];
+
+static std::mutex lock;
+static uint32_t count = 1;
+
+//
+// The lookup table from text to ID. Its keys view the strings in the pages,
+// which never move.
+//
+static std::unordered_map<std::string_view, uint32_t> &table() {
+    static std::unordered_map<std::string_view, uint32_t> ids;
+    return ids;
+}
+
+uint32_t intern(std::string_view s) {
+    if (s.empty()) return 0;
+
+    std::lock_guard<std::mutex> guard(lock);
+    auto &ids = table();
+    auto found = ids.find(s);
+    if (found != ids.end()) return found->second;
+
+    uint32_t id = count;
+    uint32_t page_num = id >> page_bits;
+    if (page_num >= max_pages) {
+        std::cerr << "Fatal: Symbol table is full." << std::endl;
+        std::abort();
+    }
+
+    std::string *page = pages[page_num].load(std::memory_order_relaxed);
+    if (page == nullptr) {
+        page = new std::string[page_size];
+        pages[page_num].store(page, std::memory_order_release);
+    }
+
+    std::string &entry = page[id & (page_size - 1)];
+    entry = s;
+    ids[entry] = id;
+    ++count;
+    return id;
+}
+
+uint32_t find(std::string_view s) {
+    if (s.empty()) return 0;
+
+    std::lock_guard<std::mutex> guard(lock);
+    auto &ids = table();
+    auto found = ids.find(s);
+    if (found == ids.end()) return absent;
+    return found->second;
+}
+
+const std::string &empty() {
+    static const std::string value = "";
+    return value;
+}
+
+size_t size() {
+    std::lock_guard<std::mutex> guard(lock);
+    return count;
+}
+
+}
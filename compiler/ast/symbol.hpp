@@ -0,0 +1,117 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <ostream>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+
+//
+// The global symbol pool
+//
+// Every identifier, type name and member name is interned once, and is
+// referred to by a 32-bit ID after that. The strings live in fixed-size pages
+// that are never moved or freed, so looking up an ID takes no lock. Interning
+// a new string is serialized.
+//
+namespace SymbolPool {
+    constexpr uint32_t page_bits = 12;
+    constexpr uint32_t page_size = 1 << page_bits;
+    constexpr uint32_t max_pages = 4096;
+
+    // The ID of a name that was looked up but never interned
+    constexpr uint32_t absent = UINT32_MAX;
+
+    extern std::atomic<std::string *> pages[max_pages];
+
+    uint32_t intern(std::string_view s);
+    uint32_t find(std::string_view s);
+    const std::string &empty();
+    size_t size();
+}
+
+//
+// An interned name
+//
+// Symbols compare by ID, and convert to std::string implicitly so they can
+// stand in for the strings they replace. ID 0 is the empty string.
+//
+// Making a symbol from text interns it for the life of the process, so only
+// names that are being defined should be made that way. Code that only looks
+// a name up should use find, which never adds to the pool.
+//
+struct Symbol {
+    Symbol() {}
+    explicit Symbol(const char *s) : id(SymbolPool::intern(s)) {}
+    explicit Symbol(const std::string &s) : id(SymbolPool::intern(s)) {}
+    explicit Symbol(std::string_view s) : id(SymbolPool::intern(s)) {}
+
+    // Returns the symbol for a name without interning it. A name that was
+    // never interned gives a symbol that matches no defined name.
+    static Symbol find(std::string_view s) {
+        return from_id(SymbolPool::find(s));
+    }
+
+    static Symbol from_id(uint32_t id) {
+        Symbol sym;
+        sym.id = id;
+        return sym;
+    }
+
+    const std::string &str() const {
+        if (id == 0 || id == SymbolPool::absent) return SymbolPool::empty();
+        std::string *page = SymbolPool::pages[id >> SymbolPool::page_bits].load(std::memory_order_acquire);
+        return page[id & (SymbolPool::page_size - 1)];
+    }
+
+    operator const std::string &() const { return str(); }
+    const char *c_str() const { return str().c_str(); }
+    size_t length() const { return str().length(); }
+    bool empty() const { return id == 0; }
+
+    bool operator==(Symbol other) const { return id == other.id; }
+    bool operator!=(Symbol other) const { return id != other.id; }
+    bool operator<(Symbol other) const { return id < other.id; }
+
+    // Comparing against text does not intern it
+    bool operator==(const std::string &s) const { return str() == s; }
+    bool operator!=(const std::string &s) const { return str() != s; }
+    bool operator==(const char *s) const { return str() == s; }
+    bool operator!=(const char *s) const { return str() != s; }
+
+    uint32_t id = 0;
+};
+
+inline bool operator==(const std::string &a, Symbol b) { return b == a; }
+inline bool operator!=(const std::string &a, Symbol b) { return b != a; }
+inline bool operator==(const char *a, Symbol b) { return b == a; }
+inline bool operator!=(const char *a, Symbol b) { return b != a; }
+
+inline std::string operator+(const std::string &a, Symbol b) { return a + b.str(); }
+inline std::string operator+(Symbol a, const std::string &b) { return a.str() + b; }
+inline std::string operator+(const char *a, Symbol b) { return a + b.str(); }
+inline std::string operator+(Symbol a, const char *b) { return a.str() + b; }
+inline std::string operator+(Symbol a, Symbol b) { return a.str() + b.str(); }
+
+inline std::ostream &operator<<(std::ostream &out, Symbol sym) {
+    return out << sym.str();
+}
+
+namespace std {
+    template<> struct hash<Symbol> {
+        size_t operator()(Symbol sym) const { return sym.id; }
+    };
+}
+
+//
+// The table type used wherever names are looked up
+//
+template<class T>
+using SymbolMap = std::unordered_map<Symbol, T>;
@@ -0,0 +1,129 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <ostream>
+#include <new>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+
+//
+// A shared, copy-on-write buffer for interpreter arrays and strings
+//
+// Copying a buffer only takes another reference, so arrays and strings are
+// passed, returned and assigned without copying their elements. The elements
+// are copied the first time a shared buffer is written to, which keeps the
+// value semantics the interpreter has always had.
+//
+// The reference count and the elements are in one allocation. The count is
+// not atomic, since the interpreter runs on one thread. An empty buffer has
+// no allocation at all.
+//
+template<class T>
+class IntrBuffer {
+public:
+    IntrBuffer() {}
+
+    // A buffer of n copies of value
+    explicit IntrBuffer(size_t n, const T &value = T()) {
+        if (n == 0) return;
+        head = allocate(n);
+        for (size_t i = 0; i<n; i++) new (items() + i) T(value);
+    }
+
+    IntrBuffer(const T *source, size_t n) {
+        if (n == 0) return;
+        head = allocate(n);
+        for (size_t i = 0; i<n; i++) new (items() + i) T(source[i]);
+    }
+
+    IntrBuffer(const IntrBuffer &other) : head(other.head) {
+        if (head) ++head->refs;
+    }
+
+    IntrBuffer(IntrBuffer &&other) noexcept : head(other.head) {
+        other.head = nullptr;
+    }
+
+    IntrBuffer &operator=(IntrBuffer other) noexcept {
+        std::swap(head, other.head);
+        return *this;
+    }
+
+    ~IntrBuffer() { release(); }
+
+    size_t size() const { return head ? head->size : 0; }
+    bool empty() const { return size() == 0; }
+    bool shared() const { return head && head->refs > 1; }
+
+    const T &operator[](size_t i) const { return items()[i]; }
+    const T *begin() const { return head ? items() : nullptr; }
+    const T *end() const { return begin() + size(); }
+
+    // Gives a writable element, after taking a copy of a shared buffer. The
+    // caller checks the index; an empty buffer has no elements to write.
+    T &write(size_t i) {
+        assert(head && i < head->size);
+        if (head->refs > 1) detach();
+        return items()[i];
+    }
+
+    void clear() {
+        release();
+        head = nullptr;
+    }
+private:
+    struct Header {
+        uint32_t refs;
+        size_t size;
+    };
+
+    static_assert(sizeof(Header) % alignof(T) == 0, "Buffer elements would be misaligned");
+
+    Header *head = nullptr;
+
+    T *items() const { return reinterpret_cast<T *>(head + 1); }
+
+    static Header *allocate(size_t n) {
+        auto h = static_cast<Header *>(::operator new(sizeof(Header) + n * sizeof(T)));
+        h->refs = 1;
+        h->size = n;
+        return h;
+    }
+
+    void release() {
+        if (!head || --head->refs > 0) return;
+        for (size_t i = 0; i<head->size; i++) items()[i].~T();
+        ::operator delete(head);
+    }
+
+    void detach() {
+        IntrBuffer copy(items(), head->size);
+        std::swap(head, copy.head);
+    }
+};
+
+//
+// A string value of the interpreter
+//
+struct IntrString : IntrBuffer<char> {
+    IntrString() {}
+    IntrString(std::string_view s) : IntrBuffer<char>(s.data(), s.size()) {}
+    IntrString(const std::string &s) : IntrString(std::string_view(s)) {}
+    IntrString(const char *s) : IntrString(std::string_view(s)) {}
+
+    size_t length() const { return size(); }
+    std::string_view view() const { return std::string_view(begin(), size()); }
+    std::string str() const { return std::string(view()); }
+};
+
+inline std::ostream &operator<<(std::ostream &out, const IntrString &s) {
+    return out.write(s.begin(), s.size());
+}
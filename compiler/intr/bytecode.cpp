@@ -0,0 +1,921 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#include <ast/ast_builder.hpp>
+
+#include "bytecode.hpp"
+
+//
+// Integer constants are numbered while a function is compiled, and only get
+// their registers once the number of temporaries is known. Until then they
+// are marked with the top bit.
+//
+static const uint32_t const_mark = 0x80000000;
+
+BytecodeCompiler::BytecodeCompiler(std::shared_ptr<AstTree> tree) {
+    this->tree = tree;
+}
+
+std::shared_ptr<BcProgram> BytecodeCompiler::compile() {
+    program = std::make_shared<BcProgram>();
+
+    for (auto const &stmt : tree->block->block) {
+        if (stmt->type != V_AstType::Func) continue;
+
+        auto func = std::static_pointer_cast<AstFunction>(stmt);
+        if (function_ids.find(func->name) != function_ids.end()) {
+            fail("Duplicate function " + func->name.str());
+            return nullptr;
+        }
+        function_ids[func->name] = functions.size();
+        functions.push_back(func);
+    }
+
+    auto main = function_ids.find(Symbol::find("main"));
+    if (main == function_ids.end()) {
+        fail("No main function");
+        return nullptr;
+    }
+    program->main = main->second;
+
+    program->functions.resize(functions.size());
+    for (size_t i = 0; i<functions.size(); i++) {
+        if (!compile_function(functions[i], program->functions[i])) return nullptr;
+    }
+
+    // The exit code is taken from an integer
+    auto ret = program->functions[program->main].ret;
+    if (ret != BcKind::Int && ret != BcKind::None) {
+        fail("main does not return an integer");
+        return nullptr;
+    }
+
+    return program;
+}
+
+//
+// Declares the variables first, so that they are numbered before any
+// temporary. A name has one register for the whole function, as it has one
+// entry in the tables of the tree interpreter.
+//
+static void collect_decls(std::shared_ptr<AstBlock> block, std::vector<std::shared_ptr<AstVarDec>> &decls) {
+    if (!block) return;
+
+    for (auto const &stmt : block->block) {
+        switch (stmt->type) {
+            case V_AstType::VarDec: decls.push_back(std::static_pointer_cast<AstVarDec>(stmt)); break;
+
+            case V_AstType::If: {
+                auto cond = std::static_pointer_cast<AstIfStmt>(stmt);
+                collect_decls(cond->true_block, decls);
+                collect_decls(cond->false_block, decls);
+            } break;
+
+            case V_AstType::While: {
+                auto loop = std::static_pointer_cast<AstWhileStmt>(stmt);
+                collect_decls(loop->block, decls);
+            } break;
+
+            default: {}
+        }
+    }
+}
+
+bool BytecodeCompiler::compile_function(std::shared_ptr<AstFunction> func, BcFunction &bc) {
+    current = &bc;
+    current_func = func;
+    locals.clear();
+    iconsts.clear();
+    int_locals = 0;
+    string_locals = 0;
+
+    bc.name = func->name;
+    bc.ret = BcKind::None;
+    if (func->data_type && func->data_type->type != V_AstType::Void) {
+        bc.ret = kind_of(func->data_type);
+        if (bc.ret == BcKind::None) return fail("Unsupported return type");
+    }
+
+    Local *local;
+    for (auto const &arg : func->args) {
+        if (!declare(arg.name, arg.type, &local)) return false;
+        bc.params.push_back(local->kind);
+    }
+
+    std::vector<std::shared_ptr<AstVarDec>> decls;
+    collect_decls(func->block, decls);
+    for (auto const &vd : decls) {
+        if (!declare(vd->name, vd->data_type, &local)) return false;
+    }
+
+    next_int = max_int = int_locals;
+    next_string = max_string = string_locals;
+
+    if (!compile_block(func->block)) return false;
+    emit(BcOp::End);
+
+    // The constants go after the temporaries
+    auto patch = [&](uint32_t &reg) {
+        if (reg & const_mark) reg = max_int + (reg & ~const_mark);
+    };
+    for (auto &instr : bc.code) {
+        patch(instr.a);
+        patch(instr.b);
+        patch(instr.c);
+    }
+    for (auto &reg : bc.call_args) patch(reg);
+
+    bc.iconsts = iconsts;
+    bc.iregs = max_int + iconsts.size();
+    bc.sregs = max_string;
+
+    return true;
+}
+
+//
+// Statements
+//
+bool BytecodeCompiler::compile_block(std::shared_ptr<AstBlock> block) {
+    if (!block) return true;
+
+    for (auto const &stmt : block->block) {
+        next_int = int_locals;
+        next_string = string_locals;
+        if (!compile_statement(stmt)) return false;
+    }
+
+    return true;
+}
+
+bool BytecodeCompiler::compile_statement(std::shared_ptr<AstStatement> stmt) {
+    switch (stmt->type) {
+        case V_AstType::ExprStmt: {
+            auto stmt2 = std::static_pointer_cast<AstExprStatement>(stmt);
+            if (!stmt2->dataType || stmt2->expression->type != V_AstType::Assign) {
+                return fail("Unsupported expression statement");
+            }
+
+            auto op = std::static_pointer_cast<AstAssignOp>(stmt2->expression);
+            BcKind kind = kind_of(stmt2->dataType);
+            if (kind == BcKind::Int || kind == BcKind::IntArray) return compile_int_assign(op);
+            if (kind == BcKind::String || kind == BcKind::StringArray) return compile_string_assign(op);
+            return fail("Unsupported assignment type");
+        }
+
+        case V_AstType::VarDec: {
+            auto vd = std::static_pointer_cast<AstVarDec>(stmt);
+            Local *local = find_local(vd->name, BcKind::None);
+            switch (local->kind) {
+                case BcKind::Int: emit(BcOp::IMov, local->reg, int_const(0)); break;
+                case BcKind::String: emit(BcOp::SClear, local->reg); break;
+                case BcKind::IntArray: emit(BcOp::IAClear, local->reg); break;
+                case BcKind::StringArray: emit(BcOp::SAClear, local->reg); break;
+                default: {}
+            }
+        } break;
+
+        // The tree interpreter does not leave the function on a return. It
+        // only sets the value the function returns once it reaches the end.
+        case V_AstType::Return: {
+            if (!stmt->hasExpression()) break;
+
+            uint32_t reg;
+            switch (current->ret) {
+                case BcKind::Int: {
+                    if (!compile_int(stmt->expression, &reg)) return false;
+                    emit(BcOp::IRet, reg);
+                } break;
+
+                case BcKind::String: {
+                    if (!compile_string(stmt->expression, &reg)) return false;
+                    emit(BcOp::SRet, reg);
+                } break;
+
+                case BcKind::IntArray:
+                case BcKind::StringArray: {
+                    if (stmt->expression->type != V_AstType::ID) return fail("Unsupported array return");
+                    auto id = std::static_pointer_cast<AstID>(stmt->expression);
+                    Local *local = find_local(id->value, current->ret);
+                    if (!local) return fail("Unsupported array return");
+                    emit(current->ret == BcKind::IntArray ? BcOp::IARet : BcOp::SARet, local->reg);
+                } break;
+
+                default: {}
+            }
+        } break;
+
+        case V_AstType::FuncCallStmt: {
+            auto fc = std::static_pointer_cast<AstFuncCallStmt>(stmt);
+            if (fc->name == "print") {
+                return compile_print(std::static_pointer_cast<AstExprList>(fc->expression));
+            }
+            return compile_call(fc->name, fc->expression);
+        }
+
+        case V_AstType::If: {
+            auto cond = std::static_pointer_cast<AstIfStmt>(stmt);
+            size_t to_false;
+            if (!compile_branch(cond->expression, false, &to_false)) return false;
+            if (!compile_block(cond->true_block)) return false;
+
+            if (cond->false_block && !cond->false_block->block.empty()) {
+                size_t to_end = emit(BcOp::Jmp);
+                current->code[to_false].c = current->code.size();
+                if (!compile_block(cond->false_block)) return false;
+                current->code[to_end].a = current->code.size();
+            } else {
+                current->code[to_false].c = current->code.size();
+            }
+        } break;
+
+        // The condition goes after the body, so each iteration takes one
+        // jump
+        case V_AstType::While: {
+            auto loop = std::static_pointer_cast<AstWhileStmt>(stmt);
+            size_t to_cond = emit(BcOp::Jmp);
+            size_t body = current->code.size();
+            if (!compile_block(loop->block)) return false;
+
+            current->code[to_cond].a = current->code.size();
+            next_int = int_locals;
+            size_t to_body;
+            if (!compile_branch(loop->expression, true, &to_body)) return false;
+            current->code[to_body].c = body;
+        } break;
+
+        default: return fail("Unsupported statement");
+    }
+
+    return true;
+}
+
+//
+// Emits a jump taken when the condition is equal to when. The target goes in
+// c of the instruction at patch.
+//
+bool BytecodeCompiler::compile_branch(std::shared_ptr<AstExpression> cond, bool when, size_t *patch) {
+    BcOp op;
+    switch (cond->type) {
+        case V_AstType::EQ:  op = when ? BcOp::JEq : BcOp::JNe; break;
+        case V_AstType::NEQ: op = when ? BcOp::JNe : BcOp::JEq; break;
+        case V_AstType::GT:  op = when ? BcOp::JGt : BcOp::JLe; break;
+        case V_AstType::LT:  op = when ? BcOp::JLt : BcOp::JGe; break;
+        case V_AstType::GTE: op = when ? BcOp::JGe : BcOp::JLt; break;
+        case V_AstType::LTE: op = when ? BcOp::JLe : BcOp::JGt; break;
+
+        default: {
+            uint32_t reg;
+            if (!compile_int(cond, &reg)) return false;
+            *patch = emit(when ? BcOp::Jnz : BcOp::Jz, reg);
+            return true;
+        }
+    }
+
+    auto cmp = std::static_pointer_cast<AstBinaryOp>(cond);
+    uint32_t lval, rval;
+    if (!compile_int(cmp->lval, &lval, true)) return false;
+    if (!compile_int(cmp->rval, &rval, true)) return false;
+    *patch = emit(op, lval, rval);
+    return true;
+}
+
+//
+// The builtin print call, as AstInterpreter::run_print does it
+//
+bool BytecodeCompiler::compile_print(std::shared_ptr<AstExprList> args) {
+    for (auto const &arg : args->list) {
+        uint32_t reg;
+        switch (arg->type) {
+            case V_AstType::StringL: {
+                auto s = std::static_pointer_cast<AstString>(arg);
+                emit(BcOp::PrintK, string_const(s->value));
+            } break;
+
+            case V_AstType::CharL: {
+                auto c = std::static_pointer_cast<AstChar>(arg);
+                emit(BcOp::PrintK, string_const(std::string(1, c->value)));
+            } break;
+
+            case V_AstType::IntL: {
+                auto i = std::static_pointer_cast<AstInt>(arg);
+                emit(BcOp::PrintU, int_const(i->value));
+            } break;
+
+            case V_AstType::ID: {
+                auto id = std::static_pointer_cast<AstID>(arg);
+                Local *local = find_local(id->value, BcKind::None);
+                if (!local) return fail("Unknown variable " + id->value.str());
+
+                switch (local->kind) {
+                    case BcKind::Int: emit(BcOp::PrintI, local->reg); break;
+                    case BcKind::String: emit(BcOp::PrintS, local->reg); break;
+                    case BcKind::IntArray: emit(BcOp::PrintIA, local->reg); break;
+                    case BcKind::StringArray: emit(BcOp::PrintSA, local->reg); break;
+                    default: {}
+                }
+            } break;
+
+            case V_AstType::ArrayAccess: {
+                auto acc = std::static_pointer_cast<AstArrayAccess>(arg);
+                Local *local = find_local(acc->value, BcKind::None);
+                if (!local) return fail("Unknown variable " + acc->value.str());
+                if (local->kind == BcKind::Int) return fail("Unsupported array access");
+                if (local->kind == BcKind::String && local->data_type->type != V_AstType::String) {
+                    return fail("Unsupported array access");
+                }
+
+                if (local->kind == BcKind::IntArray) {
+                    if (!compile_int(arg, &reg)) return false;
+                    emit(BcOp::PrintU, reg);
+                } else {
+                    if (!compile_string(arg, &reg)) return false;
+                    emit(BcOp::PrintS, reg);
+                }
+            } break;
+
+            case V_AstType::FuncCallExpr: {
+                auto fc = std::static_pointer_cast<AstFuncCallExpr>(arg);
+                if (fc->name == "length") {
+                    if (!compile_length(fc->args, &reg)) return false;
+                    emit(BcOp::PrintU, reg);
+                    break;
+                }
+
+                BcKind ret;
+                if (!compile_call(fc->name, fc->args, &ret)) return false;
+                if (ret == BcKind::Int) {
+                    reg = int_temp();
+                    emit(BcOp::IResult, reg);
+                    emit(BcOp::PrintU, reg);
+                } else if (ret == BcKind::String) {
+                    reg = string_temp();
+                    emit(BcOp::SResult, reg);
+                    emit(BcOp::PrintS, reg);
+                } else if (ret != BcKind::None) {
+                    return fail("Unsupported print of an array result");
+                }
+            } break;
+
+            case V_AstType::Add:
+            case V_AstType::Sub:
+            case V_AstType::Mul:
+            case V_AstType::Div:
+            case V_AstType::Mod:
+            case V_AstType::And:
+            case V_AstType::Or:
+            case V_AstType::Xor:
+            case V_AstType::Lsh:
+            case V_AstType::Rsh:
+            case V_AstType::EQ:
+            case V_AstType::NEQ:
+            case V_AstType::GT:
+            case V_AstType::LT:
+            case V_AstType::GTE:
+            case V_AstType::LTE: {
+                auto data_type = interpret_type(arg);
+                if (data_type == nullptr) {
+                    emit(BcOp::PrintK, string_const("[ERR:<UNK_TYPE>]"));
+                    break;
+                }
+                if (data_type->type != V_AstType::Int32) return fail("Unsupported print of an expression");
+
+                if (!compile_int(arg, &reg)) return false;
+                emit(BcOp::PrintU, reg);
+            } break;
+
+            default: return fail("Unsupported print argument");
+        }
+    }
+
+    emit(BcOp::PrintLn);
+    return true;
+}
+
+//
+// Calls a function, leaving its result to be taken with one of the result
+// instructions. Arguments are passed by value, arrays included.
+//
+bool BytecodeCompiler::compile_call(Symbol name, std::shared_ptr<AstExpression> args, BcKind *ret) {
+    auto found = function_ids.find(name);
+    if (found == function_ids.end()) return fail("Unknown function " + name.str());
+    auto func = functions[found->second];
+
+    auto list = std::static_pointer_cast<AstExprList>(args);
+    if (!list || list->list.size() != func->args.size()) return fail("Wrong argument count for " + name.str());
+
+    std::vector<uint32_t> regs;
+    for (size_t i = 0; i<list->list.size(); i++) {
+        auto arg = list->list[i];
+        BcKind kind = kind_of(func->args[i].type);
+        uint32_t reg;
+
+        switch (kind) {
+            case BcKind::Int: {
+                if (!compile_int(arg, &reg)) return false;
+            } break;
+
+            case BcKind::String: {
+                if (!compile_string(arg, &reg)) return false;
+            } break;
+
+            case BcKind::IntArray:
+            case BcKind::StringArray: {
+                if (arg->type != V_AstType::ID) return fail("Unsupported array argument");
+                auto id = std::static_pointer_cast<AstID>(arg);
+                Local *local = find_local(id->value, kind);
+                if (!local) return fail("Unsupported array argument");
+                reg = local->reg;
+            } break;
+
+            default: return fail("Unsupported argument type");
+        }
+
+        regs.push_back(reg);
+    }
+
+    uint32_t start = current->call_args.size();
+    current->call_args.insert(current->call_args.end(), regs.begin(), regs.end());
+    emit(BcOp::Call, found->second, start);
+
+    if (ret) {
+        *ret = BcKind::None;
+        if (func->data_type && func->data_type->type != V_AstType::Void) *ret = kind_of(func->data_type);
+    }
+    return true;
+}
+
+//
+// The builtin length call, as AstInterpreter::call_function does it
+//
+bool BytecodeCompiler::compile_length(std::shared_ptr<AstExpression> args, uint32_t *reg) {
+    auto list = std::static_pointer_cast<AstExprList>(args);
+    if (!list || list->list.empty()) return fail("Unsupported length call");
+    auto arg = list->list[0];
+
+    if (arg->type == V_AstType::StringL) {
+        auto s = std::static_pointer_cast<AstString>(arg);
+        *reg = int_const(s->value.length());
+        return true;
+    }
+
+    if (arg->type != V_AstType::ID) return fail("Unsupported length call");
+    auto id = std::static_pointer_cast<AstID>(arg);
+    Local *local = find_local(id->value, BcKind::None);
+    if (!local) return fail("Unknown variable " + id->value.str());
+
+    *reg = int_temp();
+    switch (local->kind) {
+        case BcKind::IntArray: emit(BcOp::IALen, *reg, local->reg); break;
+        case BcKind::StringArray: emit(BcOp::SALen, *reg, local->reg); break;
+        case BcKind::String: {
+            if (local->data_type->type != V_AstType::String) return fail("Unsupported length call");
+            emit(BcOp::SLen, *reg, local->reg);
+        } break;
+
+        default: return fail("Unsupported length call");
+    }
+
+    return true;
+}
+
+//
+// Integer expressions
+//
+// Literals of other types and negation are only understood as operands of an
+// operator, as in AstInterpreter::run_flat_iexpression.
+//
+bool BytecodeCompiler::compile_int(std::shared_ptr<AstExpression> expr, uint32_t *reg, bool operand) {
+    switch (expr->type) {
+        case V_AstType::IntL: {
+            auto i = std::static_pointer_cast<AstInt>(expr);
+            *reg = int_const(i->value);
+        } break;
+
+        case V_AstType::CharL: {
+            if (!operand) return fail("Unsupported integer expression");
+            auto c = std::static_pointer_cast<AstChar>(expr);
+            *reg = int_const((uint8_t)c->value);
+        } break;
+
+        case V_AstType::FloatL: {
+            if (!operand) return fail("Unsupported integer expression");
+            auto flt = std::static_pointer_cast<AstFloat>(expr);
+            *reg = int_const((int64_t)flt->value);
+        } break;
+
+        case V_AstType::ID: {
+            auto id = std::static_pointer_cast<AstID>(expr);
+            Local *local = find_local(id->value, BcKind::Int);
+            if (!local) return fail("Unsupported use of " + id->value.str());
+            *reg = local->reg;
+        } break;
+
+        case V_AstType::ArrayAccess: {
+            auto acc = std::static_pointer_cast<AstArrayAccess>(expr);
+            Local *local = find_local(acc->value, BcKind::IntArray);
+            if (!local) return fail("Unsupported use of " + acc->value.str());
+
+            uint32_t idx;
+            if (!compile_int(acc->index, &idx)) return false;
+            *reg = int_temp();
+            emit(BcOp::IALoad, *reg, local->reg, idx);
+        } break;
+
+        case V_AstType::FuncCallExpr: {
+            auto fc = std::static_pointer_cast<AstFuncCallExpr>(expr);
+            if (fc->name == "length") return compile_length(fc->args, reg);
+
+            BcKind ret;
+            if (!compile_call(fc->name, fc->args, &ret)) return false;
+            if (ret != BcKind::Int && ret != BcKind::None) return fail("Unsupported call in an integer expression");
+            *reg = int_temp();
+            emit(BcOp::IResult, *reg);
+        } break;
+
+        case V_AstType::Neg: {
+            if (!operand) return fail("Unsupported integer expression");
+            auto op = std::static_pointer_cast<AstNegOp>(expr);
+            uint32_t val;
+            if (!compile_int(op->value, &val, true)) return false;
+            *reg = int_temp();
+            emit(BcOp::INeg, *reg, val);
+        } break;
+
+        case V_AstType::Add:
+        case V_AstType::Sub:
+        case V_AstType::Mul:
+        case V_AstType::Div:
+        case V_AstType::Mod:
+        case V_AstType::And:
+        case V_AstType::Or:
+        case V_AstType::Xor:
+        case V_AstType::Lsh:
+        case V_AstType::Rsh:
+        case V_AstType::EQ:
+        case V_AstType::NEQ:
+        case V_AstType::GT:
+        case V_AstType::LT:
+        case V_AstType::GTE:
+        case V_AstType::LTE: {
+            BcOp op;
+            switch (expr->type) {
+                case V_AstType::Add: op = BcOp::IAdd; break;
+                case V_AstType::Sub: op = BcOp::ISub; break;
+                case V_AstType::Mul: op = BcOp::IMul; break;
+                case V_AstType::Div: op = BcOp::IDiv; break;
+                case V_AstType::Mod: op = BcOp::IMod; break;
+                case V_AstType::And: op = BcOp::IAnd; break;
+                case V_AstType::Or:  op = BcOp::IOr; break;
+                case V_AstType::Xor: op = BcOp::IXor; break;
+                case V_AstType::Lsh: op = BcOp::ILsh; break;
+                case V_AstType::Rsh: op = BcOp::IRsh; break;
+                case V_AstType::EQ:  op = BcOp::IEq; break;
+                case V_AstType::NEQ: op = BcOp::INe; break;
+                case V_AstType::GT:  op = BcOp::IGt; break;
+                case V_AstType::LT:  op = BcOp::ILt; break;
+                case V_AstType::GTE: op = BcOp::IGe; break;
+                default: op = BcOp::ILe;
+            }
+
+            auto bin = std::static_pointer_cast<AstBinaryOp>(expr);
+            uint32_t lval, rval;
+            if (!compile_int(bin->lval, &lval, true)) return false;
+            if (!compile_int(bin->rval, &rval, true)) return false;
+            *reg = int_temp();
+            emit(op, *reg, lval, rval);
+        } break;
+
+        default: return fail("Unsupported integer expression");
+    }
+
+    return true;
+}
+
+bool BytecodeCompiler::compile_int_assign(std::shared_ptr<AstAssignOp> op) {
+    switch (op->lval->type) {
+        case V_AstType::ID: {
+            auto id = std::static_pointer_cast<AstID>(op->lval);
+            Local *local = find_local(id->value, BcKind::None);
+            if (!local) return fail("Unknown variable " + id->value.str());
+
+            if (local->kind == BcKind::Int) {
+                uint32_t reg;
+                if (!compile_int(op->rval, &reg)) return false;
+                emit(BcOp::IStore, local->reg, reg);
+                return true;
+            }
+
+            // Arrays are only assigned a new array or the result of a call
+            if (local->kind != BcKind::IntArray || op->rval->type != V_AstType::FuncCallExpr) {
+                return fail("Unsupported assignment to " + id->value.str());
+            }
+
+            auto fc = std::static_pointer_cast<AstFuncCallExpr>(op->rval);
+            if (fc->name == "malloc" || fc->name == "gc_alloc") {
+                auto args = std::static_pointer_cast<AstExprList>(fc->args);
+                if (args->list.empty() || args->list[0]->type != V_AstType::Mul) return fail("Unsupported allocation");
+
+                auto mul = std::static_pointer_cast<AstMulOp>(args->list[0]);
+                uint32_t length;
+                if (!compile_int(mul->rval, &length)) return false;
+                emit(BcOp::IANew, local->reg, length);
+                return true;
+            }
+
+            BcKind ret;
+            if (!compile_call(fc->name, fc->args, &ret)) return false;
+            if (ret != BcKind::IntArray) return fail("Unsupported assignment to " + id->value.str());
+            emit(BcOp::IAResult, local->reg);
+        } break;
+
+        // The value is taken before the index
+        case V_AstType::ArrayAccess: {
+            auto acc = std::static_pointer_cast<AstArrayAccess>(op->lval);
+            Local *local = find_local(acc->value, BcKind::IntArray);
+            if (!local) return fail("Unsupported assignment to " + acc->value.str());
+
+            uint32_t value, idx;
+            if (!compile_int(op->rval, &value)) return false;
+            if (!compile_int(acc->index, &idx)) return false;
+            emit(BcOp::IAStore, local->reg, idx, value);
+        } break;
+
+        default: return fail("Unsupported assignment");
+    }
+
+    return true;
+}
+
+//
+// String expressions
+//
+bool BytecodeCompiler::compile_string(std::shared_ptr<AstExpression> expr, uint32_t *reg) {
+    switch (expr->type) {
+        case V_AstType::IntL: {
+            auto i = std::static_pointer_cast<AstInt>(expr);
+            *reg = string_temp();
+            emit(BcOp::SConst, *reg, string_const(std::to_string(i->value)));
+        } break;
+
+        case V_AstType::CharL: {
+            auto c = std::static_pointer_cast<AstChar>(expr);
+            *reg = string_temp();
+            emit(BcOp::SConst, *reg, string_const(std::string(1, c->value)));
+        } break;
+
+        case V_AstType::StringL: {
+            auto s = std::static_pointer_cast<AstString>(expr);
+            *reg = string_temp();
+            emit(BcOp::SConst, *reg, string_const(s->value));
+        } break;
+
+        case V_AstType::ID: {
+            auto id = std::static_pointer_cast<AstID>(expr);
+            Local *local = find_local(id->value, BcKind::String);
+            if (!local) return fail("Unsupported use of " + id->value.str());
+            *reg = local->reg;
+        } break;
+
+        // Indexing a string gives a string of the one character
+        case V_AstType::ArrayAccess: {
+            auto acc = std::static_pointer_cast<AstArrayAccess>(expr);
+            Local *local = find_local(acc->value, BcKind::None);
+            if (!local) return fail("Unknown variable " + acc->value.str());
+
+            BcOp op;
+            if (local->kind == BcKind::String && local->data_type->type == V_AstType::String) op = BcOp::SChar;
+            else if (local->kind == BcKind::StringArray) op = BcOp::SALoad;
+            else return fail("Unsupported use of " + acc->value.str());
+
+            uint32_t idx;
+            if (!compile_int(acc->index, &idx)) return false;
+            *reg = string_temp();
+            emit(op, *reg, local->reg, idx);
+        } break;
+
+        case V_AstType::FuncCallExpr: {
+            auto fc = std::static_pointer_cast<AstFuncCallExpr>(expr);
+            BcKind ret;
+            if (!compile_call(fc->name, fc->args, &ret)) return false;
+            if (ret != BcKind::String) return fail("Unsupported call in a string expression");
+            *reg = string_temp();
+            emit(BcOp::SResult, *reg);
+        } break;
+
+        default: return fail("Unsupported string expression");
+    }
+
+    return true;
+}
+
+bool BytecodeCompiler::compile_string_assign(std::shared_ptr<AstAssignOp> op) {
+    switch (op->lval->type) {
+        case V_AstType::ID: {
+            auto id = std::static_pointer_cast<AstID>(op->lval);
+            Local *local = find_local(id->value, BcKind::None);
+            if (!local) return fail("Unknown variable " + id->value.str());
+
+            if (local->kind == BcKind::String) {
+                uint32_t reg;
+                if (!compile_string(op->rval, &reg)) return false;
+
+                // Write the value straight into the variable when it was made
+                // for this assignment
+                auto &last = current->code.back();
+                if (reg >= string_locals && last.a == reg) {
+                    last.a = local->reg;
+                } else if (reg != local->reg) {
+                    emit(BcOp::SMov, local->reg, reg);
+                }
+                return true;
+            }
+
+            if (local->kind != BcKind::StringArray || op->rval->type != V_AstType::FuncCallExpr) {
+                return fail("Unsupported assignment to " + id->value.str());
+            }
+
+            auto fc = std::static_pointer_cast<AstFuncCallExpr>(op->rval);
+            if (fc->name == "malloc" || fc->name == "gc_alloc") {
+                auto args = std::static_pointer_cast<AstExprList>(fc->args);
+                if (args->list.empty() || args->list[0]->type != V_AstType::Mul) return fail("Unsupported allocation");
+
+                auto mul = std::static_pointer_cast<AstMulOp>(args->list[0]);
+                uint32_t length;
+                if (!compile_int(mul->rval, &length)) return false;
+                emit(BcOp::SANew, local->reg, length);
+                return true;
+            }
+
+            BcKind ret;
+            if (!compile_call(fc->name, fc->args, &ret)) return false;
+            if (ret != BcKind::StringArray) return fail("Unsupported assignment to " + id->value.str());
+            emit(BcOp::SAResult, local->reg);
+        } break;
+
+        case V_AstType::ArrayAccess: {
+            auto acc = std::static_pointer_cast<AstArrayAccess>(op->lval);
+            Local *local = find_local(acc->value, BcKind::StringArray);
+            if (!local) return fail("Unsupported assignment to " + acc->value.str());
+
+            uint32_t value, idx;
+            if (!compile_string(op->rval, &value)) return false;
+            if (!compile_int(acc->index, &idx)) return false;
+            emit(BcOp::SAStore, local->reg, idx, value);
+        } break;
+
+        default: return fail("Unsupported assignment");
+    }
+
+    return true;
+}
+
+//
+// Types and variables
+//
+BcKind BytecodeCompiler::kind_of(std::shared_ptr<AstDataType> data_type) {
+    if (!data_type) return BcKind::None;
+
+    switch (data_type->type) {
+        case V_AstType::Bool:
+        case V_AstType::Int8:
+        case V_AstType::Int16:
+        case V_AstType::Int32:
+        case V_AstType::Int64: return BcKind::Int;
+
+        case V_AstType::Char:
+        case V_AstType::String: return BcKind::String;
+
+        case V_AstType::Ptr: {
+            auto base = kind_of(std::static_pointer_cast<AstPointerType>(data_type)->base_type);
+            if (base == BcKind::Int) return BcKind::IntArray;
+            if (base == BcKind::String) return BcKind::StringArray;
+        } break;
+
+        default: {}
+    }
+
+    return BcKind::None;
+}
+
+// Returns null if there is no such variable of that kind; None matches any
+BytecodeCompiler::Local *BytecodeCompiler::find_local(Symbol name, BcKind kind) {
+    auto found = locals.find(name);
+    if (found == locals.end()) return nullptr;
+    if (kind != BcKind::None && found->second.kind != kind) return nullptr;
+    return &found->second;
+}
+
+bool BytecodeCompiler::declare(Symbol name, std::shared_ptr<AstDataType> data_type, Local **local) {
+    BcKind kind = kind_of(data_type);
+    if (kind == BcKind::None) return fail("Unsupported type for " + name.str());
+
+    auto found = locals.find(name);
+    if (found != locals.end()) {
+        if (found->second.kind != kind) return fail("Conflicting types for " + name.str());
+        *local = &found->second;
+        return true;
+    }
+
+    uint32_t reg = 0;
+    switch (kind) {
+        case BcKind::Int: reg = int_locals++; break;
+        case BcKind::String: reg = string_locals++; break;
+        case BcKind::IntArray: reg = current->iaregs++; break;
+        case BcKind::StringArray: reg = current->saregs++; break;
+        default: {}
+    }
+
+    // The tree interpreter keeps the element type of an array
+    if (data_type->type == V_AstType::Ptr) {
+        data_type = std::static_pointer_cast<AstPointerType>(data_type)->base_type;
+    }
+
+    locals[name] = { kind, reg, data_type };
+    *local = &locals[name];
+    return true;
+}
+
+// As AstInterpreter::interpret_type
+std::shared_ptr<AstDataType> BytecodeCompiler::interpret_type(std::shared_ptr<AstExpression> expr) {
+    switch (expr->type) {
+        case V_AstType::IntL: return AstBuilder::buildInt32Type();
+
+        case V_AstType::ID: {
+            auto id = std::static_pointer_cast<AstID>(expr);
+            Local *local = find_local(id->value, BcKind::None);
+            if (!local) return nullptr;
+            return local->data_type;
+        }
+
+        case V_AstType::Add:
+        case V_AstType::Sub:
+        case V_AstType::Mul:
+        case V_AstType::Div:
+        case V_AstType::Mod:
+        case V_AstType::And:
+        case V_AstType::Or:
+        case V_AstType::Xor:
+        case V_AstType::Lsh:
+        case V_AstType::Rsh:
+        case V_AstType::EQ:
+        case V_AstType::NEQ:
+        case V_AstType::GT:
+        case V_AstType::LT:
+        case V_AstType::GTE:
+        case V_AstType::LTE: {
+            auto op = std::static_pointer_cast<AstBinaryOp>(expr);
+            auto d_type = interpret_type(op->lval);
+            if (d_type) return d_type;
+            return interpret_type(op->rval);
+        }
+
+        default: {}
+    }
+
+    return nullptr;
+}
+
+//
+// Registers and instructions
+//
+uint32_t BytecodeCompiler::int_temp() {
+    uint32_t reg = next_int++;
+    if (next_int > max_int) max_int = next_int;
+    return reg;
+}
+
+uint32_t BytecodeCompiler::string_temp() {
+    uint32_t reg = next_string++;
+    if (next_string > max_string) max_string = next_string;
+    return reg;
+}
+
+uint32_t BytecodeCompiler::int_const(uint64_t value) {
+    for (size_t i = 0; i<iconsts.size(); i++) {
+        if (iconsts[i] == value) return const_mark | i;
+    }
+    iconsts.push_back(value);
+    return const_mark | (iconsts.size() - 1);
+}
+
+uint32_t BytecodeCompiler::string_const(const std::string &value) {
+    auto &sconsts = program->sconsts;
+    for (size_t i = 0; i<sconsts.size(); i++) {
+        if (sconsts[i].view() == value) return i;
+    }
+    sconsts.push_back(value);
+    return sconsts.size() - 1;
+}
+
+size_t BytecodeCompiler::emit(BcOp op, uint32_t a, uint32_t b, uint32_t c) {
+    current->code.push_back({ op, a, b, c });
+    return current->code.size() - 1;
+}
+
+bool BytecodeCompiler::fail(std::string msg) {
+    if (current_func) error_msg = current_func->name.str() + ": " + msg;
+    else error_msg = msg;
+    return false;
+}
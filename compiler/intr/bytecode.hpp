@@ -0,0 +1,232 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#pragma once
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+#include <ast/ast.hpp>
+
+#include "buffer.hpp"
+
+//
+// The bytecode form of the interpreter
+//
+// Each function is lowered once to instructions on typed registers. A frame
+// has four register files: integers, strings, integer arrays and string
+// arrays. Every local variable and argument has a fixed register, followed by
+// the temporaries of the expressions. Integer constants take the registers at
+// the end of the integer file, and are copied in when the frame is entered.
+//
+// The bytecode does what the tree interpreter does, down to the width of the
+// values, so a program gives the same output with either. Anything it cannot
+// do the same way fails to compile, and the program is left to the tree
+// interpreter.
+//
+
+//
+// The instructions. Registers are a, b and c, in the file the name says.
+// Jump targets are instruction numbers.
+//
+#define BYTECODE_OPS(X) \
+    X(IMov)         /* i[a] = i[b] */ \
+    X(IStore)       /* i[a] = (int)i[b], for variables */ \
+    X(INeg)         /* i[a] = -i[b] */ \
+    X(IAdd)         /* i[a] = i[b] + i[c], and so on */ \
+    X(ISub) \
+    X(IMul) \
+    X(IDiv) \
+    X(IMod) \
+    X(IAnd) \
+    X(IOr) \
+    X(IXor) \
+    X(ILsh) \
+    X(IRsh) \
+    X(IEq) \
+    X(INe) \
+    X(IGt) \
+    X(ILt) \
+    X(IGe) \
+    X(ILe) \
+    X(Jmp)          /* goto a */ \
+    X(Jz)           /* if (!i[a]) goto c */ \
+    X(Jnz)          /* if (i[a]) goto c */ \
+    X(JEq)          /* if (i[a] == i[b]) goto c, and so on */ \
+    X(JNe) \
+    X(JLe) \
+    X(JGe) \
+    X(JLt) \
+    X(JGt) \
+    X(SConst)       /* s[a] = constant b */ \
+    X(SMov)         /* s[a] = s[b] */ \
+    X(SClear)       /* s[a] = "" */ \
+    X(SChar)        /* s[a] = s[b][i[c]] */ \
+    X(SLen)         /* i[a] = length of s[b] */ \
+    X(IANew)        /* ia[a] = i[b] zeros */ \
+    X(IAClear)      /* ia[a] = [] */ \
+    X(IALoad)       /* i[a] = ia[b][i[c]] */ \
+    X(IAStore)      /* ia[a][i[b]] = (int)i[c] */ \
+    X(IALen)        /* i[a] = length of ia[b] */ \
+    X(SANew)        /* sa[a] = i[b] empty strings */ \
+    X(SAClear)      /* sa[a] = [] */ \
+    X(SALoad)       /* s[a] = sa[b][i[c]] */ \
+    X(SAStore)      /* sa[a][i[b]] = s[c] */ \
+    X(SALen)        /* i[a] = length of sa[b] */ \
+    X(Call)         /* function a, with the arguments listed from b */ \
+    X(IResult)      /* i[a] = the result of the last call */ \
+    X(SResult) \
+    X(IAResult) \
+    X(SAResult) \
+    X(IRet)         /* the return value is i[a] */ \
+    X(SRet)         /* the return value is s[a] */ \
+    X(IARet)        /* the return value is ia[a] when the function ends */ \
+    X(SARet)        /* the return value is sa[a] when the function ends */ \
+    X(End) \
+    X(PrintI)       /* print (int)i[a] */ \
+    X(PrintU)       /* print i[a] */ \
+    X(PrintS)       /* print s[a] */ \
+    X(PrintK)       /* print constant a */ \
+    X(PrintIA)      /* print ia[a] */ \
+    X(PrintSA)      /* print sa[a] */ \
+    X(PrintLn)
+
+enum class BcOp : uint32_t {
+#define BYTECODE_ENUM(name) name,
+    BYTECODE_OPS(BYTECODE_ENUM)
+#undef BYTECODE_ENUM
+};
+
+struct BcInstr {
+    BcOp op;
+    uint32_t a = 0;
+    uint32_t b = 0;
+    uint32_t c = 0;
+};
+
+// The register file a value lives in
+enum class BcKind : uint8_t {
+    None,
+    Int,
+    String,
+    IntArray,
+    StringArray
+};
+
+struct BcFunction {
+    Symbol name;
+    std::vector<BcKind> params;
+    BcKind ret = BcKind::None;
+
+    // The register counts, integer constants included
+    uint32_t iregs = 0;
+    uint32_t sregs = 0;
+    uint32_t iaregs = 0;
+    uint32_t saregs = 0;
+
+    std::vector<uint64_t> iconsts;
+    std::vector<BcInstr> code;
+
+    // The caller registers of the arguments of each call, in order
+    std::vector<uint32_t> call_args;
+};
+
+struct BcProgram {
+    std::vector<BcFunction> functions;
+    std::vector<IntrString> sconsts;
+    uint32_t main = 0;
+
+    void print();
+};
+
+//
+// Lowers the functions of a tree to bytecode
+//
+class BytecodeCompiler {
+public:
+    explicit BytecodeCompiler(std::shared_ptr<AstTree> tree);
+
+    // Returns null if the tree cannot be run as bytecode; error() says why
+    std::shared_ptr<BcProgram> compile();
+    std::string error() { return error_msg; }
+protected:
+    struct Local {
+        BcKind kind;
+        uint32_t reg;
+        std::shared_ptr<AstDataType> data_type;
+    };
+
+    bool compile_function(std::shared_ptr<AstFunction> func, BcFunction &bc);
+    bool compile_block(std::shared_ptr<AstBlock> block);
+    bool compile_statement(std::shared_ptr<AstStatement> stmt);
+    bool compile_print(std::shared_ptr<AstExprList> args);
+    bool compile_call(Symbol name, std::shared_ptr<AstExpression> args, BcKind *ret = nullptr);
+    bool compile_branch(std::shared_ptr<AstExpression> cond, bool when, size_t *patch);
+
+    bool compile_int(std::shared_ptr<AstExpression> expr, uint32_t *reg, bool operand = false);
+    bool compile_string(std::shared_ptr<AstExpression> expr, uint32_t *reg);
+    bool compile_int_assign(std::shared_ptr<AstAssignOp> op);
+    bool compile_string_assign(std::shared_ptr<AstAssignOp> op);
+    bool compile_length(std::shared_ptr<AstExpression> args, uint32_t *reg);
+
+    BcKind kind_of(std::shared_ptr<AstDataType> data_type);
+    Local *find_local(Symbol name, BcKind kind);
+    bool declare(Symbol name, std::shared_ptr<AstDataType> data_type, Local **local);
+    std::shared_ptr<AstDataType> interpret_type(std::shared_ptr<AstExpression> expr);
+
+    uint32_t int_temp();
+    uint32_t string_temp();
+    uint32_t int_const(uint64_t value);
+    uint32_t string_const(const std::string &value);
+    size_t emit(BcOp op, uint32_t a = 0, uint32_t b = 0, uint32_t c = 0);
+    bool fail(std::string msg);
+private:
+    std::shared_ptr<AstTree> tree;
+    std::shared_ptr<BcProgram> program;
+    SymbolMap<uint32_t> function_ids;
+    std::vector<std::shared_ptr<AstFunction>> functions;
+    std::string error_msg = "";
+
+    // The function being compiled
+    BcFunction *current = nullptr;
+    std::shared_ptr<AstFunction> current_func;
+    SymbolMap<Local> locals;
+    uint32_t int_locals = 0;
+    uint32_t string_locals = 0;
+    uint32_t next_int = 0;
+    uint32_t next_string = 0;
+    uint32_t max_int = 0;
+    uint32_t max_string = 0;
+    std::vector<uint64_t> iconsts;
+};
+
+//
+// Runs bytecode
+//
+class BytecodeVM {
+public:
+    explicit BytecodeVM(std::shared_ptr<BcProgram> program);
+    int run();
+protected:
+    void run_function(const BcFunction &func, size_t ibase, size_t sbase, size_t iabase, size_t sabase);
+    void reserve(const BcFunction &func, size_t ibase, size_t sbase, size_t iabase, size_t sabase);
+private:
+    std::shared_ptr<BcProgram> program;
+
+    // The registers of every active frame. A frame starts where its caller's
+    // ends, so these are only ever grown.
+    std::vector<uint64_t> istore;
+    std::vector<IntrString> sstore;
+    std::vector<IntrBuffer<uint64_t>> iastore;
+    std::vector<IntrBuffer<IntrString>> sastore;
+
+    // The value returned by the last call
+    uint64_t iret = 0;
+    IntrString sret;
+    IntrBuffer<uint64_t> iaret;
+    IntrBuffer<IntrString> saret;
+};
@@ -1,7 +1,10 @@
 #include <iostream>
+#include <algorithm>
+#include <cmath>
 
 #include <ast/ast.hpp>
 #include <ast/ast_builder.hpp>
+#include <ast/flat_expr.hpp>
 
 #include "interpreter.hpp"
 
@@ -14,6 +17,21 @@ void AstInterpreter::run_expression(std::shared_ptr<IntrContext> ctx, std::share
     else if (is_string_type(type)) run_sexpression(ctx, expr);
 }
 
+//
+// Whether a node can be run with run_number
+//
+static bool is_number_node(V_AstType type) {
+    return FlatExpr::is_operator(type) || FlatExpr::is_literal(type);
+}
+
+//
+// Stores a float in a variable or array element of the given type
+//
+static double store_float(const std::shared_ptr<AstDataType> &data_type, double value) {
+    if (data_type && data_type->type == V_AstType::Float32) return (float)value;
+    return value;
+}
+
 // Runs an integer-based expression
 void AstInterpreter::run_iexpression(std::shared_ptr<IntrContext> ctx, std::shared_ptr<AstExpression> expr) {
     switch (expr->type) {
@@ -23,13 +41,21 @@ void AstInterpreter::run_iexpression(std::shared_ptr<IntrContext> ctx, std::shar
             ctx->istack.push(i->value);
         } break;
         
+        case V_AstType::FloatL: {
+            auto f = std::static_pointer_cast<AstFloat>(expr);
+            ctx->istack.push((int64_t)f->value);
+        } break;
+        
         // Variables
         case V_AstType::ID: {
             auto id = std::static_pointer_cast<AstID>(expr);
-            if (is_int_array(ctx, id->value)) {
-                ctx->sstack.push(id->value);
+            auto &slot = ctx->var(id->value);
+            if (slot.kind == IntrKind::IntArray) {
+                ctx->sstack.push(id->value.str());
+            } else if (slot.kind == IntrKind::Float) {
+                ctx->istack.push((int64_t)slot.fvalue);
             } else {
-                ctx->istack.push(ctx->ivar_map[id->value]);
+                ctx->istack.push(slot.ivalue);
             }
         } break;
         
@@ -38,7 +64,13 @@ void AstInterpreter::run_iexpression(std::shared_ptr<IntrContext> ctx, std::shar
             run_iexpression(ctx, acc->index);
             int idx = ctx->istack.top();
             ctx->istack.pop();
-            ctx->istack.push(ctx->iarray_map[acc->value][idx]);
+            
+            auto &slot = ctx->var(acc->value);
+            if (slot.kind == IntrKind::FloatArray) {
+                ctx->istack.push((int64_t)slot.farray[idx]);
+            } else {
+                ctx->istack.push(slot.iarray[idx]);
+            }
         } break;
         
         // Function call expression
@@ -49,19 +81,17 @@ void AstInterpreter::run_iexpression(std::shared_ptr<IntrContext> ctx, std::shar
                 auto mul = std::static_pointer_cast<AstMulOp>(args->list[0]);
                 run_iexpression(ctx, mul->rval);
                 int length = ctx->istack.top();
-                ctx->istack_array = std::vector<uint64_t>();
-                for (int i = 0; i<length; i++) {
-                    ctx->istack_array.push_back(0);
-                }
+                ctx->istack_array = IntrBuffer<uint64_t>(std::max(length, 0), 0);
                 ctx->istack.pop();
             } else {
                 auto func = function_map[fc->name];
                 if (func && func->data_type->type == V_AstType::Ptr) {
                     auto array = call_function(ctx, fc->name, std::static_pointer_cast<AstExprList>(fc->args));
-                    ctx->istack_array = *std::get_if<std::vector<uint64_t>>(&array);
+                    ctx->istack_array = std::move(*std::get_if<IntrBuffer<uint64_t>>(&array));
                 } else {
                     auto value = call_function(ctx, fc->name, std::static_pointer_cast<AstExprList>(fc->args));
-                    ctx->istack.push(*std::get_if<uint64_t>(&value));
+                    if (auto f = std::get_if<double>(&value)) ctx->istack.push((int64_t)*f);
+                    else ctx->istack.push(*std::get_if<uint64_t>(&value));
                 }
             }
         } break;
@@ -69,17 +99,27 @@ void AstInterpreter::run_iexpression(std::shared_ptr<IntrContext> ctx, std::shar
         // Assign operator
         case V_AstType::Assign: {
             auto op = std::static_pointer_cast<AstAssignOp>(expr);
+            
+            // Numbers go straight into scalar variables
+            if (op->lval->type == V_AstType::ID && is_number_node(op->rval->type)) {
+                auto &slot = ctx->var(std::static_pointer_cast<AstID>(op->lval)->value);
+                if (slot.kind == IntrKind::Int) {
+                    slot.ivalue = run_number(ctx, op->rval).as_int();
+                    break;
+                }
+            }
+            
             run_iexpression(ctx, op->rval);
             
             switch (op->lval->type) {
                 // Simple variables
                 case V_AstType::ID: {
                     auto id = std::static_pointer_cast<AstID>(op->lval);
-                    if (is_int_array(ctx, id->value)) {
-                        ctx->iarray_map[id->value] = ctx->istack_array;
-                        ctx->istack_array.clear();
+                    auto &slot = ctx->var(id->value);
+                    if (slot.kind == IntrKind::IntArray) {
+                        slot.iarray = std::move(ctx->istack_array);
                     } else {
-                        ctx->ivar_map[id->value] = ctx->istack.top();
+                        slot.ivalue = ctx->istack.top();
                         ctx->istack.pop();
                     }
                 } break;
@@ -94,7 +134,7 @@ void AstInterpreter::run_iexpression(std::shared_ptr<IntrContext> ctx, std::shar
                     int idx = ctx->istack.top();
                     ctx->istack.pop();
                     
-                    ctx->iarray_map[acc->value][idx] = value;
+                    ctx->var(acc->value).iarray.write(idx) = value;
                 } break;
                 
                 // Unknown lval
@@ -103,6 +143,7 @@ void AstInterpreter::run_iexpression(std::shared_ptr<IntrContext> ctx, std::shar
         } break;
         
         // Operators
+        case V_AstType::Neg:
         case V_AstType::Add:
         case V_AstType::Sub:
         case V_AstType::Mul:
@@ -120,40 +161,320 @@ void AstInterpreter::run_iexpression(std::shared_ptr<IntrContext> ctx, std::shar
         case V_AstType::GTE:
         case V_AstType::LTE:
         {
-            auto op = std::static_pointer_cast<AstBinaryOp>(expr);
-            run_iexpression(ctx, op->lval);
-            run_iexpression(ctx, op->rval);
-            
-            uint64_t rval = ctx->istack.top();
-            ctx->istack.pop();
-            uint64_t lval = ctx->istack.top();
-            ctx->istack.pop();
-            
-            if (expr->type == V_AstType::Add) ctx->istack.push(lval + rval);
-            else if (expr->type == V_AstType::Sub) ctx->istack.push(lval - rval);
-            else if (expr->type == V_AstType::Mul) ctx->istack.push(lval * rval);
-            else if (expr->type == V_AstType::Div) ctx->istack.push(lval / rval);
-            else if (expr->type == V_AstType::Mod) ctx->istack.push(lval % rval);
-            else if (expr->type == V_AstType::And) ctx->istack.push(lval & rval);
-            else if (expr->type == V_AstType::Or)  ctx->istack.push(lval | rval);
-            else if (expr->type == V_AstType::Xor) ctx->istack.push(lval ^ rval);
-            else if (expr->type == V_AstType::Lsh) ctx->istack.push(lval << rval);
-            else if (expr->type == V_AstType::Rsh) ctx->istack.push(lval >> rval);
-            else if (expr->type == V_AstType::EQ)  ctx->istack.push((int)(lval == rval));
-            else if (expr->type == V_AstType::NEQ) ctx->istack.push((int)(lval != rval));
-            else if (expr->type == V_AstType::GT)  ctx->istack.push((int)(lval > rval));
-            else if (expr->type == V_AstType::LT)  ctx->istack.push((int)(lval < rval));
-            else if (expr->type == V_AstType::GTE) ctx->istack.push((int)(lval >= rval));
-            else if (expr->type == V_AstType::LTE) ctx->istack.push((int)(lval <= rval));
+            ctx->istack.push(run_number(ctx, expr).as_int());
         } break;
         
         default: {}
     }
 }
 
+//
+// Applies an operator to two numbers
+//
+// Integers work as they always have: 64 bits wide, compared unsigned. If
+// either side is a float, the other is converted and the operator is done in
+// double precision. The bitwise operators and the shifts always work on
+// integers.
+//
+static IntrNumber apply_operator(V_AstType op, IntrNumber lval, IntrNumber rval) {
+    if (!lval.is_float && !rval.is_float) {
+        uint64_t l = lval.i;
+        uint64_t r = rval.i;
+        switch (op) {
+            case V_AstType::Neg: return IntrNumber(-l);
+            case V_AstType::Add: return IntrNumber(l + r);
+            case V_AstType::Sub: return IntrNumber(l - r);
+            case V_AstType::Mul: return IntrNumber(l * r);
+            case V_AstType::Div: return IntrNumber(l / r);
+            case V_AstType::Mod: return IntrNumber(l % r);
+            case V_AstType::EQ:  return IntrNumber((uint64_t)(l == r));
+            case V_AstType::NEQ: return IntrNumber((uint64_t)(l != r));
+            case V_AstType::GT:  return IntrNumber((uint64_t)(l > r));
+            case V_AstType::LT:  return IntrNumber((uint64_t)(l < r));
+            case V_AstType::GTE: return IntrNumber((uint64_t)(l >= r));
+            case V_AstType::LTE: return IntrNumber((uint64_t)(l <= r));
+            default: {}
+        }
+    } else {
+        double l = lval.as_float();
+        double r = rval.as_float();
+        switch (op) {
+            case V_AstType::Neg: return IntrNumber(-l);
+            case V_AstType::Add: return IntrNumber(l + r);
+            case V_AstType::Sub: return IntrNumber(l - r);
+            case V_AstType::Mul: return IntrNumber(l * r);
+            case V_AstType::Div: return IntrNumber(l / r);
+            case V_AstType::Mod: return IntrNumber(std::fmod(l, r));
+            case V_AstType::EQ:  return IntrNumber((uint64_t)(l == r));
+            case V_AstType::NEQ: return IntrNumber((uint64_t)(l != r));
+            case V_AstType::GT:  return IntrNumber((uint64_t)(l > r));
+            case V_AstType::LT:  return IntrNumber((uint64_t)(l < r));
+            case V_AstType::GTE: return IntrNumber((uint64_t)(l >= r));
+            case V_AstType::LTE: return IntrNumber((uint64_t)(l <= r));
+            default: {}
+        }
+    }
+    
+    uint64_t l = lval.as_int();
+    uint64_t r = rval.as_int();
+    switch (op) {
+        case V_AstType::And: return IntrNumber(l & r);
+        case V_AstType::Or:  return IntrNumber(l | r);
+        case V_AstType::Xor: return IntrNumber(l ^ r);
+        case V_AstType::Lsh: return IntrNumber(l << r);
+        case V_AstType::Rsh: return IntrNumber(l >> r);
+        default: {}
+    }
+    return IntrNumber((uint64_t)0);
+}
+
+//
+// Runs a numeric expression, integer or float
+//
+// An operator on two literals or variables is the most common case, so it is
+// done right here. Anything larger is run from its flat form.
+//
+IntrNumber AstInterpreter::run_number(const std::shared_ptr<IntrContext> &ctx, const std::shared_ptr<AstExpression> &expr) {
+    switch (expr->type) {
+        case V_AstType::Neg: {
+            auto op = static_cast<AstNegOp *>(expr.get());
+            switch (op->value->type) {
+                case V_AstType::IntL:
+                case V_AstType::FloatL:
+                case V_AstType::ID: return apply_operator(V_AstType::Neg, run_operand(ctx, op->value), IntrNumber());
+                default: {}
+            }
+            return run_flat_expression(ctx, flat_exprs.get(expr));
+        }
+        
+        case V_AstType::Add:
+        case V_AstType::Sub:
+        case V_AstType::Mul:
+        case V_AstType::Div:
+        case V_AstType::Mod:
+        case V_AstType::And:
+        case V_AstType::Or:
+        case V_AstType::Xor:
+        case V_AstType::Lsh:
+        case V_AstType::Rsh:
+        case V_AstType::EQ:
+        case V_AstType::NEQ:
+        case V_AstType::GT:
+        case V_AstType::LT:
+        case V_AstType::GTE:
+        case V_AstType::LTE: {
+            auto op = static_cast<AstBinaryOp *>(expr.get());
+            auto ltype = op->lval->type;
+            auto rtype = op->rval->type;
+            bool lleaf = ltype == V_AstType::IntL || ltype == V_AstType::FloatL || ltype == V_AstType::ID;
+            bool rleaf = rtype == V_AstType::IntL || rtype == V_AstType::FloatL || rtype == V_AstType::ID;
+            if (lleaf && rleaf) {
+                return apply_operator(expr->type, run_operand(ctx, op->lval), run_operand(ctx, op->rval));
+            }
+            return run_flat_expression(ctx, flat_exprs.get(expr));
+        }
+        
+        default: return run_operand(ctx, expr);
+    }
+}
+
+//
+// Runs anything that is not an operator as a number
+//
+IntrNumber AstInterpreter::run_operand(const std::shared_ptr<IntrContext> &ctx, const std::shared_ptr<AstExpression> &expr) {
+    switch (expr->type) {
+        case V_AstType::IntL: return IntrNumber(static_cast<AstInt *>(expr.get())->value);
+        case V_AstType::CharL: return IntrNumber((uint64_t)static_cast<AstChar *>(expr.get())->value);
+        case V_AstType::FloatL: return IntrNumber(static_cast<AstFloat *>(expr.get())->value);
+        
+        case V_AstType::ID: {
+            auto &slot = ctx->var(static_cast<AstID *>(expr.get())->value);
+            if (slot.kind == IntrKind::Float) return IntrNumber(slot.fvalue);
+            return IntrNumber((uint64_t)slot.ivalue);
+        }
+        
+        default: {}
+    }
+    
+    // Array elements, calls, and anything else
+    if (is_float_expr(ctx, expr)) {
+        run_fexpression(ctx, expr);
+        double value = ctx->fstack.top();
+        ctx->fstack.pop();
+        return IntrNumber(value);
+    }
+    
+    run_iexpression(ctx, expr);
+    if (ctx->istack.empty()) return IntrNumber((uint64_t)0);
+    uint64_t value = ctx->istack.top();
+    ctx->istack.pop();
+    return IntrNumber(value);
+}
+
+//
+// Runs a numeric operator expression from its flat form
+//
+// Each node leaves its result in the slot of the same number, so the operands
+// are always ready by the time their operator is reached. Nodes that were not
+// flattened are run as operands.
+//
+IntrNumber AstInterpreter::run_flat_expression(const std::shared_ptr<IntrContext> &ctx, const FlatExpr &flat) {
+    IntrNumber small[16];
+    std::vector<IntrNumber> large;
+    IntrNumber *values = small;
+    if (flat.size() > 16) {
+        large.resize(flat.size());
+        values = large.data();
+    }
+    
+    for (uint32_t i = 0; i<flat.size(); i++) {
+        switch (flat.ops[i]) {
+            case V_AstType::IntL: values[i] = IntrNumber(flat.values[i]); break;
+            case V_AstType::CharL: values[i] = IntrNumber(flat.values[i]); break;
+            case V_AstType::FloatL: values[i] = IntrNumber(flat.float_value(i)); break;
+            
+            case V_AstType::ID: {
+                auto &slot = ctx->var(flat.symbol(i));
+                if (slot.kind == IntrKind::Float) values[i] = IntrNumber(slot.fvalue);
+                else values[i] = IntrNumber((uint64_t)slot.ivalue);
+            } break;
+            
+            case V_AstType::Neg: values[i] = apply_operator(V_AstType::Neg, values[flat.lhs[i]], IntrNumber()); break;
+            case V_AstType::Add:
+            case V_AstType::Sub:
+            case V_AstType::Mul:
+            case V_AstType::Div:
+            case V_AstType::Mod:
+            case V_AstType::And:
+            case V_AstType::Or:
+            case V_AstType::Xor:
+            case V_AstType::Lsh:
+            case V_AstType::Rsh:
+            case V_AstType::EQ:
+            case V_AstType::NEQ:
+            case V_AstType::GT:
+            case V_AstType::LT:
+            case V_AstType::GTE:
+            case V_AstType::LTE: {
+                values[i] = apply_operator(flat.ops[i], values[flat.lhs[i]], values[flat.rhs[i]]);
+            } break;
+            
+            default: {
+                values[i] = IntrNumber((uint64_t)0);
+                if (flat.node(i) == nullptr) break;
+                values[i] = run_operand(ctx, flat.node(i));
+            }
+        }
+    }
+    
+    return values[flat.root()];
+}
+
 // Runs a floating point expression
 void AstInterpreter::run_fexpression(std::shared_ptr<IntrContext> ctx, std::shared_ptr<AstExpression> expr) {
-
+    switch (expr->type) {
+        // Variables
+        case V_AstType::ID: {
+            auto id = std::static_pointer_cast<AstID>(expr);
+            auto &slot = ctx->var(id->value);
+            if (slot.kind == IntrKind::FloatArray) {
+                ctx->sstack.push(id->value.str());
+            } else if (slot.kind == IntrKind::Float) {
+                ctx->fstack.push(slot.fvalue);
+            } else {
+                ctx->fstack.push((double)slot.ivalue);
+            }
+        } break;
+        
+        case V_AstType::ArrayAccess: {
+            auto acc = std::static_pointer_cast<AstArrayAccess>(expr);
+            run_iexpression(ctx, acc->index);
+            int idx = ctx->istack.top();
+            ctx->istack.pop();
+            
+            auto &slot = ctx->var(acc->value);
+            if (slot.kind == IntrKind::FloatArray) {
+                ctx->fstack.push(slot.farray[idx]);
+            } else {
+                ctx->fstack.push((double)(int64_t)slot.iarray[idx]);
+            }
+        } break;
+        
+        // Function call expression
+        case V_AstType::FuncCallExpr: {
+            auto fc = std::static_pointer_cast<AstFuncCallExpr>(expr);
+            if (fc->name == "malloc" || fc->name == "gc_alloc") {
+                auto args = std::static_pointer_cast<AstExprList>(fc->args);
+                auto mul = std::static_pointer_cast<AstMulOp>(args->list[0]);
+                run_iexpression(ctx, mul->rval);
+                int length = ctx->istack.top();
+                ctx->fstack_array = IntrBuffer<double>(std::max(length, 0), 0.0);
+                ctx->istack.pop();
+            } else {
+                auto func = function_map[fc->name];
+                if (func && func->data_type->type == V_AstType::Ptr) {
+                    auto array = call_function(ctx, fc->name, std::static_pointer_cast<AstExprList>(fc->args));
+                    ctx->fstack_array = std::move(*std::get_if<IntrBuffer<double>>(&array));
+                } else {
+                    auto value = call_function(ctx, fc->name, std::static_pointer_cast<AstExprList>(fc->args));
+                    if (auto f = std::get_if<double>(&value)) ctx->fstack.push(*f);
+                    else ctx->fstack.push((double)(int64_t)*std::get_if<uint64_t>(&value));
+                }
+            }
+        } break;
+        
+        // Assign operator
+        case V_AstType::Assign: {
+            auto op = std::static_pointer_cast<AstAssignOp>(expr);
+            
+            // Numbers go straight into scalar variables
+            if (op->lval->type == V_AstType::ID && is_number_node(op->rval->type)) {
+                auto &slot = ctx->var(std::static_pointer_cast<AstID>(op->lval)->value);
+                if (slot.kind == IntrKind::Float) {
+                    slot.fvalue = store_float(slot.data_type, run_number(ctx, op->rval).as_float());
+                    break;
+                }
+            }
+            
+            run_fexpression(ctx, op->rval);
+            
+            switch (op->lval->type) {
+                // Simple variables
+                case V_AstType::ID: {
+                    auto id = std::static_pointer_cast<AstID>(op->lval);
+                    auto &slot = ctx->var(id->value);
+                    if (slot.kind == IntrKind::FloatArray) {
+                        slot.farray = std::move(ctx->fstack_array);
+                    } else {
+                        slot.fvalue = store_float(slot.data_type, ctx->fstack.top());
+                        ctx->fstack.pop();
+                    }
+                } break;
+                
+                // Array access
+                case V_AstType::ArrayAccess: {
+                    auto acc = std::static_pointer_cast<AstArrayAccess>(op->lval);
+                    double value = ctx->fstack.top();
+                    ctx->fstack.pop();
+                    
+                    run_iexpression(ctx, acc->index);
+                    int idx = ctx->istack.top();
+                    ctx->istack.pop();
+                    
+                    auto &slot = ctx->var(acc->value);
+                    slot.farray.write(idx) = store_float(slot.data_type, value);
+                } break;
+                
+                // Unknown lval
+                default: {}
+            }
+        } break;
+        
+        // Literals and operators
+        default: {
+            ctx->fstack.push(run_number(ctx, expr).as_float());
+        }
+    }
 }
 
 // Runs a string expression
@@ -167,7 +488,7 @@ void AstInterpreter::run_sexpression(std::shared_ptr<IntrContext> ctx, std::shar
         
         case V_AstType::CharL: {
             auto c = std::static_pointer_cast<AstChar>(expr);
-            ctx->sstack.push(std::string(1, c->value));
+            ctx->sstack.push(std::string_view(&c->value, 1));
         } break;
         
         case V_AstType::StringL: {
@@ -178,10 +499,11 @@ void AstInterpreter::run_sexpression(std::shared_ptr<IntrContext> ctx, std::shar
         // Variables
         case V_AstType::ID: {
             auto id = std::static_pointer_cast<AstID>(expr);
-            if (is_string_array(ctx, id->value)) {
-                ctx->sstack.push(id->value);
+            auto &slot = ctx->var(id->value);
+            if (slot.kind == IntrKind::StringArray) {
+                ctx->sstack.push(id->value.str());
             } else {
-                ctx->sstack.push(ctx->svar_map[id->value]);
+                ctx->sstack.push(slot.svalue);
             }
         } break;
         
@@ -191,11 +513,13 @@ void AstInterpreter::run_sexpression(std::shared_ptr<IntrContext> ctx, std::shar
             int idx = ctx->istack.top();
             ctx->istack.pop();
             
-            if (ctx->type_map[acc->value]->type == V_AstType::String) {
-                char c = ctx->svar_map[acc->value][idx];
-                ctx->sstack.push(std::string(1, c));
+            // The type of an array is its element type, so arrays go first
+            auto &slot = ctx->var(acc->value);
+            if (slot.kind == IntrKind::StringArray) {
+                ctx->sstack.push(slot.sarray[idx]);
             } else {
-                ctx->sstack.push(ctx->sarray_map[acc->value][idx]);
+                char c = slot.svalue[idx];
+                ctx->sstack.push(std::string_view(&c, 1));
             }
         } break;
         
@@ -207,19 +531,16 @@ void AstInterpreter::run_sexpression(std::shared_ptr<IntrContext> ctx, std::shar
                 auto mul = std::static_pointer_cast<AstMulOp>(args->list[0]);
                 run_iexpression(ctx, mul->rval);
                 int length = ctx->istack.top();
-                ctx->sstack_array = std::vector<std::string>();
-                for (int i = 0; i<length; i++) {
-                    ctx->sstack_array.push_back("");
-                }
+                ctx->sstack_array = IntrBuffer<IntrString>(std::max(length, 0));
                 ctx->istack.pop();
             } else {
                 auto func = function_map[fc->name];
                 if (func && func->data_type->type == V_AstType::Ptr) {
                     auto array = call_function(ctx, fc->name, std::static_pointer_cast<AstExprList>(fc->args));
-                    ctx->sstack_array = *std::get_if<std::vector<std::string>>(&array);
+                    ctx->sstack_array = std::move(*std::get_if<IntrBuffer<IntrString>>(&array));
                 } else {
                     auto value = call_function(ctx, fc->name, std::static_pointer_cast<AstExprList>(fc->args));
-                    ctx->sstack.push(*std::get_if<std::string>(&value));
+                    ctx->sstack.push(std::move(*std::get_if<IntrString>(&value)));
                 }
             }
         } break;
@@ -233,11 +554,11 @@ void AstInterpreter::run_sexpression(std::shared_ptr<IntrContext> ctx, std::shar
                 // Simple variables
                 case V_AstType::ID: {
                     auto id = std::static_pointer_cast<AstID>(op->lval);
-                    if (is_string_array(ctx, id->value)) {
-                        ctx->sarray_map[id->value] = ctx->sstack_array;
-                        ctx->sstack_array.clear();
+                    auto &slot = ctx->var(id->value);
+                    if (slot.kind == IntrKind::StringArray) {
+                        slot.sarray = std::move(ctx->sstack_array);
                     } else {
-                        ctx->svar_map[id->value] = ctx->sstack.top();
+                        slot.svalue = std::move(ctx->sstack.top());
                         ctx->sstack.pop();
                     }
                 } break;
@@ -245,14 +566,14 @@ void AstInterpreter::run_sexpression(std::shared_ptr<IntrContext> ctx, std::shar
                 // Array access
                 case V_AstType::ArrayAccess: {
                     auto acc = std::static_pointer_cast<AstArrayAccess>(op->lval);
-                    std::string value = ctx->sstack.top();
+                    IntrString value = std::move(ctx->sstack.top());
                     ctx->sstack.pop();
                     
                     run_iexpression(ctx, acc->index);
                     int idx = ctx->istack.top();
                     ctx->istack.pop();
                     
-                    ctx->sarray_map[acc->value][idx] = value;
+                    ctx->var(acc->value).sarray.write(idx) = std::move(value);
                 } break;
                 
                 // Unknown lval
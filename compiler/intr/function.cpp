@@ -1,4 +1,5 @@
 #include <iostream>
+#include <cstdio>
 
 #include <ast/ast.hpp>
 #include <ast/ast_builder.hpp>
@@ -8,36 +9,74 @@
 //
 // For running functions
 //
-vm_arg_list AstInterpreter::run_function(std::shared_ptr<AstFunction> func, std::vector<vm_arg_list> args) {   
-    auto ctx = std::make_shared<IntrContext>();
+// The profiler is checked once per call, so a call without one does not
+// set up a profile scope.
+//
+vm_arg_list AstInterpreter::run_function(std::shared_ptr<AstFunction> func, std::vector<vm_arg_list> args) {
+    if (profiler) {
+        IntrProfileScope timed(profiler.get(), func.get());
+        return enter_function(func, std::move(args));
+    }
+    
+    return enter_function(func, std::move(args));
+}
+
+vm_arg_list AstInterpreter::enter_function(std::shared_ptr<AstFunction> func, std::vector<vm_arg_list> args) {
+    // Hot functions go to the tier
+    FuncProfile *profile = nullptr;
+    if (tier) {
+        profile = &profiles[func.get()];
+        if (profile->native) return tier->call(func, args);
+        
+        ++profile->calls;
+        if (!profile->rejected && profile->calls + profile->back_edges >= tier_threshold) {
+            if (tier->compile(func)) {
+                profile->native = true;
+                return tier->call(func, args);
+            }
+            profile->rejected = true;
+        }
+    }
+    
+    auto ctx = push_frame(layout_of(func));
     ctx->func_type = func->data_type;
+    ctx->profile = profile;
     
-    // Merge arguments into the symbol table
+    // Move the arguments into their slots
     for (int i = 0; i<func->args.size(); i++) {
-        auto arg = func->args[i];
+        auto const &arg = func->args[i];
+        auto &slot = ctx->var(arg.name);
+        
         // Arrays
         if (arg.type->type == V_AstType::Ptr) {
             auto ptr = std::static_pointer_cast<AstPointerType>(arg.type);
-            ctx->type_map[arg.name] = ptr->base_type;
+            slot.data_type = ptr->base_type;
             
             if (is_int_type(ptr->base_type)) {
-                ctx->iarray_map[arg.name] = *std::get_if<std::vector<uint64_t>>(&args[i]);
+                slot.kind = IntrKind::IntArray;
+                slot.iarray = std::move(*std::get_if<IntrBuffer<uint64_t>>(&args[i]));
             } else if (is_float_type(ptr->base_type)) {
-            
+                slot.kind = IntrKind::FloatArray;
+                slot.farray = std::move(*std::get_if<IntrBuffer<double>>(&args[i]));
             } else if (is_string_type(ptr->base_type)) {
-                ctx->sarray_map[arg.name] = *std::get_if<std::vector<std::string>>(&args[i]);
+                slot.kind = IntrKind::StringArray;
+                slot.sarray = std::move(*std::get_if<IntrBuffer<IntrString>>(&args[i]));
             }
             
         // Scalar variables
         } else {
-            ctx->type_map[arg.name] = arg.type;
+            slot.data_type = arg.type;
             
             if (is_int_type(arg.type)) {
-                ctx->ivar_map[arg.name] = *std::get_if<uint64_t>(&args[i]);
+                slot.kind = IntrKind::Int;
+                slot.ivalue = *std::get_if<uint64_t>(&args[i]);
             } else if (is_float_type(arg.type)) {
-            
+                slot.kind = IntrKind::Float;
+                slot.fvalue = *std::get_if<double>(&args[i]);
+                if (arg.type->type == V_AstType::Float32) slot.fvalue = (float)slot.fvalue;
             } else if (is_string_type(arg.type)) {
-                ctx->svar_map[arg.name] = *std::get_if<std::string>(&args[i]);
+                slot.kind = IntrKind::String;
+                slot.svalue = std::move(*std::get_if<IntrString>(&args[i]));
             }
         }
     }
@@ -45,45 +84,156 @@ vm_arg_list AstInterpreter::run_function(std::shared_ptr<AstFunction> func, std:
     // Run the block
     run_block(ctx, func->block);
     
-    // At the end, check the stack
+    // At the end, check the stack. The frame is about to be reused, so the
+    // result is moved out of it.
+    vm_arg_list result = (uint64_t)0;
     if (is_int_type(func->data_type)) {
         if (func->data_type->type == V_AstType::Ptr) {
-            std::string name = ctx->sstack.top();
-            return ctx->iarray_map[name];
+            result = std::move(ctx->var(Symbol::find(ctx->sstack.top().view())).iarray);
+        } else if (!ctx->istack.empty()) {
+            result = ctx->istack.top();
         }
-        if (ctx->istack.empty()) return (uint64_t)0;
-        return ctx->istack.top();
     } else if (is_float_type(func->data_type)) {
-    
+        if (func->data_type->type == V_AstType::Ptr) {
+            result = std::move(ctx->var(Symbol::find(ctx->sstack.top().view())).farray);
+        } else if (!ctx->fstack.empty()) {
+            double value = ctx->fstack.top();
+            if (func->data_type->type == V_AstType::Float32) value = (float)value;
+            result = value;
+        } else {
+            result = 0.0;
+        }
     } else if (is_string_type(func->data_type)) {
-        std::string value = "";
         if (func->data_type->type == V_AstType::Ptr) {
-            std::string name = ctx->sstack.top();
-            return ctx->sarray_map[name];
+            result = std::move(ctx->var(Symbol::find(ctx->sstack.top().view())).sarray);
+        } else if (!ctx->sstack.empty()) {
+            result = std::move(ctx->sstack.top());
+        } else {
+            result = IntrString();
         }
-        if (!ctx->sstack.empty()) {
-            value = ctx->sstack.top();
+    }
+    
+    pop_frame();
+    return result;
+}
+
+//
+// The frame stack
+//
+// A frame is only freed when the interpreter is. A call takes the frame
+// above its caller's, and clears what the last call at that depth left in
+// it, so the slots and stacks keep the memory they have grown.
+//
+std::shared_ptr<IntrContext> AstInterpreter::push_frame(const IntrLayout &layout) {
+    if (frame_depth == frames.size()) frames.push_back(std::make_shared<IntrContext>());
+    auto ctx = frames[frame_depth++];
+    
+    ctx->layout = &layout;
+    if (ctx->frame.size() < layout.size) ctx->frame.resize(layout.size);
+    for (uint32_t i = 0; i<layout.size; i++) {
+        auto &slot = ctx->frame[i];
+        slot.kind = IntrKind::None;
+        slot.data_type = nullptr;
+        slot.ivalue = 0;
+        slot.fvalue = 0;
+        slot.svalue.clear();
+        slot.iarray.clear();
+        slot.farray.clear();
+        slot.sarray.clear();
+    }
+    
+    while (!ctx->istack.empty()) ctx->istack.pop();
+    while (!ctx->fstack.empty()) ctx->fstack.pop();
+    while (!ctx->sstack.empty()) ctx->sstack.pop();
+    ctx->istack_array.clear();
+    ctx->fstack_array.clear();
+    ctx->sstack_array.clear();
+    return ctx;
+}
+
+void AstInterpreter::pop_frame() {
+    --frame_depth;
+}
+
+//
+// Gives each argument and local variable of a function a slot in its frame
+//
+// The slots are numbered by name, in the order the names are first seen.
+// Declarations in nested blocks share the function's frame, like they
+// shared its symbol table.
+//
+void IntrLayout::add(Symbol name) {
+    if (name.id == 0 || slot(name) != 0) return;
+    
+    // Keep the table at most half full
+    if (size * 2 > entries.size()) {
+        auto old = std::move(entries);
+        entries = std::vector<Entry>(old.empty() ? 8 : old.size() * 2);
+        mask = entries.size() - 1;
+        for (auto const &entry : old) {
+            if (entry.id != 0) insert(entry);
         }
-        return value;
     }
     
-    return (uint64_t)0;
+    insert({ name.id, size++ });
 }
 
-vm_arg_list AstInterpreter::call_function(std::shared_ptr<IntrContext> ctx, std::string name, std::shared_ptr<AstExprList> args) {
+void IntrLayout::insert(Entry entry) {
+    uint32_t i = hash(entry.id);
+    while (entries[i].id != 0) i = (i + 1) & mask;
+    entries[i] = entry;
+}
+
+static void add_block_slots(IntrLayout &layout, std::shared_ptr<AstBlock> block) {
+    if (!block) return;
+    
+    for (auto const &stmt : block->block) {
+        switch (stmt->type) {
+            case V_AstType::VarDec: {
+                auto vd = std::static_pointer_cast<AstVarDec>(stmt);
+                layout.add(vd->name);
+            } break;
+            
+            case V_AstType::If: {
+                auto cond = std::static_pointer_cast<AstIfStmt>(stmt);
+                add_block_slots(layout, cond->true_block);
+                add_block_slots(layout, cond->false_block);
+            } break;
+            
+            case V_AstType::While: {
+                auto loop = std::static_pointer_cast<AstWhileStmt>(stmt);
+                add_block_slots(layout, loop->block);
+            } break;
+            
+            default: {}
+        }
+    }
+}
+
+const IntrLayout &AstInterpreter::layout_of(std::shared_ptr<AstFunction> func) {
+    auto found = layouts.find(func.get());
+    if (found != layouts.end()) return found->second;
+    
+    IntrLayout &layout = layouts[func.get()];
+    for (auto const &arg : func->args) layout.add(arg.name);
+    add_block_slots(layout, func->block);
+    return layout;
+}
+
+vm_arg_list AstInterpreter::call_function(std::shared_ptr<IntrContext> ctx, Symbol name, std::shared_ptr<AstExprList> args) {
     // Handle the "length" call for arrays and strings
     if (name == "length") {
         auto arg1 = args->list[0];
         if (arg1->type == V_AstType::ID) {
             auto id = std::static_pointer_cast<AstID>(arg1);
             if (is_int_array(ctx, id->value)) {
-                return (uint64_t)ctx->iarray_map[id->value].size();
+                return (uint64_t)ctx->var(id->value).iarray.size();
             } else if (is_float_array(ctx, id->value)) {
-            
+                return (uint64_t)ctx->var(id->value).farray.size();
             } else if (is_string_array(ctx, id->value)) {
-                return (uint64_t)ctx->sarray_map[id->value].size();
-            } else if (ctx->type_map[id->value]->type == V_AstType::String) {
-                return (uint64_t)ctx->svar_map[id->value].length();
+                return (uint64_t)ctx->var(id->value).sarray.size();
+            } else if (ctx->var(id->value).data_type->type == V_AstType::String) {
+                return (uint64_t)ctx->var(id->value).svalue.length();
             }
         } else if (arg1->type == V_AstType::StringL) {
             auto s = std::static_pointer_cast<AstString>(arg1);
@@ -94,6 +244,7 @@ vm_arg_list AstInterpreter::call_function(std::shared_ptr<IntrContext> ctx, std:
     // Otherwise, pull from the table
     auto func = function_map[name];
     std::vector<vm_arg_list> addrs;
+    addrs.reserve(args->list.size());
     
     // TODO: Check type
     for (int i = 0; i<args->list.size(); i++) {
@@ -105,11 +256,11 @@ vm_arg_list AstInterpreter::call_function(std::shared_ptr<IntrContext> ctx, std:
             auto base_type = std::static_pointer_cast<AstPointerType>(data_type)->base_type;
             auto id = std::static_pointer_cast<AstID>(arg);
             if (is_int_type(base_type)) {
-                addrs.push_back(ctx->iarray_map[id->value]);
+                addrs.push_back(ctx->var(id->value).iarray);
             } else if (is_float_type(base_type)) {
-            
+                addrs.push_back(ctx->var(id->value).farray);
             } else if (is_string_type(base_type)) {
-                addrs.push_back(ctx->sarray_map[id->value]);
+                addrs.push_back(ctx->var(id->value).sarray);
             }
             
         // Everything else
@@ -120,18 +271,19 @@ vm_arg_list AstInterpreter::call_function(std::shared_ptr<IntrContext> ctx, std:
                 ctx->istack.pop();
                 addrs.push_back(value);
             } else if (is_float_type(data_type)) {
-            
+                run_fexpression(ctx, arg);
+                addrs.push_back(ctx->fstack.top());
+                ctx->fstack.pop();
             } else if (is_string_type(data_type)) {
                 run_sexpression(ctx, arg);
-                std::string value = ctx->sstack.top();
+                addrs.push_back(std::move(ctx->sstack.top()));
                 ctx->sstack.pop();
-                addrs.push_back(value);
             }
         }
     }
     
     // Run it
-    return run_function(func, addrs);
+    return run_function(func, std::move(addrs));
 }
 
 //
@@ -158,16 +310,23 @@ void AstInterpreter::run_print(std::shared_ptr<IntrContext> ctx, std::shared_ptr
                 std::cout << i->value;
             } break;
             
+            // Print a float literal
+            case V_AstType::FloatL: {
+                auto f = std::static_pointer_cast<AstFloat>(arg);
+                print_float(f->value);
+            } break;
+            
             // Identifier
             // TODO: Eventually clean this up
             case V_AstType::ID: {
                 auto id = std::static_pointer_cast<AstID>(arg);
-                auto data_type = ctx->type_map[id->value];
+                auto &slot = ctx->var(id->value);
+                auto data_type = slot.data_type;
                 
                 // Integers
                 if (is_int_type(data_type)) {
-                    if (is_int_array(ctx, id->value)) {
-                        auto array = ctx->iarray_map[id->value];
+                    if (slot.kind == IntrKind::IntArray) {
+                        auto &array = slot.iarray;
                         std::cout << "[";
                         for (int i = 0; i<array.size(); i++) {
                             std::cout << array[i];
@@ -175,16 +334,27 @@ void AstInterpreter::run_print(std::shared_ptr<IntrContext> ctx, std::shared_ptr
                         }
                         std::cout << "]";
                     } else {
-                        std::cout << ctx->ivar_map[id->value];
+                        std::cout << slot.ivalue;
                     }
                 
-                // Floatss
+                // Floats
                 } else if (is_float_type(data_type)) {
+                    if (slot.kind == IntrKind::FloatArray) {
+                        auto &array = slot.farray;
+                        std::cout << "[";
+                        for (int i = 0; i<array.size(); i++) {
+                            print_float(array[i]);
+                            if (i+1 < array.size()) std::cout << ", ";
+                        }
+                        std::cout << "]";
+                    } else {
+                        print_float(slot.fvalue);
+                    }
                 
                 // Strings
                 } else if (is_string_type(data_type)) {
-                    if (is_string_array(ctx, id->value)) {
-                        auto array = ctx->sarray_map[id->value];
+                    if (slot.kind == IntrKind::StringArray) {
+                        auto &array = slot.sarray;
                         std::cout << "[";
                         for (int i = 0; i<array.size(); i++) {
                             std::cout << "\"" << array[i] << "\"";
@@ -192,7 +362,7 @@ void AstInterpreter::run_print(std::shared_ptr<IntrContext> ctx, std::shared_ptr
                         }
                         std::cout << "]";
                     } else {
-                        std::cout << ctx->svar_map[id->value];
+                        std::cout << slot.svalue;
                     }
                 }
             } break;
@@ -204,14 +374,15 @@ void AstInterpreter::run_print(std::shared_ptr<IntrContext> ctx, std::shared_ptr
                 int idx = ctx->istack.top();
                 ctx->istack.pop();
                 
-                if (is_int_array(ctx, acc->value)) {
-                    std::cout << ctx->iarray_map[acc->value][idx];
-                } else if (is_float_array(ctx, acc->value)) {
-                
-                } else if (is_string_array(ctx, acc->value)) {
-                    std::cout << ctx->sarray_map[acc->value][idx];
-                } else if (ctx->type_map[acc->value]->type == V_AstType::String) {
-                    std::cout << ctx->svar_map[acc->value][idx];
+                auto &slot = ctx->var(acc->value);
+                if (slot.kind == IntrKind::IntArray) {
+                    std::cout << slot.iarray[idx];
+                } else if (slot.kind == IntrKind::FloatArray) {
+                    print_float(slot.farray[idx]);
+                } else if (slot.kind == IntrKind::StringArray) {
+                    std::cout << slot.sarray[idx];
+                } else if (slot.data_type->type == V_AstType::String) {
+                    std::cout << slot.svalue[idx];
                 }
             } break;
             
@@ -231,9 +402,9 @@ void AstInterpreter::run_print(std::shared_ptr<IntrContext> ctx, std::shared_ptr
                     if (is_int_type(func_type)) {
                         std::cout << *std::get_if<uint64_t>(&value);
                     } else if (is_float_type(func_type)) {
-                    
+                        print_float(*std::get_if<double>(&value));
                     } else if (is_string_type(func_type)) {
-                        std::cout << *std::get_if<std::string>(&value);
+                        std::cout << *std::get_if<IntrString>(&value);
                     }
                 }
             } break;
@@ -266,6 +437,9 @@ void AstInterpreter::run_print(std::shared_ptr<IntrContext> ctx, std::shared_ptr
                 if (data_type->type == V_AstType::Int32) {
                     std::cout << ctx->istack.top();
                     ctx->istack.pop();
+                } else if (is_float_type(data_type)) {
+                    print_float(ctx->fstack.top());
+                    ctx->fstack.pop();
                 }
                 // TODO: Other types here
             } break;
@@ -280,3 +454,11 @@ void AstInterpreter::run_print(std::shared_ptr<IntrContext> ctx, std::shared_ptr
     std::cout << std::endl;
 }
 
+//
+// Floats print with six decimal places, like %f
+//
+void AstInterpreter::print_float(double value) {
+    char buffer[512];
+    snprintf(buffer, sizeof(buffer), "%f", value);
+    std::cout << buffer;
+}
@@ -12,6 +12,21 @@ AstInterpreter::AstInterpreter(std::shared_ptr<AstTree> tree) {
     this->tree = tree;
 }
 
+//
+// Sends functions to the tier once they are hot
+//
+void AstInterpreter::set_tier(std::shared_ptr<NativeTier> tier, uint64_t threshold) {
+    this->tier = tier;
+    this->tier_threshold = threshold;
+}
+
+//
+// Records where the program spends its time
+//
+void AstInterpreter::set_profiler(std::shared_ptr<IntrProfiler> profiler) {
+    this->profiler = profiler;
+}
+
 //
 // The entry point of the interpreter
 //
@@ -27,56 +42,69 @@ int AstInterpreter::run() {
     }
     
     // Verify we have the main function
-    if (function_map.find("main") == function_map.end()) {
+    auto main = function_map.find(Symbol::find("main"));
+    if (main == function_map.end()) {
         std::cout << "[FATAL] Unable to find main function." << std::endl;
         return 1;
     }
     
-    auto val = run_function(function_map["main"], std::vector<vm_arg_list>());
+    auto val = run_function(main->second, std::vector<vm_arg_list>());
     return *std::get_if<uint64_t>(&val);
 }
 
 //
 // Runs a block of statements
 //
+// The profiler is checked once per block, so the loop without one is
+// left as it was.
+//
 void AstInterpreter::run_block(std::shared_ptr<IntrContext> ctx, std::shared_ptr<AstBlock> block) {
     // TODO: Create symbol table within the context
     
-    // Run the block
-    for (auto const &stmt : block->block) {
-        switch (stmt->type) {
-            // Expression statements
-            case V_AstType::ExprStmt: {
-                auto stmt2 = std::static_pointer_cast<AstExprStatement>(stmt);
-                run_expression(ctx, stmt2->expression, stmt2->dataType);
-            } break;
+    if (profiler) {
+        for (auto const &stmt : block->block) {
+            profiler->hit(stmt.get());
+            run_statement(ctx, stmt);
+        }
+        return;
+    }
+    
+    for (auto const &stmt : block->block) run_statement(ctx, stmt);
+}
+
+void AstInterpreter::run_statement(const std::shared_ptr<IntrContext> &ctx, const std::shared_ptr<AstStatement> &stmt) {
+    switch (stmt->type) {
+        // Expression statements
+        case V_AstType::ExprStmt: {
+            auto stmt2 = std::static_pointer_cast<AstExprStatement>(stmt);
+            run_expression(ctx, stmt2->expression, stmt2->dataType);
+        } break;
+    
+        // Variable and array declarations
+        case V_AstType::VarDec: run_var_decl(ctx, stmt); break;
+    
+        // Return statements
+        case V_AstType::Return: {
+            if (!stmt->hasExpression()) break;
+            run_expression(ctx, stmt->expression, ctx->func_type);
+        } break;
         
-            // Variable and array declarations
-            case V_AstType::VarDec: run_var_decl(ctx, stmt); break;
+        // Function calls
+        case V_AstType::FuncCallStmt: {
+            auto fc = std::static_pointer_cast<AstFuncCallStmt>(stmt);
+            if (fc->name == "print") {
+                run_print(ctx, std::static_pointer_cast<AstExprList>(fc->expression));
+            } else {
+                auto args = std::static_pointer_cast<AstExprList>(fc->expression);
+                call_function(ctx, fc->name, args);
+            }
+        } break;
         
-            // Return statements
-            case V_AstType::Return: {
-                if (!stmt->hasExpression()) break;
-                run_expression(ctx, stmt->expression, ctx->func_type);
-            } break;
-            
-            // Function calls
-            case V_AstType::FuncCallStmt: {
-                auto fc = std::static_pointer_cast<AstFuncCallStmt>(stmt);
-                if (fc->name == "print") {
-                    run_print(ctx, std::static_pointer_cast<AstExprList>(fc->expression));
-                } else {
-                    auto args = std::static_pointer_cast<AstExprList>(fc->expression);
-                    call_function(ctx, fc->name, args);
-                }
-            } break;
-            
-            // Flow control statements
-            case V_AstType::If: run_cond(ctx, stmt); break;
-            case V_AstType::While: run_while(ctx, stmt); break;
-            
-            default: {}
-        }
+        // Flow control statements
+        case V_AstType::If: run_cond(ctx, stmt); break;
+        case V_AstType::While: run_while(ctx, stmt); break;
+        
+        default: {}
     }
 }
 
@@ -85,28 +113,37 @@ void AstInterpreter::run_block(std::shared_ptr<IntrContext> ctx, std::shared_ptr
 //
 void AstInterpreter::run_var_decl(std::shared_ptr<IntrContext> ctx, std::shared_ptr<AstStatement> stmt) {
     auto vd = std::static_pointer_cast<AstVarDec>(stmt);
+    auto &slot = ctx->var(vd->name);
     
     // Arrays need slightly different treatment
     if (vd->data_type->type == V_AstType::Ptr) {
         auto ptr_type = std::static_pointer_cast<AstPointerType>(vd->data_type);
-        ctx->type_map[vd->name] = ptr_type->base_type;
+        slot.data_type = ptr_type->base_type;
+        slot.kind = IntrKind::None;
         if (is_int_type(ptr_type->base_type)) {
-            ctx->iarray_map[vd->name] = std::vector<uint64_t>();
+            slot.kind = IntrKind::IntArray;
+            slot.iarray.clear();
         } else if (is_float_type(ptr_type->base_type)) {
-        
+            slot.kind = IntrKind::FloatArray;
+            slot.farray.clear();
         } else if (is_string_type(ptr_type->base_type)) {
-            ctx->sarray_map[vd->name] = std::vector<std::string>();
+            slot.kind = IntrKind::StringArray;
+            slot.sarray.clear();
         }
         
-    // Regular scalar variables go right into the normal variable tables
+    // Regular scalar variables go right into their slot
     } else {
-        ctx->type_map[vd->name] = vd->data_type;
+        slot.data_type = vd->data_type;
+        slot.kind = IntrKind::None;
         if (is_int_type(vd->data_type)) {
-            ctx->ivar_map[vd->name] = 0;
+            slot.kind = IntrKind::Int;
+            slot.ivalue = 0;
         } else if (is_float_type(vd->data_type)) {
-        
+            slot.kind = IntrKind::Float;
+            slot.fvalue = 0;
         } else if (is_string_type(vd->data_type)) {
-            ctx->svar_map[vd->name] = "";
+            slot.kind = IntrKind::String;
+            slot.svalue.clear();
         }
     }
 }
@@ -117,9 +154,7 @@ void AstInterpreter::run_var_decl(std::shared_ptr<IntrContext> ctx, std::shared_
 void AstInterpreter::run_cond(std::shared_ptr<IntrContext> ctx, std::shared_ptr<AstStatement> stmt) {
     auto cond = std::static_pointer_cast<AstIfStmt>(stmt);
     
-    run_iexpression(ctx, cond->expression);
-    bool result = (bool)ctx->istack.top();
-    ctx->istack.pop();
+    bool result = (bool)run_number(ctx, cond->expression).as_int();
     
     if (result) run_block(ctx, cond->true_block);
     else run_block(ctx, cond->false_block);
@@ -128,15 +163,30 @@ void AstInterpreter::run_cond(std::shared_ptr<IntrContext> ctx, std::shared_ptr<
 //
 // Runs a while loop
 //
+// As in run_block, iterations are only counted when there is a profiler.
+//
 void AstInterpreter::run_while(std::shared_ptr<IntrContext> ctx, std::shared_ptr<AstStatement> stmt) {
     auto loop = std::static_pointer_cast<AstWhileStmt>(stmt);
     
+    if (profiler) {
+        uint64_t count = 0;
+        while (true) {
+            bool result = (bool)run_number(ctx, loop->expression).as_int();
+            if (result == false) break;
+            run_block(ctx, loop->block);
+            ++count;
+            if (ctx->profile) ++ctx->profile->back_edges;
+        }
+        
+        profiler->iterations(stmt.get(), count);
+        return;
+    }
+    
     while (true) {
-        run_iexpression(ctx, loop->expression);
-        bool result = (bool)ctx->istack.top();
-        ctx->istack.pop();
+        bool result = (bool)run_number(ctx, loop->expression).as_int();
         if (result == false) break;
         run_block(ctx, loop->block);
+        if (ctx->profile) ++ctx->profile->back_edges;
     }
 }
 
@@ -150,10 +200,11 @@ void AstInterpreter::run_while(std::shared_ptr<IntrContext> ctx, std::shared_ptr
 std::shared_ptr<AstDataType> AstInterpreter::interpret_type(std::shared_ptr<IntrContext> ctx, std::shared_ptr<AstExpression> expr) {
     switch (expr->type) {
         case V_AstType::IntL: return AstBuilder::buildInt32Type();
+        case V_AstType::FloatL: return AstBuilder::buildFloat64Type();
         
         case V_AstType::ID: {
             auto id = std::static_pointer_cast<AstID>(expr);
-            return ctx->type_map[id->value];
+            return ctx->var(id->value).data_type;
         }
         
         case V_AstType::Add:
@@ -173,6 +224,8 @@ std::shared_ptr<AstDataType> AstInterpreter::interpret_type(std::shared_ptr<Intr
         case V_AstType::GTE:
         case V_AstType::LTE:
         {
+            if (is_float_expr(ctx, expr)) return AstBuilder::buildFloat64Type();
+            
             auto op = std::static_pointer_cast<AstBinaryOp>(expr);
             auto d_type = interpret_type(ctx, op->lval);
             if (d_type) return d_type;
@@ -244,17 +297,59 @@ bool AstInterpreter::is_string_type(std::shared_ptr<AstDataType> data_type) {
 //
 // Helper functions for determining if a variable is an array of one of the general types
 //
-bool AstInterpreter::is_int_array(std::shared_ptr<IntrContext> ctx, std::string name) {
-    if (ctx->iarray_map.find(name) == ctx->iarray_map.end()) return false;
-    return true;
+bool AstInterpreter::is_int_array(std::shared_ptr<IntrContext> ctx, Symbol name) {
+    return ctx->var(name).kind == IntrKind::IntArray;
 }
 
-bool AstInterpreter::is_float_array(std::shared_ptr<IntrContext> ctx, std::string name) {
-    return false;
+bool AstInterpreter::is_float_array(std::shared_ptr<IntrContext> ctx, Symbol name) {
+    return ctx->var(name).kind == IntrKind::FloatArray;
 }
 
-bool AstInterpreter::is_string_array(std::shared_ptr<IntrContext> ctx, std::string name) {
-    if (ctx->sarray_map.find(name) == ctx->sarray_map.end()) return false;
-    return true;
+bool AstInterpreter::is_string_array(std::shared_ptr<IntrContext> ctx, Symbol name) {
+    return ctx->var(name).kind == IntrKind::StringArray;
 }
 
+//
+// Whether a numeric expression has a float value. Comparisons do not, even
+// when they compare floats.
+//
+bool AstInterpreter::is_float_expr(std::shared_ptr<IntrContext> ctx, std::shared_ptr<AstExpression> expr) {
+    switch (expr->type) {
+        case V_AstType::FloatL: return true;
+        
+        case V_AstType::ID: {
+            auto kind = ctx->var(std::static_pointer_cast<AstID>(expr)->value).kind;
+            return kind == IntrKind::Float || kind == IntrKind::FloatArray;
+        }
+        
+        case V_AstType::ArrayAccess: {
+            auto acc = std::static_pointer_cast<AstArrayAccess>(expr);
+            return is_float_array(ctx, acc->value);
+        }
+        
+        case V_AstType::FuncCallExpr: {
+            auto fc = std::static_pointer_cast<AstFuncCallExpr>(expr);
+            auto func = function_map.find(fc->name);
+            if (func == function_map.end() || !func->second) return false;
+            return is_float_type(func->second->data_type);
+        }
+        
+        case V_AstType::Neg: {
+            auto op = std::static_pointer_cast<AstNegOp>(expr);
+            return is_float_expr(ctx, op->value);
+        }
+        
+        case V_AstType::Add:
+        case V_AstType::Sub:
+        case V_AstType::Mul:
+        case V_AstType::Div:
+        case V_AstType::Mod: {
+            auto op = std::static_pointer_cast<AstBinaryOp>(expr);
+            return is_float_expr(ctx, op->lval) || is_float_expr(ctx, op->rval);
+        }
+        
+        default: {}
+    }
+    
+    return false;
+}
@@ -7,57 +7,171 @@
 #include <vector>
 #include <cstdint>
 #include <variant>
+#include <unordered_map>
 
 #include <ast/ast.hpp>
+#include <ast/flat_expr.hpp>
+
+#include "buffer.hpp"
+#include "profiler.hpp"
+
+struct FuncProfile;
+
+//
+// What a frame slot holds. It is set when the variable is declared.
+//
+enum class IntrKind : uint8_t {
+    None,
+    Int,
+    Float,
+    String,
+    IntArray,
+    FloatArray,
+    StringArray
+};
+
+struct IntrSlot {
+    IntrKind kind = IntrKind::None;
+    std::shared_ptr<AstDataType> data_type;
+    
+    int ivalue = 0;
+    double fvalue = 0;
+    IntrString svalue;
+    IntrBuffer<uint64_t> iarray;
+    IntrBuffer<double> farray;
+    IntrBuffer<IntrString> sarray;
+};
+
+//
+// The frame layout of a function
+//
+// Before a function first runs, each of its arguments and local variables is
+// given a slot, by name. The slots are found through a small open-addressed
+// table of the function's own names, keyed by symbol ID, so it only grows
+// with the number of locals. Slot 0 is left empty, and names that are not in
+// the function map to it. The empty symbol has ID 0, which marks a free entry.
+//
+struct IntrLayout {
+    uint32_t slot(Symbol name) const {
+        if (entries.empty()) return 0;
+        for (uint32_t i = hash(name.id);; i = (i + 1) & mask) {
+            if (entries[i].id == name.id) return entries[i].slot;
+            if (entries[i].id == 0) return 0;
+        }
+    }
+    
+    void add(Symbol name);
+    
+    uint32_t size = 1;
+protected:
+    struct Entry {
+        uint32_t id = 0;
+        uint32_t slot = 0;
+    };
+    
+    uint32_t hash(uint32_t id) const { return (id * 0x9E3779B1u >> 8) & mask; }
+    void insert(Entry entry);
+private:
+    std::vector<Entry> entries;
+    uint32_t mask = 0;
+};
 
 //
 // This contains the contextual information
-// Every function creates a context
+// Every function call runs in a context, taken from the frame stack
 //
-// * var_map -> Holds variable values
+// * frame -> Holds variable values, one slot for each variable
 // * stack -> Holds values from expression evaluation
 //
 struct IntrContext {
-    std::map<std::string, std::shared_ptr<AstDataType>> type_map;
+    const IntrLayout *layout = nullptr;
+    std::vector<IntrSlot> frame;
     std::shared_ptr<AstDataType> func_type;
+    FuncProfile *profile = nullptr;
     
-    // For variable storage
-    std::map<std::string, int> ivar_map;
-    std::map<std::string, std::string> svar_map;
-    
-    // For array storage
-    std::map<std::string, std::vector<uint64_t>> iarray_map;
-    std::map<std::string, std::vector<std::string>> sarray_map;
+    IntrSlot &var(Symbol name) { return frame[layout->slot(name)]; }
     
     // For expression evaluation
-    std::stack<uint64_t> istack;
-    std::stack<double> fstack;
-    std::stack<std::string> sstack;
+    std::stack<uint64_t, std::vector<uint64_t>> istack;
+    std::stack<double, std::vector<double>> fstack;
+    std::stack<IntrString, std::vector<IntrString>> sstack;
     
     // For a few specific operations
-    std::vector<uint64_t> istack_array;
-    std::vector<std::string> sstack_array;
+    IntrBuffer<uint64_t> istack_array;
+    IntrBuffer<double> fstack_array;
+    IntrBuffer<IntrString> sstack_array;
+};
+
+//
+// The value of a numeric expression, which is an integer until a float is
+// involved. Integers are 64 bits wide, like the integer stack, and floats are
+// doubles. A Float32 variable rounds what is stored in it.
+//
+struct IntrNumber {
+    IntrNumber() {}
+    explicit IntrNumber(uint64_t i) : i(i) {}
+    explicit IntrNumber(double f) : is_float(true), f(f) {}
+    
+    uint64_t as_int() const { return is_float ? (uint64_t)(int64_t)f : i; }
+    double as_float() const { return is_float ? f : (double)(int64_t)i; }
+    
+    bool is_float = false;
+    union {
+        uint64_t i = 0;
+        double f;
+    };
 };
 
 //
 // For passing arguments
 //
-typedef std::variant<uint64_t, float, std::string, std::vector<uint64_t>, std::vector<float>, std::vector<std::string>> vm_arg_list;
+typedef std::variant<uint64_t, double, IntrString, IntrBuffer<uint64_t>, IntrBuffer<double>, IntrBuffer<IntrString>> vm_arg_list;
+
+//
+// A second tier for hot functions
+//
+// The interpreter counts the calls to each function and the loop iterations
+// run in it. Once the total reaches the threshold, the function is handed to
+// the tier. If the tier accepts it, every later call goes to the tier instead.
+// A call that is already being interpreted finishes in the interpreter.
+//
+struct NativeTier {
+    virtual ~NativeTier() {}
+    
+    // Returns false if the function has to stay interpreted
+    virtual bool compile(std::shared_ptr<AstFunction> func) = 0;
+    virtual vm_arg_list call(std::shared_ptr<AstFunction> func, const std::vector<vm_arg_list> &args) = 0;
+};
+
+struct FuncProfile {
+    uint64_t calls = 0;
+    uint64_t back_edges = 0;
+    bool native = false;
+    bool rejected = false;
+};
 
 //
 // This handles running the actual interpreter
 //
 struct AstInterpreter {
     explicit AstInterpreter(std::shared_ptr<AstTree> tree);
+    void set_tier(std::shared_ptr<NativeTier> tier, uint64_t threshold);
+    void set_profiler(std::shared_ptr<IntrProfiler> profiler);
     int run();
     
     // function.cpp
     vm_arg_list run_function(std::shared_ptr<AstFunction> func, std::vector<vm_arg_list> args);
-    vm_arg_list call_function(std::shared_ptr<IntrContext> ctx, std::string name, std::shared_ptr<AstExprList> args);
+    vm_arg_list enter_function(std::shared_ptr<AstFunction> func, std::vector<vm_arg_list> args);
+    const IntrLayout &layout_of(std::shared_ptr<AstFunction> func);
+    std::shared_ptr<IntrContext> push_frame(const IntrLayout &layout);
+    void pop_frame();
+    vm_arg_list call_function(std::shared_ptr<IntrContext> ctx, Symbol name, std::shared_ptr<AstExprList> args);
     void run_print(std::shared_ptr<IntrContext> ctx, std::shared_ptr<AstExprList> args);
+    void print_float(double value);
     
     // interpreter.cpp
     void run_block(std::shared_ptr<IntrContext> ctx, std::shared_ptr<AstBlock> block);
+    void run_statement(const std::shared_ptr<IntrContext> &ctx, const std::shared_ptr<AstStatement> &stmt);
     void run_var_decl(std::shared_ptr<IntrContext> ctx, std::shared_ptr<AstStatement> stmt);
     void run_cond(std::shared_ptr<IntrContext> ctx, std::shared_ptr<AstStatement> stmt);
     void run_while(std::shared_ptr<IntrContext> ctx, std::shared_ptr<AstStatement> stmt);
@@ -65,18 +179,36 @@ struct AstInterpreter {
     bool is_int_type(std::shared_ptr<AstDataType> data_type);
     bool is_float_type(std::shared_ptr<AstDataType> data_type);
     bool is_string_type(std::shared_ptr<AstDataType> data_type);
-    bool is_int_array(std::shared_ptr<IntrContext> ctx, std::string name);
-    bool is_float_array(std::shared_ptr<IntrContext> ctx, std::string name);
-    bool is_string_array(std::shared_ptr<IntrContext> ctx, std::string name);
+    bool is_int_array(std::shared_ptr<IntrContext> ctx, Symbol name);
+    bool is_float_array(std::shared_ptr<IntrContext> ctx, Symbol name);
+    bool is_string_array(std::shared_ptr<IntrContext> ctx, Symbol name);
+    bool is_float_expr(std::shared_ptr<IntrContext> ctx, std::shared_ptr<AstExpression> expr);
     
     // expression.cpp
     void run_expression(std::shared_ptr<IntrContext> ctx, std::shared_ptr<AstExpression> expr, std::shared_ptr<AstDataType> type);
     void run_iexpression(std::shared_ptr<IntrContext> ctx, std::shared_ptr<AstExpression> expr);
     void run_fexpression(std::shared_ptr<IntrContext> ctx, std::shared_ptr<AstExpression> expr);
     void run_sexpression(std::shared_ptr<IntrContext> ctx, std::shared_ptr<AstExpression> expr);
+    IntrNumber run_number(const std::shared_ptr<IntrContext> &ctx, const std::shared_ptr<AstExpression> &expr);
+    IntrNumber run_operand(const std::shared_ptr<IntrContext> &ctx, const std::shared_ptr<AstExpression> &expr);
+    IntrNumber run_flat_expression(const std::shared_ptr<IntrContext> &ctx, const FlatExpr &flat);
     
 protected:
     std::shared_ptr<AstTree> tree;
-    std::map<std::string, std::shared_ptr<AstFunction>> function_map;
+    SymbolMap<std::shared_ptr<AstFunction>> function_map;
+    FlatExprTable flat_exprs;
+    std::unordered_map<AstFunction *, IntrLayout> layouts;
+    
+    // The frames of the calls being run, and the ones above them kept for reuse
+    std::vector<std::shared_ptr<IntrContext>> frames;
+    size_t frame_depth = 0;
+    
+    // Tiering
+    std::shared_ptr<NativeTier> tier;
+    uint64_t tier_threshold = 0;
+    std::unordered_map<AstFunction *, FuncProfile> profiles;
+    
+    // Set only with --profile
+    std::shared_ptr<IntrProfiler> profiler;
 };
 
@@ -0,0 +1,144 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#include <iomanip>
+#include <algorithm>
+
+#include "profiler.hpp"
+
+IntrProfiler::IntrProfiler() {}
+
+//
+// Calls
+//
+// A recursive function is only given inclusive time when its outermost
+// call returns, so the time of the inner calls is not counted twice.
+//
+void IntrProfiler::enter(AstFunction *func) {
+    auto &stats = funcs[func];
+    if (stats.calls == 0) func_order.push_back(func);
+    ++stats.calls;
+    ++stats.active;
+    
+    CallPath *parent = stack.empty() ? &root : stack.back().path;
+    auto &path = parent->children[func];
+    if (!path) {
+        path = std::make_unique<CallPath>();
+        path->func = func;
+    }
+    
+    stack.push_back({func, path.get(), Clock::now()});
+}
+
+void IntrProfiler::leave() {
+    auto end = Clock::now();
+    Frame frame = stack.back();
+    stack.pop_back();
+    
+    uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end - frame.start).count();
+    uint64_t self = elapsed - std::min(elapsed, frame.callees);
+    if (!stack.empty()) stack.back().callees += elapsed;
+    
+    auto &stats = funcs[frame.func];
+    stats.exclusive += self;
+    if (--stats.active == 0) stats.inclusive += elapsed;
+    frame.path->exclusive += self;
+}
+
+IntrProfiler::StmtStats &IntrProfiler::stmt_stats(AstStatement *stmt) {
+    auto found = stmts.find(stmt);
+    if (found != stmts.end()) return found->second;
+    
+    auto &stats = stmts[stmt];
+    if (!stack.empty()) stats.func = stack.back().func;
+    stmt_order.push_back(stmt);
+    return stats;
+}
+
+//
+// A short description of a statement for the report
+//
+static std::string describe(AstStatement *stmt) {
+    switch (stmt->type) {
+        case V_AstType::VarDec: return "var " + static_cast<AstVarDec *>(stmt)->name;
+        case V_AstType::Return: return "return";
+        case V_AstType::If: return "if";
+        case V_AstType::While: return "while";
+        case V_AstType::FuncCallStmt: return static_cast<AstFuncCallStmt *>(stmt)->name + "()";
+        
+        case V_AstType::ExprStmt: {
+            auto expr = stmt->expression;
+            if (expr && expr->type == V_AstType::Assign) {
+                auto op = std::static_pointer_cast<AstAssignOp>(expr);
+                if (op->lval->type == V_AstType::ID) {
+                    return std::static_pointer_cast<AstID>(op->lval)->value + " :=";
+                } else if (op->lval->type == V_AstType::ArrayAccess) {
+                    return std::static_pointer_cast<AstArrayAccess>(op->lval)->value + "[] :=";
+                }
+            }
+            return "expression";
+        }
+        
+        default: {}
+    }
+    return "statement";
+}
+
+//
+// The flat report: functions by exclusive time, then statements by hits
+//
+void IntrProfiler::write_report(std::ostream &out) {
+    auto order = func_order;
+    std::stable_sort(order.begin(), order.end(), [&](AstFunction *a, AstFunction *b) {
+        return funcs[a].exclusive > funcs[b].exclusive;
+    });
+    
+    out << std::fixed << std::setprecision(3);
+    out << std::setw(12) << "calls" << std::setw(16) << "inclusive (ms)" << std::setw(16) << "exclusive (ms)";
+    out << "  function" << std::endl;
+    for (auto func : order) {
+        auto &stats = funcs[func];
+        out << std::setw(12) << stats.calls << std::setw(16) << stats.inclusive / 1e6;
+        out << std::setw(16) << stats.exclusive / 1e6 << "  " << func->name;
+        if (func->line) out << " (line " << func->line << ")";
+        out << std::endl;
+    }
+    out << std::endl;
+    
+    auto stmt_list = stmt_order;
+    std::stable_sort(stmt_list.begin(), stmt_list.end(), [&](AstStatement *a, AstStatement *b) {
+        return stmts[a].hits > stmts[b].hits;
+    });
+    
+    out << std::setw(12) << "hits" << std::setw(16) << "iterations" << std::setw(8) << "line";
+    out << "  statement" << std::endl;
+    for (auto stmt : stmt_list) {
+        auto &stats = stmts[stmt];
+        out << std::setw(12) << stats.hits << std::setw(16);
+        if (stmt->type == V_AstType::While) out << stats.iterations;
+        else out << "";
+        out << std::setw(8) << stmt->line << "  ";
+        if (stats.func) out << stats.func->name << ": ";
+        out << describe(stmt) << std::endl;
+    }
+}
+
+//
+// The collapsed stacks
+//
+void IntrProfiler::write_collapsed(std::ostream &out) {
+    for (auto const &child : root.children) {
+        write_paths(out, child.second.get(), "");
+    }
+}
+
+void IntrProfiler::write_paths(std::ostream &out, CallPath *path, std::string prefix) {
+    prefix += path->func->name.str();
+    if (path->exclusive > 0) out << prefix << " " << path->exclusive << "\n";
+    
+    for (auto const &child : path->children) {
+        write_paths(out, child.second.get(), prefix + ";");
+    }
+}
@@ -0,0 +1,97 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include <cstdint>
+
+#include <ast/ast.hpp>
+
+//
+// An execution profile of the tree interpreter
+//
+// The interpreter only calls in here when a profiler is set, so a run
+// without one does no profiling work. Each function records its calls, the
+// time spent in it and its callees (inclusive) and in it alone (exclusive).
+// Each statement records how often it ran, and each loop how many times its
+// body ran.
+//
+// Calls made by a function are kept as a tree of call paths, which is
+// written out as collapsed stacks: one line per path, with the frames joined
+// by ';' and the exclusive time in nanoseconds, the way flame graph tools
+// read them.
+//
+struct IntrProfiler {
+    IntrProfiler();
+    
+    void enter(AstFunction *func);
+    void leave();
+    void hit(AstStatement *stmt) { ++stmt_stats(stmt).hits; }
+    void iterations(AstStatement *stmt, uint64_t count) { stmt_stats(stmt).iterations += count; }
+    
+    void write_report(std::ostream &out);
+    void write_collapsed(std::ostream &out);
+protected:
+    typedef std::chrono::steady_clock Clock;
+    
+    struct FuncStats {
+        uint64_t calls = 0;
+        uint64_t inclusive = 0;     // ns
+        uint64_t exclusive = 0;     // ns
+        int active = 0;             // calls of it on the stack
+    };
+    
+    struct StmtStats {
+        AstFunction *func = nullptr;
+        uint64_t hits = 0;
+        uint64_t iterations = 0;
+    };
+    
+    // A node of the call path tree
+    struct CallPath {
+        AstFunction *func = nullptr;
+        std::unordered_map<AstFunction *, std::unique_ptr<CallPath>> children;
+        uint64_t exclusive = 0;     // ns
+    };
+    
+    struct Frame {
+        AstFunction *func;
+        CallPath *path;
+        Clock::time_point start;
+        uint64_t callees = 0;       // ns
+    };
+    
+    StmtStats &stmt_stats(AstStatement *stmt);
+    void write_paths(std::ostream &out, CallPath *path, std::string prefix);
+private:
+    std::unordered_map<AstFunction *, FuncStats> funcs;
+    std::unordered_map<AstStatement *, StmtStats> stmts;
+    std::vector<AstFunction *> func_order;
+    std::vector<AstStatement *> stmt_order;
+    
+    CallPath root;
+    std::vector<Frame> stack;
+};
+
+//
+// Times a call for as long as it is in scope, if there is a profiler
+//
+struct IntrProfileScope {
+    IntrProfileScope(IntrProfiler *profiler, AstFunction *func) : profiler(profiler) {
+        if (profiler) profiler->enter(func);
+    }
+    
+    ~IntrProfileScope() {
+        if (profiler) profiler->leave();
+    }
+    
+    IntrProfiler *profiler;
+};
@@ -0,0 +1,254 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <algorithm>
+
+#include "bytecode.hpp"
+
+static const char *op_names[] = {
+#define BYTECODE_NAME(name) #name,
+    BYTECODE_OPS(BYTECODE_NAME)
+#undef BYTECODE_NAME
+};
+
+BytecodeVM::BytecodeVM(std::shared_ptr<BcProgram> program) {
+    this->program = program;
+}
+
+int BytecodeVM::run() {
+    auto &main = program->functions[program->main];
+    reserve(main, 0, 0, 0, 0);
+    run_function(main, 0, 0, 0, 0);
+    std::cout.flush();
+    return (int)iret;
+}
+
+//
+// Makes room for a frame. The stores grow to twice what is needed, so a deep
+// recursion only grows them a few times.
+//
+void BytecodeVM::reserve(const BcFunction &func, size_t ibase, size_t sbase, size_t iabase, size_t sabase) {
+    if (istore.size() < ibase + func.iregs) istore.resize((ibase + func.iregs) * 2);
+    if (sstore.size() < sbase + func.sregs) sstore.resize((sbase + func.sregs) * 2);
+    if (iastore.size() < iabase + func.iaregs) iastore.resize((iabase + func.iaregs) * 2);
+    if (sastore.size() < sabase + func.saregs) sastore.resize((sabase + func.saregs) * 2);
+}
+
+//
+// The dispatch loop
+//
+// Each instruction jumps straight to the code of the next one through a table
+// of label addresses, rather than going back to the top of a switch.
+//
+void BytecodeVM::run_function(const BcFunction &func, size_t ibase, size_t sbase, size_t iabase, size_t sabase) {
+    static void *labels[] = {
+#define BYTECODE_LABEL(name) &&op_##name,
+        BYTECODE_OPS(BYTECODE_LABEL)
+#undef BYTECODE_LABEL
+    };
+
+    uint64_t *i = istore.data() + ibase;
+    IntrString *s = sstore.data() + sbase;
+    IntrBuffer<uint64_t> *ia = iastore.data() + iabase;
+    IntrBuffer<IntrString> *sa = sastore.data() + sabase;
+
+    // The constants go in the last registers
+    if (!func.iconsts.empty()) {
+        memcpy(i + func.iregs - func.iconsts.size(), func.iconsts.data(), func.iconsts.size() * sizeof(uint64_t));
+    }
+
+    // What the function returns, until it ends
+    uint64_t ret_int = 0;
+    IntrString ret_string;
+    uint32_t ret_array = UINT32_MAX;
+
+    const BcInstr *code = func.code.data();
+    const BcInstr *pc = code;
+    auto &sconsts = program->sconsts;
+
+#define DISPATCH() goto *labels[(uint32_t)pc->op]
+#define NEXT() ++pc; DISPATCH()
+#define BINARY(name, expr) op_##name: i[pc->a] = (expr); NEXT();
+#define BRANCH(name, cond) op_##name: if (cond) pc = code + pc->c; else ++pc; DISPATCH();
+
+    DISPATCH();
+
+    op_IMov: i[pc->a] = i[pc->b]; NEXT();
+    op_IStore: i[pc->a] = (uint64_t)(int)i[pc->b]; NEXT();
+    op_INeg: i[pc->a] = -i[pc->b]; NEXT();
+
+    BINARY(IAdd, i[pc->b] + i[pc->c])
+    BINARY(ISub, i[pc->b] - i[pc->c])
+    BINARY(IMul, i[pc->b] * i[pc->c])
+    BINARY(IDiv, i[pc->b] / i[pc->c])
+    BINARY(IMod, i[pc->b] % i[pc->c])
+    BINARY(IAnd, i[pc->b] & i[pc->c])
+    BINARY(IOr, i[pc->b] | i[pc->c])
+    BINARY(IXor, i[pc->b] ^ i[pc->c])
+    BINARY(ILsh, i[pc->b] << i[pc->c])
+    BINARY(IRsh, i[pc->b] >> i[pc->c])
+    BINARY(IEq, i[pc->b] == i[pc->c])
+    BINARY(INe, i[pc->b] != i[pc->c])
+    BINARY(IGt, i[pc->b] > i[pc->c])
+    BINARY(ILt, i[pc->b] < i[pc->c])
+    BINARY(IGe, i[pc->b] >= i[pc->c])
+    BINARY(ILe, i[pc->b] <= i[pc->c])
+
+    op_Jmp: pc = code + pc->a; DISPATCH();
+    BRANCH(Jz, !i[pc->a])
+    BRANCH(Jnz, i[pc->a])
+    BRANCH(JEq, i[pc->a] == i[pc->b])
+    BRANCH(JNe, i[pc->a] != i[pc->b])
+    BRANCH(JLe, i[pc->a] <= i[pc->b])
+    BRANCH(JGe, i[pc->a] >= i[pc->b])
+    BRANCH(JLt, i[pc->a] < i[pc->b])
+    BRANCH(JGt, i[pc->a] > i[pc->b])
+
+    op_SConst: s[pc->a] = sconsts[pc->b]; NEXT();
+    op_SMov: s[pc->a] = s[pc->b]; NEXT();
+    op_SClear: s[pc->a].clear(); NEXT();
+    op_SChar: s[pc->a] = std::string_view(&s[pc->b][(int)i[pc->c]], 1); NEXT();
+    op_SLen: i[pc->a] = s[pc->b].length(); NEXT();
+
+    op_IANew: ia[pc->a] = IntrBuffer<uint64_t>(std::max((int)i[pc->b], 0), 0); NEXT();
+    op_IAClear: ia[pc->a].clear(); NEXT();
+    op_IALoad: i[pc->a] = ia[pc->b][(int)i[pc->c]]; NEXT();
+    op_IAStore: ia[pc->a].write((int)i[pc->b]) = (uint64_t)(int)i[pc->c]; NEXT();
+    op_IALen: i[pc->a] = ia[pc->b].size(); NEXT();
+
+    op_SANew: sa[pc->a] = IntrBuffer<IntrString>(std::max((int)i[pc->b], 0)); NEXT();
+    op_SAClear: sa[pc->a].clear(); NEXT();
+    op_SALoad: s[pc->a] = sa[pc->b][(int)i[pc->c]]; NEXT();
+    op_SAStore: sa[pc->a].write((int)i[pc->b]) = s[pc->c]; NEXT();
+    op_SALen: i[pc->a] = sa[pc->b].size(); NEXT();
+
+    // The callee's frame starts after this one. Arguments are copied into
+    // its first registers of each file, in order.
+    op_Call: {
+        const BcFunction &callee = program->functions[pc->a];
+        size_t ib = ibase + func.iregs;
+        size_t sb = sbase + func.sregs;
+        size_t iab = iabase + func.iaregs;
+        size_t sab = sabase + func.saregs;
+        reserve(callee, ib, sb, iab, sab);
+
+        i = istore.data() + ibase;
+        s = sstore.data() + sbase;
+        ia = iastore.data() + iabase;
+        sa = sastore.data() + sabase;
+
+        const uint32_t *args = func.call_args.data() + pc->b;
+        size_t ni = ib, ns = sb, nia = iab, nsa = sab;
+        for (size_t k = 0; k<callee.params.size(); k++) {
+            switch (callee.params[k]) {
+                case BcKind::Int: istore[ni++] = (uint64_t)(int)i[args[k]]; break;
+                case BcKind::String: sstore[ns++] = s[args[k]]; break;
+                case BcKind::IntArray: iastore[nia++] = ia[args[k]]; break;
+                case BcKind::StringArray: sastore[nsa++] = sa[args[k]]; break;
+                default: {}
+            }
+        }
+
+        run_function(callee, ib, sb, iab, sab);
+
+        i = istore.data() + ibase;
+        s = sstore.data() + sbase;
+        ia = iastore.data() + iabase;
+        sa = sastore.data() + sabase;
+        NEXT();
+    }
+
+    op_IResult: i[pc->a] = iret; NEXT();
+    op_SResult: s[pc->a] = std::move(sret); NEXT();
+    op_IAResult: ia[pc->a] = std::move(iaret); NEXT();
+    op_SAResult: sa[pc->a] = std::move(saret); NEXT();
+
+    op_IRet: ret_int = i[pc->a]; NEXT();
+    op_SRet: ret_string = s[pc->a]; NEXT();
+    op_IARet: ret_array = pc->a; NEXT();
+    op_SARet: ret_array = pc->a; NEXT();
+
+    op_End: {
+        switch (func.ret) {
+            case BcKind::String: sret = std::move(ret_string); break;
+
+            case BcKind::IntArray: {
+                if (ret_array == UINT32_MAX) iaret.clear();
+                else iaret = std::move(ia[ret_array]);
+            } break;
+
+            case BcKind::StringArray: {
+                if (ret_array == UINT32_MAX) saret.clear();
+                else saret = std::move(sa[ret_array]);
+            } break;
+
+            default: iret = ret_int;
+        }
+        return;
+    }
+
+    op_PrintI: std::cout << (int)i[pc->a]; NEXT();
+    op_PrintU: std::cout << i[pc->a]; NEXT();
+    op_PrintS: std::cout << s[pc->a]; NEXT();
+    op_PrintK: std::cout << sconsts[pc->a]; NEXT();
+
+    op_PrintIA: {
+        auto &array = ia[pc->a];
+        std::cout << "[";
+        for (size_t k = 0; k<array.size(); k++) {
+            std::cout << array[k];
+            if (k+1 < array.size()) std::cout << ", ";
+        }
+        std::cout << "]";
+        NEXT();
+    }
+
+    op_PrintSA: {
+        auto &array = sa[pc->a];
+        std::cout << "[";
+        for (size_t k = 0; k<array.size(); k++) {
+            std::cout << "\"" << array[k] << "\"";
+            if (k+1 < array.size()) std::cout << ", ";
+        }
+        std::cout << "]";
+        NEXT();
+    }
+
+    op_PrintLn: std::cout << '\n'; NEXT();
+
+#undef BRANCH
+#undef BINARY
+#undef NEXT
+#undef DISPATCH
+}
+
+//
+// Prints the bytecode of every function
+//
+void BcProgram::print() {
+    for (auto const &func : functions) {
+        std::cout << "FUNC " << func.name.str() << " (int: " << func.iregs << ", string: " << func.sregs;
+        std::cout << ", int[]: " << func.iaregs << ", string[]: " << func.saregs << ")" << std::endl;
+
+        uint32_t base = func.iregs - func.iconsts.size();
+        for (size_t k = 0; k<func.iconsts.size(); k++) {
+            std::cout << "    i" << (base + k) << " = " << func.iconsts[k] << std::endl;
+        }
+
+        for (size_t k = 0; k<func.code.size(); k++) {
+            auto const &instr = func.code[k];
+            std::cout << std::setw(8) << k << "  " << std::left << std::setw(10) << op_names[(uint32_t)instr.op];
+            std::cout << std::right << instr.a << ", " << instr.b << ", " << instr.c << std::endl;
+        }
+        std::cout << std::endl;
+    }
+
+    for (size_t k = 0; k<sconsts.size(); k++) {
+        std::cout << "CONST " << k << ": \"" << sconsts[k] << "\"" << std::endl;
+    }
+}
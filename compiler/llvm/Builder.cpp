@@ -5,29 +5,39 @@
 //
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Program.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/MC/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
 #include "llvm/IR/LegacyPassManager.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/IR/PassTimingInfo.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Passes/PassBuilder.h"
 
 using namespace llvm;
 using namespace llvm::sys;
 
 #include "Compiler.hpp"
 
-void Compiler::writeAssembly() {
-    std::string triple = "";
-
+//
+// Sets up the target machine for the host
+//
+// The machine is made once and shared by every module the compiler writes.
+//
+TargetMachine *Compiler::getTargetMachine() {
+    if (machine) return machine.get();
+    
     LLVMInitializeX86TargetInfo();
     LLVMInitializeX86Target();
     LLVMInitializeX86TargetMC();
     LLVMInitializeX86AsmParser();
     LLVMInitializeX86AsmPrinter();
     
-    triple = sys::getDefaultTargetTriple();
-    mod->setTargetTriple(triple);
+    std::string triple = sys::getDefaultTargetTriple();
     
     std::string error;
     auto target = TargetRegistry::lookupTarget(triple, error);
@@ -35,23 +45,121 @@ void Compiler::writeAssembly() {
     // Check for any errors with the target triple
     if (!target) {
         errs() << error;
-        return;
+        return nullptr;
     }
     
-    // CPU and features
-    auto CPU = "generic";
-    auto features = "";
+    // CPU and features. For the host, the features it reports come first so
+    // that -mattr can still turn them off.
+    std::string CPU = cflags.cpu;
+    std::string features = "";
+    
+    if (CPU == "native") {
+        CPU = sys::getHostCPUName().str();
+        
+        StringMap<bool> hostFeatures;
+        if (sys::getHostCPUFeatures(hostFeatures)) {
+            for (auto &feature : hostFeatures) {
+                if (!features.empty()) features += ",";
+                features += (feature.second ? "+" : "-") + feature.first().str();
+            }
+        }
+    }
+    
+    if (!cflags.features.empty()) {
+        if (!features.empty()) features += ",";
+        features += cflags.features;
+    }
     
     TargetOptions options;
     auto RM = Optional<Reloc::Model>();
-    auto machine = target->createTargetMachine(triple, CPU, features, options, RM);
+    
+    auto level = CodeGenOpt::None;
+    switch (cflags.opt_level) {
+        case 0: break;
+        case 1: level = CodeGenOpt::Less; break;
+        case 2: level = CodeGenOpt::Default; break;
+        default: level = CodeGenOpt::Aggressive;
+    }
+    
+    machine.reset(target->createTargetMachine(triple, CPU, features, options, RM, None, level));
+    return machine.get();
+}
+
+//
+// Records the target CPU on a function, so that the optimizer (the
+// vectorizers in particular) knows which instructions it may use
+//
+// Nothing is added for the generic CPU, which is what LLVM assumes anyway.
+//
+void Compiler::setTargetAttributes(Function *func) {
+    if (cflags.cpu == "generic" && cflags.features.empty()) return;
+    
+    TargetMachine *machine = getTargetMachine();
+    if (!machine) return;
+    
+    func->addFnAttr("target-cpu", machine->getTargetCPU());
+    if (!machine->getTargetFeatureString().empty()) {
+        func->addFnAttr("target-features", machine->getTargetFeatureString());
+    }
+}
+
+//
+// Runs the default optimization pipeline of the chosen level over the module
+//
+// At -O0 the module is left alone. With --time-passes, the time spent in each
+// pass is printed to stderr, here and when the code is generated.
+//
+void Compiler::optimize() {
+    if (cflags.opt_level == 0) return;
+    
+    TargetMachine *machine = getTargetMachine();
+    if (!machine) return;
+    
+    mod->setTargetTriple(machine->getTargetTriple().str());
     mod->setDataLayout(machine->createDataLayout());
     
-    // Write it out
-    std::string outputPath = "/tmp/" + cflags.name + ".asm";
+    // The passes assume well-formed IR
+    if (verifyModule(*mod, &errs())) {
+        errs() << "Warning: Invalid module, skipping optimization.\n";
+        return;
+    }
+    
+    OptimizationLevel level = OptimizationLevel::O1;
+    if (cflags.opt_size) level = OptimizationLevel::Os;
+    else if (cflags.opt_level == 2) level = OptimizationLevel::O2;
+    else if (cflags.opt_level >= 3) level = OptimizationLevel::O3;
+    
+    PassInstrumentationCallbacks callbacks;
+    TimePassesHandler timer(cflags.time_passes);
+    timer.registerCallbacks(callbacks);
     
+    LoopAnalysisManager LAM;
+    FunctionAnalysisManager FAM;
+    CGSCCAnalysisManager CGAM;
+    ModuleAnalysisManager MAM;
+    
+    PassBuilder builder(machine, PipelineTuningOptions(), None, &callbacks);
+    FAM.registerPass([&] { return builder.buildDefaultAAPipeline(); });
+    builder.registerModuleAnalyses(MAM);
+    builder.registerCGSCCAnalyses(CGAM);
+    builder.registerFunctionAnalyses(FAM);
+    builder.registerLoopAnalyses(LAM);
+    builder.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+    
+    ModulePassManager passes = builder.buildPerModuleDefaultPipeline(level);
+    passes.run(*mod, MAM);
+}
+
+void Compiler::writeAssembly(std::string path) {
+    TargetMachine *machine = getTargetMachine();
+    if (!machine) return;
+    
+    mod->setTargetTriple(machine->getTargetTriple().str());
+    mod->setDataLayout(machine->createDataLayout());
+    
+    // Write it out
     std::error_code errorCode;
-    raw_fd_ostream writer(outputPath, errorCode, sys::fs::OF_None);
+    raw_fd_ostream writer(path, errorCode, sys::fs::OF_None);
     
     if (errorCode) {
         errs() << "Unable to open file: " << errorCode.message();
@@ -66,7 +174,90 @@ void Compiler::writeAssembly() {
         return;
     }
     
+    TimePassesIsEnabled = cflags.time_passes;
     pass.run(*mod);
     writer.flush();
+    
+    if (cflags.time_passes) reportAndResetTimings(&errs());
+}
+
+//
+// Generates an object file for the current module into memory
+//
+bool Compiler::emitObject(std::string &object) {
+    TargetMachine *machine = getTargetMachine();
+    if (!machine) return false;
+    
+    mod->setTargetTriple(machine->getTargetTriple().str());
+    mod->setDataLayout(machine->createDataLayout());
+    
+    SmallVector<char, 0> buffer;
+    raw_svector_ostream writer(buffer);
+    
+    legacy::PassManager pass;
+    if (machine->addPassesToEmitFile(pass, writer, nullptr, CGFT_ObjectFile)) {
+        errs() << "Unable to emit object code.";
+        return false;
+    }
+    
+    TimePassesIsEnabled = cflags.time_passes;
+    pass.run(*mod);
+    if (cflags.time_passes) reportAndResetTimings(&errs());
+    
+    object.assign(buffer.data(), buffer.size());
+    return true;
 }
 
+//
+// Writes the object code for the module to a new temporary file, and returns
+// its path in the argument
+//
+// Every call gets a file of its own, so compilers running at the same time
+// never write to the same path.
+//
+bool Compiler::writeObject(std::string &path) {
+    std::string object;
+    if (!emitObject(object)) return false;
+    
+    int fd;
+    SmallString<128> tempPath;
+    if (sys::fs::createTemporaryFile(sys::path::filename(cflags.name), "o", fd, tempPath)) {
+        errs() << "Unable to create an object file.\n";
+        return false;
+    }
+    
+    raw_fd_ostream writer(fd, true);
+    writer << object;
+    writer.close();
+    
+    path = tempPath.str().str();
+    if (writer.has_error()) {
+        errs() << "Unable to write object file: " << path << "\n";
+        writer.clear_error();
+        sys::fs::remove(path);
+        return false;
+    }
+    return true;
+}
+
+//
+// Runs the system linker directly, without going through a shell
+//
+bool runLinker(std::vector<std::string> args) {
+    auto ld = sys::findProgramByName("ld");
+    if (!ld) {
+        errs() << "Error: Unable to find the linker (ld).\n";
+        return false;
+    }
+    
+    std::vector<StringRef> argv = { *ld };
+    for (auto const &arg : args) argv.push_back(arg);
+    
+    std::string error;
+    int result = sys::ExecuteAndWait(*ld, argv, None, {}, 0, 0, &error);
+    if (result != 0) {
+        if (!error.empty()) errs() << "Error: " << error << "\n";
+        return false;
+    }
+    return true;
+}
@@ -29,21 +29,7 @@ Compiler::Compiler(std::shared_ptr<AstTree> tree, CFlags cflags) {
 }
 
 void Compiler::compile() {
-    // Build the structures used by the program
-    for (auto str : tree->structs) {
-        std::vector<Type *> elementTypes;
-        
-        for (auto v : str->items) {
-            Type *t = translateType(v.type);
-            elementTypes.push_back(t);
-        }
-        
-        StructType *s = StructType::create(*context, elementTypes);
-        s->setName(str->name);
-        
-        structTable[str->name] = s;
-        structElementTypeTable[str->name] = elementTypes;
-    }
+    compileStructures();
 
     // Build all other functions
     for (auto global : tree->block->getBlock()) {
@@ -64,6 +50,24 @@ void Compiler::compile() {
     }
 }
 
+// Builds the structures used by the program
+void Compiler::compileStructures() {
+    for (auto str : tree->structs) {
+        std::vector<Type *> elementTypes;
+        
+        for (auto v : str->items) {
+            Type *t = translateType(v.type);
+            elementTypes.push_back(t);
+        }
+        
+        StructType *s = StructType::create(*context, elementTypes);
+        s->setName(str->name.str());
+        
+        structTable[str->name] = s;
+        structElementTypeTable[str->name] = elementTypes;
+    }
+}
+
 void Compiler::debug() {
     mod->print(errs(), nullptr);
 }
@@ -154,7 +158,7 @@ Value *Compiler::compileValue(std::shared_ptr<AstExpression> expr, V_AstType dat
             auto i = std::static_pointer_cast<AstInt>(expr);
             if (i->size == 8) return builder->getInt8(i->value);
             else if (i->size == 16) return builder->getInt16(i->value);
-            else if (i->size == 64) return builder->getInt64(i->value);
+            else if (i->size == 64 || cflags.interpreter_ints) return builder->getInt64(i->value);
             return builder->getInt32(i->value);
         } break;
         
@@ -194,7 +198,8 @@ Value *Compiler::compileValue(std::shared_ptr<AstExpression> expr, V_AstType dat
                 PointerType *strPtrType = Type::getInt8PtrTy(*context);
                 Type *i8Type = Type::getInt8Ty(*context);
                 
-                Value *arrayPtr = builder->CreateLoad(strPtrType, ptr);
+                Value *arrayPtr = builder->CreateLoad(translateType(ptrType), ptr);
+                arrayPtr = castValue(arrayPtr, strPtrType);
                 Value *ep = builder->CreateGEP(i8Type, arrayPtr, index);
                 if (isAssign) return ep;
                 else return builder->CreateLoad(i8Type, ep);
@@ -222,15 +227,15 @@ Value *Compiler::compileValue(std::shared_ptr<AstExpression> expr, V_AstType dat
                 args.push_back(val);
             }
             
-            Function *callee = mod->getFunction(fc->name);
+            Function *callee = mod->getFunction(fc->name.str());
             if (!callee) std::cerr << "Invalid function call statement: " << fc->name << std::endl;
-            return builder->CreateCall(callee, args);
+            return createCall(callee, args);
         } break;
         
         case V_AstType::FuncRef: {
             auto ref = std::static_pointer_cast<AstFuncRef>(expr);
             
-            Function *callee = mod->getFunction(ref->value);
+            Function *callee = mod->getFunction(ref->value.str());
             if (!callee) std::cerr << "Invalid function reference." << std::endl;
             return builder->CreatePointerCast(callee, PointerType::getUnqual(builder->getVoidTy()));
         }
@@ -267,7 +272,7 @@ Value *Compiler::compileValue(std::shared_ptr<AstExpression> expr, V_AstType dat
             Value *ptr = compileValue(lvalExpr, V_AstType::Void, true);
             Value *rval = compileValue(op->rval, dtype);
             
-            builder->CreateStore(rval, ptr);
+            createStore(rval, ptr);
         } break;
         
         case V_AstType::LogicalAnd:
@@ -314,79 +319,147 @@ Value *Compiler::compileValue(std::shared_ptr<AstExpression> expr, V_AstType dat
         case V_AstType::LT:
         case V_AstType::GTE:
         case V_AstType::LTE: {
-            std::shared_ptr<AstBinaryOp> op = std::static_pointer_cast<AstBinaryOp>(expr);
-            std::shared_ptr<AstExpression> lvalExpr = op->lval;
-            std::shared_ptr<AstExpression> rvalExpr = op->rval;
+            if (flatDepth == flatScratch.size()) flatScratch.push_back(std::make_unique<FlatScratch>());
+            FlatScratch &scratch = *flatScratch[flatDepth];
+            scratch.flat.reset(expr);
             
-            Value *lval = compileValue(lvalExpr);
-            Value *rval = compileValue(rvalExpr);
+            ++flatDepth;
+            Value *value = compileFlatValue(scratch.flat, scratch.values, dataType);
+            --flatDepth;
+            return value;
+        } break;
+        
+        default: {}
+    }
+    
+    return nullptr;
+}
+
+//
+// Compiles an operator expression from its flat form
+//
+// The nodes are visited in order, so every operand is compiled before the
+// operator that uses it, in the same order as the recursive walk. Only the
+// root sees the requested data type; the operands are compiled as if they
+// were passed to compileValue on their own.
+//
+Value *Compiler::compileFlatValue(const FlatExpr &flat, std::vector<Value *> &values, V_AstType dataType) {
+    values.assign(flat.size(), nullptr);
+    
+    for (uint32_t i = 0; i<flat.size(); i++) {
+        V_AstType op = flat.ops[i];
+        V_AstType type = (i == flat.root()) ? dataType : V_AstType::Void;
+        
+        switch (op) {
+            case V_AstType::IntL: {
+                int64_t value = flat.int_value(i);
+                if (flat.sizes[i] == 8) values[i] = builder->getInt8(value);
+                else if (flat.sizes[i] == 16) values[i] = builder->getInt16(value);
+                else if (flat.sizes[i] == 64 || cflags.interpreter_ints) values[i] = builder->getInt64(value);
+                else values[i] = builder->getInt32(value);
+            } break;
+            
+            case V_AstType::FloatL: {
+                if (type == V_AstType::Float64)
+                    values[i] = ConstantFP::get(Type::getDoubleTy(*context), flat.float_value(i));
+                else
+                    values[i] = ConstantFP::get(Type::getFloatTy(*context), flat.float_value(i));
+            } break;
+            
+            case V_AstType::CharL: values[i] = builder->getInt8(flat.int_value(i)); break;
             
-            bool fltOp = false;
-            if (lvalExpr->type == V_AstType::FloatL || rvalExpr->type == V_AstType::FloatL) {
-                fltOp = true;
+            case V_AstType::ID: {
+                Symbol name = flat.symbol(i);
+                AllocaInst *ptr = symtable[name];
+                Type *ptrType = translateType(typeTable[name]);
                 
-                if (lvalExpr->type == V_AstType::ID) {
-                    auto lvalID = std::static_pointer_cast<AstID>(lvalExpr);
-                    if (typeTable[lvalID->value]->type == V_AstType::Float64)
-                        rval = compileValue(rvalExpr, V_AstType::Float64);
-                } else if (rvalExpr->type == V_AstType::ID) {
-                    auto rvalID = std::static_pointer_cast<AstID>(rvalExpr);
-                    if (typeTable[rvalID->value]->type == V_AstType::Float64)
-                        lval = compileValue(lvalExpr, V_AstType::Float64);
+                if (typeTable[name]->type == V_AstType::Struct) values[i] = ptr;
+                else values[i] = builder->CreateLoad(ptrType, ptr);
+            } break;
+            
+            case V_AstType::Neg: values[i] = builder->CreateNeg(values[flat.lhs[i]]); break;
+            
+            default: {
+                if (!FlatExpr::is_operator(op)) {
+                    values[i] = compileValue(flat.node(i));
+                    break;
                 }
-            } else if (lvalExpr->type == V_AstType::ID && rvalExpr->type == V_AstType::ID) {
-                auto lvalID = std::static_pointer_cast<AstID>(lvalExpr);
-                auto rvalID = std::static_pointer_cast<AstID>(rvalExpr);
                 
-                V_AstType lvalType = typeTable[lvalID->value]->type;
-                V_AstType rvalType = typeTable[rvalID->value]->type;
+                uint32_t l = flat.lhs[i];
+                uint32_t r = flat.rhs[i];
+                Value *lval = values[l];
+                Value *rval = values[r];
                 
-                if (lvalType == V_AstType::Float32 || lvalType == V_AstType::Float64) fltOp = true;
-                if (rvalType == V_AstType::Float32 || rvalType == V_AstType::Float64) fltOp = true;
-            }
-            
-            // Otherwise, build a normal comparison
-            if ((dataType == V_AstType::Float32 || dataType == V_AstType::Float64) || fltOp) {
-                switch (expr->type) {
-                    case V_AstType::Add: return builder->CreateFAdd(lval, rval);
-                    case V_AstType::Sub: return builder->CreateFSub(lval, rval);
-                    case V_AstType::Mul: return builder->CreateFMul(lval, rval);
-                    case V_AstType::Div: return builder->CreateFDiv(lval, rval);
+                bool fltOp = false;
+                if (flat.ops[l] == V_AstType::FloatL || flat.ops[r] == V_AstType::FloatL) {
+                    fltOp = true;
                     
-                    case V_AstType::EQ: return builder->CreateFCmpOEQ(lval, rval);
-                    case V_AstType::NEQ: return builder->CreateFCmpONE(lval, rval);
-                    case V_AstType::GT: return builder->CreateFCmpOGT(lval, rval);
-                    case V_AstType::LT: return builder->CreateFCmpOLT(lval, rval);
-                    case V_AstType::GTE: return builder->CreateFCmpOGE(lval, rval);
-                    case V_AstType::LTE: return builder->CreateFCmpOLE(lval, rval);
+                    if (flat.ops[l] == V_AstType::ID) {
+                        if (typeTable[flat.symbol(l)]->type == V_AstType::Float64)
+                            rval = ConstantFP::get(Type::getDoubleTy(*context), flat.float_value(r));
+                    } else if (flat.ops[r] == V_AstType::ID) {
+                        if (typeTable[flat.symbol(r)]->type == V_AstType::Float64)
+                            lval = ConstantFP::get(Type::getDoubleTy(*context), flat.float_value(l));
+                    }
+                } else if (flat.ops[l] == V_AstType::ID && flat.ops[r] == V_AstType::ID) {
+                    V_AstType lvalType = typeTable[flat.symbol(l)]->type;
+                    V_AstType rvalType = typeTable[flat.symbol(r)]->type;
                     
-                    default: {}
-                }
-            } else {
-                switch (expr->type) {
-                    case V_AstType::Add: return builder->CreateAdd(lval, rval);
-                    case V_AstType::Sub: return builder->CreateSub(lval, rval);
-                    case V_AstType::Mul: return builder->CreateMul(lval, rval);
-                    case V_AstType::Div: return builder->CreateSDiv(lval, rval);
-                    case V_AstType::Mod: return builder->CreateSRem(lval, rval);
-                    
-                    case V_AstType::And: return builder->CreateAnd(lval, rval);
-                    case V_AstType::Or:  return builder->CreateOr(lval, rval);
-                    case V_AstType::Xor: return builder->CreateXor(lval, rval);
-                        
-                    case V_AstType::EQ: return builder->CreateICmpEQ(lval, rval);
-                    case V_AstType::NEQ: return builder->CreateICmpNE(lval, rval);
-                    case V_AstType::GT: return builder->CreateICmpSGT(lval, rval);
-                    case V_AstType::LT: return builder->CreateICmpSLT(lval, rval);
-                    case V_AstType::GTE: return builder->CreateICmpSGE(lval, rval);
-                    case V_AstType::LTE: return builder->CreateICmpSLE(lval, rval);
-                        
-                    default: {}
+                    if (lvalType == V_AstType::Float32 || lvalType == V_AstType::Float64) fltOp = true;
+                    if (rvalType == V_AstType::Float32 || rvalType == V_AstType::Float64) fltOp = true;
                 }
+                
+                values[i] = compileOperator(op, lval, rval, (type == V_AstType::Float32 || type == V_AstType::Float64) || fltOp);
             }
-        } break;
+        }
+    }
+    
+    return values[flat.root()];
+}
+
+Value *Compiler::compileOperator(V_AstType op, Value *lval, Value *rval, bool fltOp) {
+    if (fltOp) {
+        switch (op) {
+            case V_AstType::Add: return builder->CreateFAdd(lval, rval);
+            case V_AstType::Sub: return builder->CreateFSub(lval, rval);
+            case V_AstType::Mul: return builder->CreateFMul(lval, rval);
+            case V_AstType::Div: return builder->CreateFDiv(lval, rval);
+            
+            case V_AstType::EQ: return builder->CreateFCmpOEQ(lval, rval);
+            case V_AstType::NEQ: return builder->CreateFCmpONE(lval, rval);
+            case V_AstType::GT: return builder->CreateFCmpOGT(lval, rval);
+            case V_AstType::LT: return builder->CreateFCmpOLT(lval, rval);
+            case V_AstType::GTE: return builder->CreateFCmpOGE(lval, rval);
+            case V_AstType::LTE: return builder->CreateFCmpOLE(lval, rval);
+            
+            default: {}
+        }
+    } else {
+        // The interpreter's integers are unsigned
+        bool u = cflags.interpreter_ints;
         
-        default: {}
+        switch (op) {
+            case V_AstType::Add: return builder->CreateAdd(lval, rval);
+            case V_AstType::Sub: return builder->CreateSub(lval, rval);
+            case V_AstType::Mul: return builder->CreateMul(lval, rval);
+            case V_AstType::Div: return u ? builder->CreateUDiv(lval, rval) : builder->CreateSDiv(lval, rval);
+            case V_AstType::Mod: return u ? builder->CreateURem(lval, rval) : builder->CreateSRem(lval, rval);
+            
+            case V_AstType::And: return builder->CreateAnd(lval, rval);
+            case V_AstType::Or:  return builder->CreateOr(lval, rval);
+            case V_AstType::Xor: return builder->CreateXor(lval, rval);
+            case V_AstType::Lsh: return builder->CreateShl(lval, rval);
+            case V_AstType::Rsh: return u ? builder->CreateLShr(lval, rval) : builder->CreateAShr(lval, rval);
+                
+            case V_AstType::EQ: return builder->CreateICmpEQ(lval, rval);
+            case V_AstType::NEQ: return builder->CreateICmpNE(lval, rval);
+            case V_AstType::GT: return u ? builder->CreateICmpUGT(lval, rval) : builder->CreateICmpSGT(lval, rval);
+            case V_AstType::LT: return u ? builder->CreateICmpULT(lval, rval) : builder->CreateICmpSLT(lval, rval);
+            case V_AstType::GTE: return u ? builder->CreateICmpUGE(lval, rval) : builder->CreateICmpSGE(lval, rval);
+            case V_AstType::LTE: return u ? builder->CreateICmpULE(lval, rval) : builder->CreateICmpSLE(lval, rval);
+                
+            default: {}
+        }
     }
     
     return nullptr;
@@ -398,11 +471,11 @@ Type *Compiler::translateType(std::shared_ptr<AstDataType> dataType) {
     
     switch (dataType->type) {
         case V_AstType::Void: type = Type::getVoidTy(*context); break;
-        case V_AstType::Bool: type = Type::getInt32Ty(*context); break;
+        case V_AstType::Bool: type = cflags.interpreter_ints ? Type::getInt64Ty(*context) : Type::getInt32Ty(*context); break;
         case V_AstType::Char:
         case V_AstType::Int8: type = Type::getInt8Ty(*context); break;
         case V_AstType::Int16: type = Type::getInt16Ty(*context); break;
-        case V_AstType::Int32: type = Type::getInt32Ty(*context); break;
+        case V_AstType::Int32: type = cflags.interpreter_ints ? Type::getInt64Ty(*context) : Type::getInt32Ty(*context); break;
         case V_AstType::Int64: type = Type::getInt64Ty(*context); break;
         case V_AstType::Float32: type = Type::getFloatTy(*context); break;
         case V_AstType::Float64: type = Type::getDoubleTy(*context); break;
@@ -425,9 +498,43 @@ Type *Compiler::translateType(std::shared_ptr<AstDataType> dataType) {
     return type;
 }
 
-int Compiler::getStructIndex(std::string name, std::string member) {
-    std::string name2 = structVarTable[name];
-    if (name2 != "") name = name2;
+//
+// Casts a value to the type its user expects
+//
+// Some values are built with a looser type than the one they are used as: a
+// string literal is an i8* where strings are i8**, an allocation is an i8**
+// until it is stored into a structure or array variable, and an integer
+// literal is an i32 whatever it is stored into. The optimizer needs the types
+// to agree, so these are cast at the point of use.
+//
+Value *Compiler::castValue(Value *val, Type *type) {
+    Type *valType = val->getType();
+    if (valType == type) return val;
+    
+    if (valType->isPointerTy() && type->isPointerTy()) {
+        return builder->CreatePointerCast(val, type);
+    } else if (valType->isIntegerTy() && type->isIntegerTy()) {
+        return builder->CreateIntCast(val, type, !cflags.interpreter_ints);
+    }
+    return val;
+}
+
+StoreInst *Compiler::createStore(Value *val, Value *ptr) {
+    val = castValue(val, ptr->getType()->getPointerElementType());
+    return builder->CreateStore(val, ptr);
+}
+
+CallInst *Compiler::createCall(Function *callee, std::vector<Value *> args) {
+    FunctionType *type = callee->getFunctionType();
+    for (unsigned i = 0; i<args.size() && i<type->getNumParams(); i++) {
+        args[i] = castValue(args[i], type->getParamType(i));
+    }
+    return builder->CreateCall(callee, args);
+}
+
+int Compiler::getStructIndex(Symbol name, Symbol member) {
+    Symbol name2 = structVarTable[name];
+    if (!name2.empty()) name = name2;
     
     for (auto s : tree->structs) {
         if (s->name != name) continue;
@@ -8,36 +8,80 @@
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Target/TargetMachine.h"
 
 using namespace llvm;
 
+namespace llvm::orc {
+    class LLJIT;
+}
+
 #include <string>
 #include <map>
 #include <stack>
 #include <memory>
+#include <vector>
 
 #include <ast/ast.hpp>
+#include <ast/flat_expr.hpp>
 
 struct CFlags {
     std::string name;
     bool use_memgc = false;
+    
+    // Optimization: -O0 to -O3, with -Os favoring size at -O2
+    unsigned opt_level = 0;
+    bool opt_size = false;
+    bool time_passes = false;
+    
+    // The target CPU ("native" for the host) and extra features (-mattr)
+    std::string cpu = "generic";
+    std::string features = "";
+    
+    // Integers and booleans as the interpreter keeps them: 64 bits wide and
+    // unsigned. The native tier compiles with this, so that its code gives
+    // the same results as the code it replaces.
+    bool interpreter_ints = false;
 };
 
+// Builder.cpp
+bool runLinker(std::vector<std::string> args);
+
 class Compiler {
 public:
     explicit Compiler(std::shared_ptr<AstTree> tree, CFlags flags);
     void compile();
     void debug();
     void emitLLVM(std::string path);
-    void writeAssembly();
+    void optimize();
+    void writeAssembly(std::string path);
+    bool emitObject(std::string &object);
+    bool writeObject(std::string &path);
+    
+    // JIT.cpp
+    std::unique_ptr<orc::LLJIT> createJIT(std::vector<std::string> libraries, bool lazy);
+    int run(std::vector<std::string> libraries, std::vector<std::string> args, bool lazy);
+    
+    // Incremental.cpp
+    bool compileIncremental(std::vector<std::string> &objects);
+    void printIncrementalStats(std::ostream &out);
 protected:
+    void compileStructures();
+    TargetMachine *getTargetMachine();
+    void setTargetAttributes(Function *func);
     void compileStatement(std::shared_ptr<AstStatement> stmt);
     Value *compileValue(std::shared_ptr<AstExpression> expr, V_AstType dataType = V_AstType::Void, bool isAssign = false);
+    Value *compileFlatValue(const FlatExpr &flat, std::vector<Value *> &values, V_AstType dataType);
+    Value *compileOperator(V_AstType op, Value *lval, Value *rval, bool fltOp);
     Type *translateType(std::shared_ptr<AstDataType> dataType);
-    int getStructIndex(std::string name, std::string member);
+    Value *castValue(Value *val, Type *type);
+    StoreInst *createStore(Value *val, Value *ptr);
+    CallInst *createCall(Function *callee, std::vector<Value *> args);
+    int getStructIndex(Symbol name, Symbol member);
 
     // Function.cpp
     void compileFunction(std::shared_ptr<AstStatement> global);
+    Function *declareFunction(std::shared_ptr<AstFunction> astFunc);
     void compileExternFunction(std::shared_ptr<AstStatement> global);
     void compileFuncCallStatement(std::shared_ptr<AstStatement> stmt);
     void compileReturnStatement(std::shared_ptr<AstStatement> stmt);
@@ -60,17 +104,18 @@ private:
     std::unique_ptr<LLVMContext> context;
     std::unique_ptr<Module> mod;
     std::unique_ptr<IRBuilder<>> builder;
+    std::unique_ptr<TargetMachine> machine;
     Function *currentFunc;
     std::shared_ptr<AstDataType> currentFuncType;
     
     // The user-defined structure table
-    std::map<std::string, StructType*> structTable;
-    std::map<std::string, std::string> structVarTable;
-    std::map<std::string, std::vector<Type *>> structElementTypeTable;
+    SymbolMap<StructType*> structTable;
+    SymbolMap<Symbol> structVarTable;
+    SymbolMap<std::vector<Type *>> structElementTypeTable;
     
     // Symbol table
-    std::map<std::string, AllocaInst *> symtable;
-    std::map<std::string, std::shared_ptr<AstDataType>> typeTable;
+    SymbolMap<AllocaInst *> symtable;
+    SymbolMap<std::shared_ptr<AstDataType>> typeTable;
     
     // Block stack
     int blockCount = 0;
@@ -78,5 +123,19 @@ private:
     std::stack<BasicBlock *> continueStack;
     std::stack<BasicBlock *> logicalAndStack;
     std::stack<BasicBlock *> logicalOrStack;
+    
+    // Scratch space for compileFlatValue, reused from one expression to the
+    // next. A call inside an expression compiles its arguments while the outer
+    // expression is still being compiled, so there is one level per depth.
+    struct FlatScratch {
+        FlatExpr flat;
+        std::vector<Value *> values;
+    };
+    std::vector<std::unique_ptr<FlatScratch>> flatScratch;
+    size_t flatDepth = 0;
+    
+    // Incremental build counts
+    int reusedCount = 0;
+    int compiledCount = 0;
 };
 
@@ -37,6 +37,7 @@ void Compiler::compileIfStatement(std::shared_ptr<AstStatement> stmt) {
         compileStatement(stmt2);
         if (stmt2->type == V_AstType::Return) branchEnd = false;
         if (stmt2->type == V_AstType::Break) branchEnd = false;
+        if (stmt2->type == V_AstType::Continue) branchEnd = false;
     }
     if (branchEnd) builder->CreateBr(endBlock);
     
@@ -47,6 +48,7 @@ void Compiler::compileIfStatement(std::shared_ptr<AstStatement> stmt) {
         compileStatement(stmt2);
         if (stmt2->type == V_AstType::Return) branchEnd = false;
         if (stmt2->type == V_AstType::Break) branchEnd = false;
+        if (stmt2->type == V_AstType::Continue) branchEnd = false;
     }
     if (branchEnd) builder->CreateBr(endBlock);
     
@@ -137,11 +139,11 @@ void Compiler::compileForStatement(std::shared_ptr<AstStatement> stmt) {
     continueStack.push(loopCmp);
     
     // Create the induction variable and back up the symbol tables
-    std::map<std::string, AllocaInst *> symtableOld = symtable;
-    std::map<std::string, std::shared_ptr<AstDataType>> typeTableOld = typeTable;
+    SymbolMap<AllocaInst *> symtableOld = symtable;
+    SymbolMap<std::shared_ptr<AstDataType>> typeTableOld = typeTable;
     Type *data_type = translateType(loop->data_type);
     
-    std::string indexName = loop->index->value;
+    Symbol indexName = loop->index->value;
     AllocaInst *indexVar = builder->CreateAlloca(data_type);
     symtable[indexName] = indexVar;
     typeTable[indexName] = loop->data_type;
@@ -209,11 +211,11 @@ void Compiler::compileForAllStatement(std::shared_ptr<AstStatement> stmt) {
     //
     // Get the structure type for the array- will be needed later on
     //
-    std::string arrayName = loop->array->value;
-    std::string indexName = loop->index->value;
+    Symbol arrayName = loop->array->value;
+    Symbol indexName = loop->index->value;
     Type *indexType = translateType(loop->data_type);
     
-    std::string strTypeName = structVarTable[arrayName];
+    Symbol strTypeName = structVarTable[arrayName];
     StructType *strType = structTable[strTypeName];             //struct
     Type *elementType = structElementTypeTable[strTypeName][0];     //*i32
     Type *sizeType = structElementTypeTable[strTypeName][1];        //i32
@@ -221,8 +223,8 @@ void Compiler::compileForAllStatement(std::shared_ptr<AstStatement> stmt) {
     ///
     // Create the induction variable, the max-size variable, and the element variables
     //
-    std::map<std::string, AllocaInst *> symtableOld = symtable;
-    std::map<std::string, std::shared_ptr<AstDataType>> typeTableOld = typeTable;
+    SymbolMap<AllocaInst *> symtableOld = symtable;
+    SymbolMap<std::shared_ptr<AstDataType>> typeTableOld = typeTable;
     
     // The induction variable
     AllocaInst *indexVar = builder->CreateAlloca(indexType);
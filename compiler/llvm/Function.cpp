@@ -16,28 +16,11 @@ void Compiler::compileFunction(std::shared_ptr<AstStatement> global) {
     structVarTable.clear();
     
     std::shared_ptr<AstFunction> astFunc = std::static_pointer_cast<AstFunction>(global);
-
     std::vector<Var> astVarArgs = astFunc->args;
-    FunctionType *FT;
-    Type *funcType = translateType(astFunc->data_type);
     currentFuncType = astFunc->data_type;
     
-    if (astVarArgs.size() == 0) {
-        FT = FunctionType::get(funcType, false);
-    } else {
-        std::vector<Type *> args;
-        for (auto var : astVarArgs) {
-            Type *type = translateType(var.type);
-            if (var.type->type == V_AstType::Struct) {
-                type = PointerType::getUnqual(type);
-            }
-            args.push_back(type);
-        }
-        
-        FT = FunctionType::get(funcType, args, false);
-    }
-    
-    Function *func = Function::Create(FT, Function::ExternalLinkage, astFunc->name, mod.get());
+    Function *func = declareFunction(astFunc);
+    setTargetAttributes(func);
     currentFunc = func;
 
     BasicBlock *mainBlock = BasicBlock::Create(*context, "entry", func);
@@ -72,6 +55,44 @@ void Compiler::compileFunction(std::shared_ptr<AstStatement> global) {
     }
 }
 
+//
+// Creates the prototype of a function, without its body
+//
+Function *Compiler::declareFunction(std::shared_ptr<AstFunction> astFunc) {
+    std::vector<Var> astVarArgs = astFunc->args;
+    FunctionType *FT;
+    Type *funcType = translateType(astFunc->data_type);
+    
+    // A structure is returned as the pointer to it
+    if (astFunc->data_type && astFunc->data_type->type == V_AstType::Struct) {
+        funcType = PointerType::getUnqual(funcType);
+    }
+    
+    if (astVarArgs.size() == 0) {
+        FT = FunctionType::get(funcType, false);
+    } else {
+        std::vector<Type *> args;
+        for (auto var : astVarArgs) {
+            // Structures are passed as the address of the caller's
+            // variable, which holds the pointer to the structure
+            Type *type = translateType(var.type);
+            if (var.type->type == V_AstType::Struct) {
+                type = PointerType::getUnqual(PointerType::getUnqual(type));
+            }
+            args.push_back(type);
+        }
+        
+        FT = FunctionType::get(funcType, args, false);
+    }
+    
+    // A declaration from another file may already stand in for this function
+    Function *func = mod->getFunction(astFunc->name.str());
+    if (!func || !func->isDeclaration() || func->getFunctionType() != FT) {
+        func = Function::Create(FT, Function::ExternalLinkage, astFunc->name.str(), mod.get());
+    }
+    return func;
+}
+
 //
 // Compiles an extern function declaration
 //
@@ -95,7 +116,7 @@ void Compiler::compileExternFunction(std::shared_ptr<AstStatement> global) {
         FT = FunctionType::get(retType, args, astFunc->varargs);
     }
     
-    Function::Create(FT, Function::ExternalLinkage, astFunc->name, mod.get());
+    Function::Create(FT, Function::ExternalLinkage, astFunc->name.str(), mod.get());
 }
 
 //
@@ -118,9 +139,9 @@ void Compiler::compileFuncCallStatement(std::shared_ptr<AstStatement> stmt) {
         args.push_back(val);
     }
     
-    Function *callee = mod->getFunction(fc->name);
+    Function *callee = mod->getFunction(fc->name.str());
     if (!callee) std::cerr << "Invalid function call statement: " << fc->name << std::endl;
-    builder->CreateCall(callee, args);
+    createCall(callee, args);
 }
 
 //
@@ -135,10 +156,10 @@ void Compiler::compileReturnStatement(std::shared_ptr<AstStatement> stmt) {
         if (currentFuncType->type == V_AstType::Struct) {
             std::shared_ptr<AstStructType> sType = std::static_pointer_cast<AstStructType>(currentFuncType);
             StructType *type = structTable[sType->name];
-            Value *ld = builder->CreateLoad(type, val);
+            Value *ld = builder->CreateLoad(PointerType::getUnqual(type), val);
             builder->CreateRet(ld);
         } else {
-            builder->CreateRet(val);
+            builder->CreateRet(castValue(val, currentFunc->getReturnType()));
         }
     } else {
         builder->CreateRetVoid();
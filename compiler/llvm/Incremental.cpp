@@ -0,0 +1,177 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#include <iostream>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <unistd.h>
+
+#include <ast/ast_binary.hpp>
+#include <parser/build_cache.hpp>
+
+#include "Compiler.hpp"
+
+//
+// Incremental builds
+//
+// Each function is compiled into an object file of its own. Its module only
+// declares what the function refers to. The object is cached on disk under a
+// key made from the function and from the declarations it depends on: the
+// prototypes of the functions it calls, and the layouts of the structures
+// when it uses any. A change to a function body only changes the key of that
+// function, so only that function is compiled again.
+//
+// The cache lives in $OBJ_CACHE_DIR, or by default in obj-cache under the
+// user's cache directory. Without a directory private to the user, the
+// program is built as a whole instead.
+//
+
+//
+// The text a call site depends on: the prototype of a function, without its
+// body. A function and an extern with the same prototype are compiled
+// differently, so they are told apart.
+//
+static std::string prototype(std::shared_ptr<AstStatement> global, std::vector<std::string> *names) {
+    if (global->type == V_AstType::ExternFunc) {
+        return "E" + AstBinary::write(global, names);
+    }
+
+    auto func = std::static_pointer_cast<AstFunction>(global);
+    auto proto = AstContext::make<AstExternFunction>(func->name);
+    proto->args = func->args;
+    proto->data_type = func->data_type;
+    return "F" + AstBinary::write(proto, names);
+}
+
+static Symbol declared_name(std::shared_ptr<AstStatement> global) {
+    if (global->type == V_AstType::ExternFunc) {
+        return std::static_pointer_cast<AstExternFunction>(global)->name;
+    }
+    return std::static_pointer_cast<AstFunction>(global)->name;
+}
+
+//
+// Returns false if the tree cannot be built one function at a time; the
+// caller should then build the whole module with a new compiler
+//
+bool Compiler::compileIncremental(std::vector<std::string> &objects) {
+    // Functions that share a name are renamed when they are in one module,
+    // but would clash as separate objects
+    std::unordered_set<Symbol> defined;
+    for (auto const &global : tree->block->getBlock()) {
+        if (global->type != V_AstType::Func) continue;
+        if (!defined.insert(declared_name(global)).second) return false;
+    }
+
+    TargetMachine *machine = getTargetMachine();
+    if (!machine) return false;
+
+    // The objects are linked as they are, so they must not come from a
+    // directory that someone else could have written them to
+    std::string dir = BuildCache::private_dir("OBJ_CACHE_DIR", "obj-cache");
+    if (dir.empty()) return false;
+
+    uint64_t seed = BuildCache::fnv(BuildCache::compiler_hash(), machine->getTargetTriple().str());
+    seed = BuildCache::fnv(seed, &cflags.use_memgc, sizeof(cflags.use_memgc));
+    seed = BuildCache::fnv(seed, &cflags.opt_level, sizeof(cflags.opt_level));
+    seed = BuildCache::fnv(seed, &cflags.opt_size, sizeof(cflags.opt_size));
+    seed = BuildCache::fnv(seed, machine->getTargetCPU().str());
+    seed = BuildCache::fnv(seed, machine->getTargetFeatureString().str());
+
+    compileStructures();
+
+    // Every structure layout, for the functions that use any of them
+    std::unordered_set<std::string> structNames;
+    uint64_t structHash = BuildCache::fnv_offset;
+    for (auto const &s : tree->structs) {
+        structNames.insert(s->name.str());
+        structHash = BuildCache::fnv(structHash, AstBinary::write(s));
+    }
+
+    // The declarations made so far, in order, and the prototypes of each
+    // name. An extern may be declared more than once.
+    std::vector<std::shared_ptr<AstStatement>> declared;
+    std::unordered_map<std::string, std::string> prototypes;
+    std::unordered_map<std::string, bool> prototypeStructs;
+
+    for (auto const &global : tree->block->getBlock()) {
+        if (global->type != V_AstType::Func && global->type != V_AstType::ExternFunc) continue;
+
+        if (global->type == V_AstType::Func) {
+            std::vector<std::string> names;
+            std::string body = AstBinary::write(global, &names);
+
+            // Structure declarations call the allocator implicitly
+            names.push_back("malloc");
+            names.push_back("gc_alloc");
+
+            uint64_t key = BuildCache::fnv(seed, body);
+            bool usesStructs = false;
+
+            std::unordered_set<std::string> refs;
+            for (auto const &name : names) {
+                if (!refs.insert(name).second) continue;
+                if (structNames.count(name)) usesStructs = true;
+
+                auto found = prototypes.find(name);
+                if (found == prototypes.end()) continue;
+
+                key = BuildCache::fnv(key, name);
+                key = BuildCache::fnv(key, found->second);
+                if (prototypeStructs[name]) usesStructs = true;
+            }
+
+            if (usesStructs) key = BuildCache::fnv(key, &structHash, sizeof(structHash));
+
+            std::string path = BuildCache::entry_path(dir, key, ".o");
+            if (access(path.c_str(), R_OK) == 0) {
+                ++reusedCount;
+            } else {
+                mod = std::make_unique<Module>(cflags.name, *context);
+
+                for (auto const &decl : declared) {
+                    if (!refs.count(declared_name(decl).str())) continue;
+
+                    if (decl->type == V_AstType::ExternFunc) {
+                        compileExternFunction(decl);
+                    } else {
+                        declareFunction(std::static_pointer_cast<AstFunction>(decl));
+                    }
+                }
+
+                compileFunction(global);
+                optimize();
+
+                std::string object;
+                if (!emitObject(object)) return false;
+                if (!BuildCache::write_atomic(path, object)) {
+                    std::cerr << "Error: Unable to write " << path << "." << std::endl;
+                    return false;
+                }
+                ++compiledCount;
+            }
+
+            objects.push_back(path);
+        }
+
+        // Later functions may call this one
+        std::vector<std::string> names;
+        std::string name = declared_name(global).str();
+        prototypes[name] += prototype(global, &names);
+        for (auto const &n : names) {
+            if (structNames.count(n)) prototypeStructs[name] = true;
+        }
+        declared.push_back(global);
+    }
+
+    return true;
+}
+
+void Compiler::printIncrementalStats(std::ostream &out) {
+    out << "Incremental build:" << std::endl;
+    out << "    reused:   " << reusedCount << std::endl;
+    out << "    compiled: " << compiledCount << std::endl;
+}
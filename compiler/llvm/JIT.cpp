@@ -0,0 +1,150 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#include <iostream>
+
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
+#include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/TargetSelect.h"
+
+#include "Compiler.hpp"
+
+//
+// Running in process
+//
+// The module is handed to an ORC JIT instead of being written out and linked.
+// The runtime libraries the linker would have used are loaded into the JIT:
+// static archives and objects are linked in as they are needed, and shared
+// libraries are opened. Anything else, such as the C library, is looked up in
+// the compiler's own process.
+//
+// With lazy set, each function is only compiled the first time it is called.
+//
+
+static bool reportError(Error error) {
+    if (!error) return false;
+    std::cerr << "Error: " << toString(std::move(error)) << std::endl;
+    return true;
+}
+
+static bool loadLibrary(orc::LLJIT &jit, const std::string &path) {
+    orc::JITDylib &dylib = jit.getMainJITDylib();
+    StringRef name(path);
+
+    if (name.endswith(".a")) {
+        auto generator = orc::StaticLibraryDefinitionGenerator::Load(jit.getObjLinkingLayer(), path.c_str());
+        if (!generator) return !reportError(generator.takeError());
+        dylib.addGenerator(std::move(*generator));
+    } else if (name.endswith(".o")) {
+        auto buffer = MemoryBuffer::getFile(path);
+        if (!buffer) {
+            std::cerr << "Error: Unable to open " << path << "." << std::endl;
+            return false;
+        }
+        if (reportError(jit.addObjectFile(std::move(*buffer)))) return false;
+    } else {
+        auto prefix = jit.getDataLayout().getGlobalPrefix();
+        auto generator = orc::DynamicLibrarySearchGenerator::Load(path.c_str(), prefix);
+        if (!generator) return !reportError(generator.takeError());
+        dylib.addGenerator(std::move(*generator));
+    }
+
+    return true;
+}
+
+//
+// Creates a JIT holding the module. The compiler cannot be used to compile
+// anything else afterwards. Returns null on error.
+//
+std::unique_ptr<orc::LLJIT> Compiler::createJIT(std::vector<std::string> libraries, bool lazy) {
+    LLVMInitializeX86TargetInfo();
+    LLVMInitializeX86Target();
+    LLVMInitializeX86TargetMC();
+    LLVMInitializeX86AsmPrinter();
+
+    auto target = orc::JITTargetMachineBuilder::detectHost();
+    if (!target) {
+        reportError(target.takeError());
+        return nullptr;
+    }
+
+    switch (cflags.opt_level) {
+        case 0: target->setCodeGenOptLevel(CodeGenOpt::None); break;
+        case 1: target->setCodeGenOptLevel(CodeGenOpt::Less); break;
+        case 2: target->setCodeGenOptLevel(CodeGenOpt::Default); break;
+        default: target->setCodeGenOptLevel(CodeGenOpt::Aggressive);
+    }
+
+    // A lazy JIT is an LLJIT that only compiles a function when it is called
+    std::unique_ptr<orc::LLJIT> jit;
+    if (lazy) {
+        auto created = orc::LLLazyJITBuilder().setJITTargetMachineBuilder(std::move(*target)).create();
+        if (!created) {
+            reportError(created.takeError());
+            return nullptr;
+        }
+        jit = std::move(*created);
+    } else {
+        auto created = orc::LLJITBuilder().setJITTargetMachineBuilder(std::move(*target)).create();
+        if (!created) {
+            reportError(created.takeError());
+            return nullptr;
+        }
+        jit = std::move(*created);
+    }
+
+    auto process = orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(jit->getDataLayout().getGlobalPrefix());
+    if (!process) {
+        reportError(process.takeError());
+        return nullptr;
+    }
+
+    for (auto const &library : libraries) {
+        if (!loadLibrary(*jit, library)) return nullptr;
+    }
+
+    // The process comes last, so the runtime libraries take precedence
+    jit->getMainJITDylib().addGenerator(std::move(*process));
+
+    // The JIT takes the module and its context. The builder refers to the
+    // context, so it goes first.
+    mod->setDataLayout(jit->getDataLayout());
+    mod->setTargetTriple(jit->getTargetTriple().str());
+    builder.reset();
+
+    orc::ThreadSafeModule module(std::move(mod), std::move(context));
+    if (lazy) {
+        auto lazyJit = static_cast<orc::LLLazyJIT *>(jit.get());
+        if (reportError(lazyJit->addLazyIRModule(std::move(module)))) return nullptr;
+    } else {
+        if (reportError(jit->addIRModule(std::move(module)))) return nullptr;
+    }
+
+    if (reportError(jit->initialize(jit->getMainJITDylib()))) return nullptr;
+    return jit;
+}
+
+int Compiler::run(std::vector<std::string> libraries, std::vector<std::string> args, bool lazy) {
+    auto jit = createJIT(libraries, lazy);
+    if (!jit) return 1;
+
+    auto mainSymbol = jit->lookup("main");
+    if (!mainSymbol) {
+        reportError(mainSymbol.takeError());
+        return 1;
+    }
+
+    std::vector<char *> argv;
+    for (auto &arg : args) argv.push_back(const_cast<char *>(arg.c_str()));
+    argv.push_back(nullptr);
+
+    auto mainFunc = (int (*)(int, char **))mainSymbol->getAddress();
+    int result = mainFunc(args.size(), argv.data());
+
+    if (reportError(jit->deinitialize(jit->getMainJITDylib()))) return 1;
+    return result;
+}
@@ -0,0 +1,254 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#include <iostream>
+
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+
+#include "Tier.hpp"
+
+JITTier::JITTier(std::shared_ptr<AstTree> tree, CFlags flags, std::vector<std::string> libraries) {
+    this->tree = tree;
+    this->cflags = flags;
+    this->cflags.interpreter_ints = true;
+    this->libraries = libraries;
+    
+    for (auto const &global : tree->block->getBlock()) {
+        if (global->type != V_AstType::Func) continue;
+        auto func = std::static_pointer_cast<AstFunction>(global);
+        functions[func->name] = func;
+    }
+    
+    checkFunctions();
+}
+
+JITTier::~JITTier() {
+    if (jit) consumeError(jit->deinitialize(jit->getMainJITDylib()));
+}
+
+// The interpreter keeps these in an unsigned 64-bit int, and the tier compiles
+// them the same way
+static bool isIntType(std::shared_ptr<AstDataType> dataType) {
+    if (!dataType) return false;
+    return dataType->type == V_AstType::Int32 || dataType->type == V_AstType::Bool;
+}
+
+//
+// A function can be compiled if its own code can, and every function it calls
+// can be too. Functions that call each other depend on one another, so each
+// function is first checked on its own, and then the ones that call a function
+// that cannot be compiled are taken out until none are left to take out.
+//
+void JITTier::checkFunctions() {
+    SymbolMap<std::unordered_set<Symbol>> calls;
+    for (auto const &entry : functions) {
+        auto &called = calls[entry.first];
+        if (canCompile(entry.second, called)) compilable.insert(entry.first);
+    }
+    
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto it = compilable.begin(); it != compilable.end();) {
+            bool result = true;
+            for (auto const &name : calls[*it]) {
+                if (compilable.find(name) == compilable.end()) result = false;
+            }
+            
+            if (result) {
+                ++it;
+            } else {
+                it = compilable.erase(it);
+                changed = true;
+            }
+        }
+    }
+}
+
+bool JITTier::canCompile(Symbol name) {
+    return compilable.find(name) != compilable.end();
+}
+
+// Checks a function without the functions it calls, which are added to calls
+bool JITTier::canCompile(std::shared_ptr<AstFunction> func, std::unordered_set<Symbol> &calls) {
+    // Arguments are passed in registers
+    if (func->args.size() > 6) return false;
+    for (auto const &arg : func->args) {
+        if (!isIntType(arg.type)) return false;
+    }
+    
+    auto dataType = func->data_type;
+    if (dataType && dataType->type != V_AstType::Void && !isIntType(dataType)) return false;
+    
+    // The interpreter does not leave a function when it returns, so only a
+    // final return behaves the same
+    auto block = func->block->getBlock();
+    for (size_t i = 0; i+1<block.size(); i++) {
+        if (block[i]->type == V_AstType::Return) return false;
+    }
+    
+    return canCompile(func->block, calls);
+}
+
+bool JITTier::canCompile(std::shared_ptr<AstBlock> block, std::unordered_set<Symbol> &calls) {
+    if (!block) return true;
+    
+    for (auto const &stmt : block->getBlock()) {
+        switch (stmt->type) {
+            case V_AstType::VarDec: {
+                auto vd = std::static_pointer_cast<AstVarDec>(stmt);
+                if (!isIntType(vd->data_type)) return false;
+            } break;
+            
+            case V_AstType::ExprStmt:
+            case V_AstType::Return: {
+                if (stmt->hasExpression() && !canCompile(stmt->expression, calls)) return false;
+            } break;
+            
+            case V_AstType::FuncCallStmt: {
+                auto fc = std::static_pointer_cast<AstFuncCallStmt>(stmt);
+                if (functions.find(fc->name) == functions.end()) return false;
+                calls.insert(fc->name);
+                if (!canCompile(fc->expression, calls)) return false;
+            } break;
+            
+            case V_AstType::If: {
+                auto cond = std::static_pointer_cast<AstIfStmt>(stmt);
+                if (!canCompile(cond->expression, calls)) return false;
+                if (!canCompile(cond->true_block, calls) || !canCompile(cond->false_block, calls)) return false;
+            } break;
+            
+            case V_AstType::While: {
+                auto loop = std::static_pointer_cast<AstWhileStmt>(stmt);
+                if (!canCompile(loop->expression, calls) || !canCompile(loop->block, calls)) return false;
+            } break;
+            
+            default: return false;
+        }
+    }
+    
+    return true;
+}
+
+bool JITTier::canCompile(std::shared_ptr<AstExpression> expr, std::unordered_set<Symbol> &calls) {
+    if (!expr) return true;
+    
+    switch (expr->type) {
+        case V_AstType::IntL:
+        case V_AstType::ID: return true;
+        
+        case V_AstType::ExprList: {
+            auto list = std::static_pointer_cast<AstExprList>(expr);
+            for (auto const &item : list->list) {
+                if (!canCompile(item, calls)) return false;
+            }
+            return true;
+        }
+        
+        case V_AstType::Neg: {
+            auto op = std::static_pointer_cast<AstNegOp>(expr);
+            return canCompile(op->value, calls);
+        }
+        
+        case V_AstType::FuncCallExpr: {
+            auto fc = std::static_pointer_cast<AstFuncCallExpr>(expr);
+            if (functions.find(fc->name) == functions.end()) return false;
+            calls.insert(fc->name);
+            return canCompile(fc->args, calls);
+        }
+        
+        case V_AstType::Assign:
+        case V_AstType::Add:
+        case V_AstType::Sub:
+        case V_AstType::Mul:
+        case V_AstType::Div:
+        case V_AstType::Mod:
+        case V_AstType::And:
+        case V_AstType::Or:
+        case V_AstType::Xor:
+        case V_AstType::Lsh:
+        case V_AstType::Rsh:
+        case V_AstType::EQ:
+        case V_AstType::NEQ:
+        case V_AstType::GT:
+        case V_AstType::LT:
+        case V_AstType::GTE:
+        case V_AstType::LTE: {
+            auto op = std::static_pointer_cast<AstBinaryOp>(expr);
+            return canCompile(op->lval, calls) && canCompile(op->rval, calls);
+        }
+        
+        default: {}
+    }
+    
+    return false;
+}
+
+//
+// The module is built the first time a function gets hot. It holds every
+// function that can be compiled, which includes everything those functions
+// call, and nothing else. The JIT is lazy, so machine code is only generated
+// for the functions that are called.
+//
+bool JITTier::compile(std::shared_ptr<AstFunction> func) {
+    if (failed || !canCompile(func->name)) return false;
+    
+    if (!jit) {
+        auto subset = std::make_shared<AstTree>(tree->file);
+        for (auto const &global : tree->block->getBlock()) {
+            if (global->type == V_AstType::Func) {
+                auto func2 = std::static_pointer_cast<AstFunction>(global);
+                if (!canCompile(func2->name)) continue;
+            }
+            subset->addGlobalStatement(global);
+        }
+        
+        auto compiler = std::make_unique<Compiler>(subset, cflags);
+        compiler->compile();
+        compiler->optimize();
+        
+        jit = compiler->createJIT(libraries, true);
+        if (!jit) {
+            failed = true;
+            return false;
+        }
+    }
+    
+    auto symbol = jit->lookup(func->name.str());
+    if (!symbol) {
+        consumeError(symbol.takeError());
+        return false;
+    }
+    
+    addresses[func.get()] = symbol->getAddress();
+    return true;
+}
+
+//
+// The integers are compiled 64 bits wide, so they are passed and returned in
+// full, as the interpreter has them
+//
+vm_arg_list JITTier::call(std::shared_ptr<AstFunction> func, const std::vector<vm_arg_list> &args) {
+    uint64_t address = addresses[func.get()];
+    
+    uint64_t a[6] = {0};
+    for (size_t i = 0; i<args.size() && i<6; i++) {
+        a[i] = *std::get_if<uint64_t>(&args[i]);
+    }
+    
+    uint64_t result = 0;
+    switch (args.size()) {
+        case 0: result = ((uint64_t (*)())address)(); break;
+        case 1: result = ((uint64_t (*)(uint64_t))address)(a[0]); break;
+        case 2: result = ((uint64_t (*)(uint64_t, uint64_t))address)(a[0], a[1]); break;
+        case 3: result = ((uint64_t (*)(uint64_t, uint64_t, uint64_t))address)(a[0], a[1], a[2]); break;
+        case 4: result = ((uint64_t (*)(uint64_t, uint64_t, uint64_t, uint64_t))address)(a[0], a[1], a[2], a[3]); break;
+        case 5: result = ((uint64_t (*)(uint64_t, uint64_t, uint64_t, uint64_t, uint64_t))address)(a[0], a[1], a[2], a[3], a[4]); break;
+        default: result = ((uint64_t (*)(uint64_t, uint64_t, uint64_t, uint64_t, uint64_t, uint64_t))address)(a[0], a[1], a[2], a[3], a[4], a[5]);
+    }
+    
+    if (!isIntType(func->data_type)) return (uint64_t)0;
+    return result;
+}
@@ -0,0 +1,53 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#pragma once
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include <intr/interpreter.hpp>
+
+#include "Compiler.hpp"
+
+//
+// The native tier of the interpreter
+//
+// The interpreter runs the tree as the parser left it, while the compiler
+// needs the tree after the midend, so the tier is given a tree of its own.
+// The functions are found in it by name.
+//
+// The compiler and the interpreter do not agree on everything the language
+// allows, printing most of all. A function is only compiled if it, and every
+// function it calls, sticks to integer variables, arithmetic, conditions,
+// loops and calls, so that running it natively gives the same result. The
+// integers are compiled as the interpreter keeps them, 64 bits wide and
+// unsigned, so they overflow, compare and divide the same way.
+//
+class JITTier : public NativeTier {
+public:
+    explicit JITTier(std::shared_ptr<AstTree> tree, CFlags flags, std::vector<std::string> libraries);
+    ~JITTier();
+    bool compile(std::shared_ptr<AstFunction> func) override;
+    vm_arg_list call(std::shared_ptr<AstFunction> func, const std::vector<vm_arg_list> &args) override;
+protected:
+    void checkFunctions();
+    bool canCompile(Symbol name);
+    bool canCompile(std::shared_ptr<AstFunction> func, std::unordered_set<Symbol> &calls);
+    bool canCompile(std::shared_ptr<AstBlock> block, std::unordered_set<Symbol> &calls);
+    bool canCompile(std::shared_ptr<AstExpression> expr, std::unordered_set<Symbol> &calls);
+private:
+    std::shared_ptr<AstTree> tree;
+    SymbolMap<std::shared_ptr<AstFunction>> functions;
+    
+    // The functions that can be compiled, along with all they call
+    std::unordered_set<Symbol> compilable;
+    CFlags cflags;
+    std::vector<std::string> libraries;
+    
+    std::unique_ptr<orc::LLJIT> jit;
+    bool failed = false;
+    std::unordered_map<AstFunction *, uint64_t> addresses;
+};
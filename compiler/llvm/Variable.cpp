@@ -40,7 +40,7 @@ void Compiler::compileStructDeclaration(std::shared_ptr<AstStatement> stmt) {
     Function *callee = mod->getFunction(malloc_call);
     if (!callee) std::cerr << "Unable to allocate structure." << std::endl;
     Value *ptr = builder->CreateCall(callee, args);
-    builder->CreateStore(ptr, var);
+    createStore(ptr, var);
     
     // Init the elements
     if (!sd->no_init) {
@@ -52,7 +52,7 @@ void Compiler::compileStructDeclaration(std::shared_ptr<AstStatement> stmt) {
             Value *defaultVal = compileValue(defaultExpr);
             
             Value *ep = builder->CreateStructGEP(type1, ptr, index);
-            builder->CreateStore(defaultVal, ep);
+            createStore(defaultVal, ep);
             
             ++index;
        }
@@ -65,7 +65,7 @@ Value *Compiler::compileStructAccess(std::shared_ptr<AstExpression> expr, bool i
     Value *ptr = symtable[sa->var];
     int pos = getStructIndex(sa->var, sa->member);
     
-    std::string strTypeName = structVarTable[sa->var];
+    Symbol strTypeName = structVarTable[sa->var];
     StructType *strType = structTable[strTypeName];
     Type *elementType = structElementTypeTable[strTypeName][pos];
     
@@ -13,7 +13,9 @@ AstMidend::AstMidend(std::shared_ptr<AstTree> tree) {
 // Called to run any midend
 //
 void AstMidend::run() {
+    AstContext::Scope scope(tree->context);
     it_process_block(tree->block);
+    finish();
 }
 
 void AstMidend::it_process_block(std::shared_ptr<AstBlock> block) {
@@ -152,7 +154,12 @@ void AstMidend::it_process_expression(std::shared_ptr<AstExpression> &expr, std:
     // Continue processing
     switch (expr->type) {
         // Operators
-        case V_AstType::Neg: break;
+        case V_AstType::Neg: {
+            auto neg_op = std::static_pointer_cast<AstNegOp>(expr);
+            it_process_expression(neg_op->value, block);
+            std::shared_ptr<AstExpression> expr2 = process_neg_op(neg_op, block);
+            if (expr2) expr = expr2;
+        } break;
         
         case V_AstType::Assign:
         case V_AstType::Add:
@@ -235,14 +242,30 @@ void AstMidend::it_process_expression(std::shared_ptr<AstExpression> &expr, std:
         case V_AstType::FloatL: break;
         case V_AstType::StringL: break;
         case V_AstType::ID: break;
-        case V_AstType::ArrayAccess: break;
-        case V_AstType::StructAccess: break;
+        
+        case V_AstType::StructAccess: {
+            auto sa = std::static_pointer_cast<AstStructAccess>(expr);
+            it_process_expression(sa->access_expression, block);
+        } break;
+        
+        case V_AstType::ArrayAccess: {
+            auto acc = std::static_pointer_cast<AstArrayAccess>(expr);
+            it_process_expression(acc->index, block);
+        } break;
         
         // Expression list
-        case V_AstType::ExprList: break;
+        case V_AstType::ExprList: {
+            auto list = std::static_pointer_cast<AstExprList>(expr);
+            for (auto &item : list->list) it_process_expression(item, block);
+            std::shared_ptr<AstExpression> expr2 = process_expression_list(list, block);
+            if (expr2) expr = expr2;
+        } break;
         
         // Function call expressions
-        case V_AstType::FuncCallExpr: break;
+        case V_AstType::FuncCallExpr: {
+            auto fc = std::static_pointer_cast<AstFuncCallExpr>(expr);
+            it_process_expression(fc->args, block);
+        } break;
         
         // Normally, we shouldn't reach this point
     }
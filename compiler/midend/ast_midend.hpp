@@ -19,6 +19,9 @@ public:
     //
     // Public-facing processing statements
     //
+    // Called once the whole tree has been walked
+    virtual void finish() {}
+    
     // Blocks
     virtual void process_block(std::shared_ptr<AstBlock> block) {}
     
@@ -69,10 +72,11 @@ public:
     virtual std::shared_ptr<AstExpression> process_logical_or_op(std::shared_ptr<AstLogicalOrOp> expr, std::shared_ptr<AstBlock> block)
         { return nullptr; }
     // TODO: Finish
+protected:
+    void it_process_expression(std::shared_ptr<AstExpression> &expr, std::shared_ptr<AstBlock> block);
 private:
     // Functions
     void it_process_block(std::shared_ptr<AstBlock> block);
     void it_process_statement(std::shared_ptr<AstStatement> stmt, std::shared_ptr<AstBlock> block, int pos);
-    void it_process_expression(std::shared_ptr<AstExpression> &expr, std::shared_ptr<AstBlock> block);
 };
 
@@ -0,0 +1,244 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#include <cmath>
+#include <cstdint>
+
+#include "constant_fold_midend.hpp"
+
+//
+// Whether a value fits in a signed integer of the given width
+//
+static bool fits(int64_t value, int size) {
+    if (size >= 64) return true;
+    int64_t max = (int64_t(1) << (size - 1)) - 1;
+    return value >= -max - 1 && value <= max;
+}
+
+// Whether a value is the same as an f32 and as an f64
+static bool is_f32(double value) {
+    return (double)(float)value == value;
+}
+
+static bool is_int(std::shared_ptr<AstExpression> expr, uint64_t value) {
+    if (expr->type != V_AstType::IntL) return false;
+    return std::static_pointer_cast<AstInt>(expr)->value == value;
+}
+
+//
+// The const tables
+//
+void ConstantFoldMidend::process_block(std::shared_ptr<AstBlock> block) {
+    for (auto table : { &block->globalConsts, &block->localConsts }) {
+        for (auto &element : *table) {
+            it_process_expression(element.second.second, block);
+        }
+    }
+}
+
+//
+// Called before the operands of an expression are folded
+//
+std::shared_ptr<AstExpression> ConstantFoldMidend::process_expression(std::shared_ptr<AstExpression> expr, std::shared_ptr<AstBlock> block) {
+    if (expr->type != V_AstType::FuncCallExpr) return nullptr;
+    
+    auto fc = std::static_pointer_cast<AstFuncCallExpr>(expr);
+    if (fc->name != "malloc" && fc->name != "gc_alloc") return nullptr;
+    if (!fc->args || fc->args->type != V_AstType::ExprList) return nullptr;
+    
+    auto args = std::static_pointer_cast<AstExprList>(fc->args);
+    if (!args->list.empty()) alloc_sizes.insert(args->list[0].get());
+    return nullptr;
+}
+
+std::shared_ptr<AstExpression> ConstantFoldMidend::process_binary_op(std::shared_ptr<AstBinaryOp> expr, std::shared_ptr<AstBlock> block) {
+    if (expr->type == V_AstType::Assign) return nullptr;
+    if (alloc_sizes.find(expr.get()) != alloc_sizes.end()) return nullptr;
+    
+    auto ltype = expr->lval->type;
+    auto rtype = expr->rval->type;
+    
+    if (ltype == V_AstType::IntL && rtype == V_AstType::IntL) return fold_int(expr);
+    if (ltype == V_AstType::FloatL && rtype == V_AstType::FloatL) return fold_float(expr);
+    if (ltype == V_AstType::StringL && (rtype == V_AstType::StringL || rtype == V_AstType::CharL)) {
+        return fold_string(expr);
+    }
+    return simplify(expr, block);
+}
+
+std::shared_ptr<AstExpression> ConstantFoldMidend::process_neg_op(std::shared_ptr<AstNegOp> expr, std::shared_ptr<AstBlock> block) {
+    if (expr->value->type == V_AstType::IntL) {
+        auto i = std::static_pointer_cast<AstInt>(expr->value);
+        int64_t value = (int64_t)i->value;
+        if (!fits(value, i->size) || value == INT64_MIN || !fits(-value, i->size)) return nullptr;
+        return AstContext::make<AstInt>((uint64_t)-value, i->size);
+    } else if (expr->value->type == V_AstType::FloatL) {
+        auto f = std::static_pointer_cast<AstFloat>(expr->value);
+        return AstContext::make<AstFloat>(-f->value);
+    }
+    return nullptr;
+}
+
+//
+// Integers
+//
+// The interpreters work on unsigned 64-bit values, and the compilers on
+// signed values of the literal's width. They agree as long as nothing
+// overflows, and nothing negative is divided or shifted right.
+//
+std::shared_ptr<AstExpression> ConstantFoldMidend::fold_int(std::shared_ptr<AstBinaryOp> expr) {
+    auto lval = std::static_pointer_cast<AstInt>(expr->lval);
+    auto rval = std::static_pointer_cast<AstInt>(expr->rval);
+    if (lval->size != rval->size) return nullptr;
+    
+    int size = lval->size;
+    int64_t x = (int64_t)lval->value;
+    int64_t y = (int64_t)rval->value;
+    if (!fits(x, size) || !fits(y, size)) return nullptr;
+    
+    int64_t result = 0;
+    switch (expr->type) {
+        case V_AstType::Add: if (__builtin_add_overflow(x, y, &result)) return nullptr; break;
+        case V_AstType::Sub: if (__builtin_sub_overflow(x, y, &result)) return nullptr; break;
+        case V_AstType::Mul: if (__builtin_mul_overflow(x, y, &result)) return nullptr; break;
+        
+        case V_AstType::Div:
+        case V_AstType::Mod: {
+            if (x < 0 || y <= 0) return nullptr;
+            result = expr->type == V_AstType::Div ? x / y : x % y;
+        } break;
+        
+        case V_AstType::And: result = x & y; break;
+        case V_AstType::Or: result = x | y; break;
+        case V_AstType::Xor: result = x ^ y; break;
+        
+        case V_AstType::Lsh: {
+            if (x < 0 || y < 0 || y >= size || x > (INT64_MAX >> y)) return nullptr;
+            result = x << y;
+        } break;
+        
+        case V_AstType::Rsh: {
+            if (x < 0 || y < 0 || y >= size) return nullptr;
+            result = x >> y;
+        } break;
+        
+        default: return nullptr;
+    }
+    
+    if (!fits(result, size)) return nullptr;
+    return AstContext::make<AstInt>((uint64_t)result, size);
+}
+
+//
+// Floats
+//
+// An f32 operation rounds the exact result once. So does the same operation
+// on doubles when the result is an f32, so those are folded in doubles.
+//
+std::shared_ptr<AstExpression> ConstantFoldMidend::fold_float(std::shared_ptr<AstBinaryOp> expr) {
+    double x = std::static_pointer_cast<AstFloat>(expr->lval)->value;
+    double y = std::static_pointer_cast<AstFloat>(expr->rval)->value;
+    if (!is_f32(x) || !is_f32(y)) return nullptr;
+    
+    double result = 0;
+    switch (expr->type) {
+        case V_AstType::Add: result = x + y; break;
+        case V_AstType::Sub: result = x - y; break;
+        case V_AstType::Mul: result = x * y; break;
+        
+        case V_AstType::Div: {
+            if (y == 0) return nullptr;
+            result = x / y;
+        } break;
+        
+        case V_AstType::Mod: {
+            if (y == 0) return nullptr;
+            result = std::fmod(x, y);
+        } break;
+        
+        default: return nullptr;
+    }
+    
+    if (!is_f32(result)) return nullptr;
+    return AstContext::make<AstFloat>(result);
+}
+
+//
+// Strings and characters joined onto string literals
+//
+std::shared_ptr<AstExpression> ConstantFoldMidend::fold_string(std::shared_ptr<AstBinaryOp> expr) {
+    if (expr->type != V_AstType::Add) return nullptr;
+    
+    auto lval = std::static_pointer_cast<AstString>(expr->lval);
+    if (expr->rval->type == V_AstType::CharL) {
+        auto c = std::static_pointer_cast<AstChar>(expr->rval);
+        return AstContext::make<AstString>(lval->value + c->value);
+    }
+    
+    auto rval = std::static_pointer_cast<AstString>(expr->rval);
+    return AstContext::make<AstString>(lval->value + rval->value);
+}
+
+//
+// Identities: x+0, 0+x, x-0, x*1, 1*x, x/1, x|0, 0|x, x^0, 0^x, x<<0, x>>0
+//
+// The interpreter prints a variable by its type and an expression by what it
+// works out to, so an identity is only taken away from an expression that
+// is still printed the same way without it: another operation, or an i32.
+//
+std::shared_ptr<AstExpression> ConstantFoldMidend::simplify(std::shared_ptr<AstBinaryOp> expr, std::shared_ptr<AstBlock> block) {
+    auto keeps = [&](std::shared_ptr<AstExpression> value) {
+        switch (value->type) {
+            case V_AstType::Add:
+            case V_AstType::Sub:
+            case V_AstType::Mul:
+            case V_AstType::Div:
+            case V_AstType::Mod:
+            case V_AstType::And:
+            case V_AstType::Or:
+            case V_AstType::Xor:
+            case V_AstType::Lsh:
+            case V_AstType::Rsh: return true;
+            
+            case V_AstType::ID: {
+                auto data_type = block->getDataType(std::static_pointer_cast<AstID>(value)->value);
+                return data_type && data_type->type == V_AstType::Int32 && !data_type->is_unsigned;
+            }
+            
+            default: return false;
+        }
+    };
+    
+    auto lval = expr->lval;
+    auto rval = expr->rval;
+    
+    switch (expr->type) {
+        case V_AstType::Add:
+        case V_AstType::Or:
+        case V_AstType::Xor: {
+            if (is_int(rval, 0) && keeps(lval)) return lval;
+            if (is_int(lval, 0) && keeps(rval)) return rval;
+        } break;
+        
+        case V_AstType::Mul: {
+            if (is_int(rval, 1) && keeps(lval)) return lval;
+            if (is_int(lval, 1) && keeps(rval)) return rval;
+        } break;
+        
+        case V_AstType::Sub:
+        case V_AstType::Lsh:
+        case V_AstType::Rsh: {
+            if (is_int(rval, 0) && keeps(lval)) return lval;
+        } break;
+        
+        case V_AstType::Div: {
+            if (is_int(rval, 1) && keeps(lval)) return lval;
+        } break;
+        
+        default: {}
+    }
+    
+    return nullptr;
+}
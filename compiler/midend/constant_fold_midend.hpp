@@ -0,0 +1,46 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#pragma once
+
+#include <memory>
+#include <unordered_set>
+
+#include <ast/ast.hpp>
+#include <midend/ast_midend.hpp>
+
+//
+// Folds constant expressions and simplifies identities
+//
+// An operation is only folded when every backend would give it the same
+// value: integers that do not overflow their width, divisions and right
+// shifts of values that are not negative, and floats whose operands and
+// result fit in an f32, so f32 and f64 code agree. Comparisons are left
+// alone, since the LLVM backend expects them to give an i1.
+//
+// Uses of a const are already copies of its expression, so folding them
+// propagates the value. The expressions in the const tables are folded too.
+//
+// This runs before the language's own midend, so that string literals are
+// joined before they are turned into library calls.
+//
+class ConstantFoldMidend : public AstMidend {
+public:
+    explicit ConstantFoldMidend(std::shared_ptr<AstTree> tree) : AstMidend(tree) {}
+    
+    void process_block(std::shared_ptr<AstBlock> block) override;
+    std::shared_ptr<AstExpression> process_expression(std::shared_ptr<AstExpression> expr, std::shared_ptr<AstBlock> block) override;
+    std::shared_ptr<AstExpression> process_binary_op(std::shared_ptr<AstBinaryOp> expr, std::shared_ptr<AstBlock> block) override;
+    std::shared_ptr<AstExpression> process_neg_op(std::shared_ptr<AstNegOp> expr, std::shared_ptr<AstBlock> block) override;
+protected:
+    std::shared_ptr<AstExpression> fold_int(std::shared_ptr<AstBinaryOp> expr);
+    std::shared_ptr<AstExpression> fold_float(std::shared_ptr<AstBinaryOp> expr);
+    std::shared_ptr<AstExpression> fold_string(std::shared_ptr<AstBinaryOp> expr);
+    std::shared_ptr<AstExpression> simplify(std::shared_ptr<AstBinaryOp> expr, std::shared_ptr<AstBlock> block);
+private:
+    // The element size times length of each array allocation. The
+    // interpreters read the length back out of them, so they are kept.
+    std::unordered_set<AstExpression *> alloc_sizes;
+};
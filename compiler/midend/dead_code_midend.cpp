@@ -0,0 +1,175 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#include <vector>
+
+#include "dead_code_midend.hpp"
+
+//
+// Statements after a jump in the same block never run
+//
+void DeadCodeMidend::process_block(std::shared_ptr<AstBlock> block) {
+    for (size_t i = 0; i<block->block.size(); i++) {
+        auto type = block->block[i]->type;
+        if (type != V_AstType::Return && type != V_AstType::Break && type != V_AstType::Continue) continue;
+        
+        removed_statements += block->block.size() - i - 1;
+        block->block.resize(i + 1);
+        break;
+    }
+}
+
+//
+// Each global statement starts a new declaration
+//
+void DeadCodeMidend::process_statement(std::shared_ptr<AstStatement> stmt, std::shared_ptr<AstBlock> block) {
+    if (block == tree->block) current = &roots;
+}
+
+void DeadCodeMidend::process_extern_function(std::shared_ptr<AstExternFunction> stmt, std::shared_ptr<AstBlock> block) {
+    current = &func_uses[stmt->name];
+    for (auto const &arg : stmt->args) use_type(arg.type);
+    use_type(stmt->data_type);
+}
+
+void DeadCodeMidend::process_function(std::shared_ptr<AstFunction> stmt, std::shared_ptr<AstBlock> block) {
+    current = &func_uses[stmt->name];
+    for (auto const &arg : stmt->args) use_type(arg.type);
+    use_type(stmt->data_type);
+}
+
+//
+// The uses within a declaration
+//
+void DeadCodeMidend::process_expr_statement(std::shared_ptr<AstExprStatement> stmt, std::shared_ptr<AstBlock> block) {
+    use_type(stmt->dataType);
+}
+
+void DeadCodeMidend::process_function_call(std::shared_ptr<AstFuncCallStmt> stmt, std::shared_ptr<AstBlock> block) {
+    current->funcs.insert(stmt->name);
+}
+
+void DeadCodeMidend::process_var_decl(std::shared_ptr<AstVarDec> stmt, std::shared_ptr<AstBlock> block) {
+    use_type(stmt->data_type);
+}
+
+void DeadCodeMidend::process_struct_decl(std::shared_ptr<AstStructDec> stmt, std::shared_ptr<AstBlock> block) {
+    current->structs.insert(stmt->struct_name);
+}
+
+void DeadCodeMidend::process_for(std::shared_ptr<AstForStmt> stmt, std::shared_ptr<AstBlock> block) {
+    use_type(stmt->data_type);
+}
+
+void DeadCodeMidend::process_forall(std::shared_ptr<AstForAllStmt> stmt, std::shared_ptr<AstBlock> block) {
+    use_type(stmt->data_type);
+}
+
+std::shared_ptr<AstExpression> DeadCodeMidend::process_expression(std::shared_ptr<AstExpression> expr, std::shared_ptr<AstBlock> block) {
+    if (expr->type == V_AstType::FuncCallExpr) {
+        current->funcs.insert(std::static_pointer_cast<AstFuncCallExpr>(expr)->name);
+    } else if (expr->type == V_AstType::FuncRef) {
+        current->funcs.insert(std::static_pointer_cast<AstFuncRef>(expr)->value);
+    }
+    return nullptr;
+}
+
+void DeadCodeMidend::use_type(std::shared_ptr<AstDataType> type) {
+    while (type && type->type == V_AstType::Ptr) {
+        type = std::static_pointer_cast<AstPointerType>(type)->base_type;
+    }
+    
+    if (type && type->type == V_AstType::Struct) {
+        current->structs.insert(std::static_pointer_cast<AstStructType>(type)->name);
+    }
+}
+
+//
+// Marks everything reachable from main, and removes the rest
+//
+void DeadCodeMidend::finish() {
+    if (func_uses.find(Symbol::find("main")) == func_uses.end() && func_uses.find(Symbol::find("__main")) == func_uses.end()) {
+        return;
+    }
+    
+    // The structures use the types of their members, and their default
+    // values are compiled into each function that declares one
+    std::unordered_map<Symbol, Uses> struct_uses;
+    for (auto const &str : tree->structs) {
+        current = &struct_uses[str->name];
+        for (auto const &item : str->items) {
+            use_type(item.type);
+            
+            auto found = str->default_expressions.find(item.name);
+            if (found == str->default_expressions.end()) continue;
+            auto expr = found->second;
+            it_process_expression(expr, tree->block);
+        }
+    }
+    current = &roots;
+    
+    std::unordered_set<Symbol> funcs = { Symbol("main"), Symbol("__main"), Symbol("malloc"), Symbol("gc_alloc") };
+    std::unordered_set<Symbol> structs;
+    std::vector<Uses *> work = { &roots };
+    for (auto const &name : funcs) {
+        auto found = func_uses.find(name);
+        if (found != func_uses.end()) work.push_back(&found->second);
+    }
+    
+    while (!work.empty()) {
+        Uses *uses = work.back();
+        work.pop_back();
+        
+        for (auto const &name : uses->funcs) {
+            if (!funcs.insert(name).second) continue;
+            auto found = func_uses.find(name);
+            if (found != func_uses.end()) work.push_back(&found->second);
+        }
+        
+        for (auto const &name : uses->structs) {
+            if (!structs.insert(name).second) continue;
+            auto found = struct_uses.find(name);
+            if (found != struct_uses.end()) work.push_back(&found->second);
+        }
+    }
+    
+    // Remove what was not reached. Each import declares its externs again,
+    // but calls are looked up by name and find the first, so the copies go too.
+    std::vector<std::shared_ptr<AstStatement>> globals;
+    std::unordered_set<Symbol> externs;
+    for (auto const &global : tree->block->block) {
+        Symbol name;
+        if (global->type == V_AstType::Func) {
+            name = std::static_pointer_cast<AstFunction>(global)->name;
+        } else if (global->type == V_AstType::ExternFunc) {
+            name = std::static_pointer_cast<AstExternFunction>(global)->name;
+            if (!externs.insert(name).second) {
+                ++removed_functions;
+                continue;
+            }
+        } else {
+            globals.push_back(global);
+            continue;
+        }
+        
+        if (funcs.find(name) != funcs.end()) globals.push_back(global);
+        else ++removed_functions;
+    }
+    tree->block->block = std::move(globals);
+    
+    std::vector<std::shared_ptr<AstStruct>> kept;
+    for (auto const &str : tree->structs) {
+        if (structs.find(str->name) != structs.end()) kept.push_back(str);
+        else ++removed_structs;
+    }
+    tree->structs = std::move(kept);
+}
+
+void DeadCodeMidend::print_stats(std::ostream &out) {
+    out << "Dead code removed:" << std::endl;
+    out << "    functions:  " << removed_functions << std::endl;
+    out << "    structures: " << removed_structs << std::endl;
+    out << "    statements: " << removed_statements << std::endl;
+}
@@ -0,0 +1,72 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#pragma once
+
+#include <ostream>
+#include <memory>
+#include <unordered_set>
+#include <unordered_map>
+
+#include <ast/ast.hpp>
+#include <midend/ast_midend.hpp>
+
+//
+// Removes code that can never run
+//
+// Statements that follow a return, break or continue in the same block are
+// dropped. Then the functions, externs and structures that cannot be reached
+// from main are taken out of the tree, so the backend never compiles them.
+// A function is reached when it is called or referenced by a reached
+// function; a structure when a reached function or structure uses its type.
+//
+// The allocators are always kept, since the backend calls them itself for
+// structure declarations. A tree without a main is a library, so nothing is
+// pruned from it.
+//
+// This runs after the other midends, since they add calls of their own.
+//
+class DeadCodeMidend : public AstMidend {
+public:
+    explicit DeadCodeMidend(std::shared_ptr<AstTree> tree) : AstMidend(tree) {}
+    
+    void finish() override;
+    
+    void process_block(std::shared_ptr<AstBlock> block) override;
+    void process_statement(std::shared_ptr<AstStatement> stmt, std::shared_ptr<AstBlock> block) override;
+    void process_extern_function(std::shared_ptr<AstExternFunction> stmt, std::shared_ptr<AstBlock> block) override;
+    void process_function(std::shared_ptr<AstFunction> stmt, std::shared_ptr<AstBlock> block) override;
+    void process_expr_statement(std::shared_ptr<AstExprStatement> stmt, std::shared_ptr<AstBlock> block) override;
+    void process_function_call(std::shared_ptr<AstFuncCallStmt> stmt, std::shared_ptr<AstBlock> block) override;
+    void process_var_decl(std::shared_ptr<AstVarDec> stmt, std::shared_ptr<AstBlock> block) override;
+    void process_struct_decl(std::shared_ptr<AstStructDec> stmt, std::shared_ptr<AstBlock> block) override;
+    void process_for(std::shared_ptr<AstForStmt> stmt, std::shared_ptr<AstBlock> block) override;
+    void process_forall(std::shared_ptr<AstForAllStmt> stmt, std::shared_ptr<AstBlock> block) override;
+    std::shared_ptr<AstExpression> process_expression(std::shared_ptr<AstExpression> expr, std::shared_ptr<AstBlock> block) override;
+    
+    void print_stats(std::ostream &out);
+    
+    int removed_statements = 0;
+    int removed_functions = 0;
+    int removed_structs = 0;
+protected:
+    // The functions and structures a declaration refers to
+    struct Uses {
+        std::unordered_set<Symbol> funcs;
+        std::unordered_set<Symbol> structs;
+    };
+    
+    void use_type(std::shared_ptr<AstDataType> type);
+private:
+    // Functions and externs that share a name are kept or removed together,
+    // so their uses are kept by name
+    std::unordered_map<Symbol, Uses> func_uses;
+    
+    // What the global statements outside of any function use
+    Uses roots;
+    
+    // The declaration being walked
+    Uses *current = &roots;
+};
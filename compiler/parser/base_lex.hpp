@@ -1,6 +1,9 @@
 #pragma once
 
+#include <string>
+
 struct BaseLex {
+    virtual ~BaseLex() {}
     virtual void unget(int t) {}
     virtual int get_next() { return 0; }
     virtual void debug_token(int t) {}
@@ -145,7 +145,7 @@ std::shared_ptr<AstExpression> BaseParser::buildExpression(std::shared_ptr<AstBl
     if (currentType) ctx->varType = currentType;
     else ctx->varType = AstBuilder::buildVoidType();
     
-    std::shared_ptr<AstExprList> list = std::make_shared<AstExprList>();
+    std::shared_ptr<AstExprList> list = AstContext::make<AstExprList>();
     bool isList = buildList;
     
     int tk = lex->get_next();
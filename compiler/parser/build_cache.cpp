@@ -0,0 +1,108 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#include <fstream>
+#include <thread>
+#include <functional>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <parser/build_cache.hpp>
+
+namespace BuildCache {
+
+uint64_t fnv(uint64_t hash, const void *data, size_t length) {
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t i = 0; i<length; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+uint64_t fnv(uint64_t hash, const std::string &data) {
+    uint64_t length = data.length();
+    hash = fnv(hash, &length, sizeof(length));
+    return fnv(hash, data.data(), data.length());
+}
+
+uint64_t compiler_hash() {
+    static const uint64_t hash = []() {
+        uint64_t h = fnv_offset;
+
+        struct stat info;
+        if (stat("/proc/self/exe", &info) == 0) {
+            h = fnv(h, &info.st_size, sizeof(info.st_size));
+            h = fnv(h, &info.st_mtime, sizeof(info.st_mtime));
+        }
+        return h;
+    }();
+    return hash;
+}
+
+//
+// A cache directory may only be used if it is one, belongs to this user, and
+// cannot be written by anyone else
+//
+static bool owned_dir(const std::string &dir) {
+    struct stat info;
+    if (lstat(dir.c_str(), &info) != 0) return false;
+    if (!S_ISDIR(info.st_mode)) return false;
+    if (info.st_uid != geteuid()) return false;
+    return (info.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+}
+
+static bool make_dir(const std::string &dir) {
+    return mkdir(dir.c_str(), 0700) == 0 || errno == EEXIST;
+}
+
+std::string private_dir(const char *variable, const char *name) {
+    std::string dir;
+    const char *env = getenv(variable);
+    if (env != nullptr && env[0] != 0) {
+        dir = env;
+    } else {
+        std::string base;
+        const char *xdg = getenv("XDG_CACHE_HOME");
+        const char *home = getenv("HOME");
+        if (xdg != nullptr && xdg[0] == '/') base = xdg;
+        else if (home != nullptr && home[0] == '/') base = std::string(home) + "/.cache";
+        else return "";
+
+        if (!make_dir(base)) return "";
+        dir = base + "/" + name;
+    }
+
+    if (!make_dir(dir) || !owned_dir(dir)) return "";
+    return dir;
+}
+
+std::string entry_path(const std::string &dir, uint64_t hash, const char *suffix) {
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx", (unsigned long long)hash);
+    return dir + name + suffix;
+}
+
+bool write_atomic(const std::string &path, const std::string &data) {
+    std::string temp = path + "." + std::to_string(getpid()) + "."
+        + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+
+    std::ofstream writer(temp, std::ios::binary);
+    if (!writer.is_open()) return false;
+    writer.write(data.data(), data.size());
+    writer.close();
+
+    if (!writer || rename(temp.c_str(), path.c_str()) != 0) {
+        remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,40 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+//
+// Helpers shared by the on-disk caches
+//
+// Keys are 64-bit FNV-1a hashes. Every key starts from the hash of the running
+// compiler, so that a rebuilt compiler never picks up entries written by an
+// older one.
+//
+namespace BuildCache {
+    constexpr uint64_t fnv_offset = 14695981039346656037ULL;
+
+    uint64_t fnv(uint64_t hash, const void *data, size_t length);
+    uint64_t fnv(uint64_t hash, const std::string &data);
+
+    // The hash of the compiler binary itself
+    uint64_t compiler_hash();
+
+    // Returns the directory named by the variable, or else the named one in
+    // the user's cache directory ($XDG_CACHE_HOME, or $HOME/.cache). It is
+    // created private to the user. The result is empty, and the cache should
+    // not be used, when the directory belongs to someone else or others can
+    // write to it: its entries could have been planted.
+    std::string private_dir(const char *variable, const char *name);
+
+    // The path of the entry for a key, in the given directory
+    std::string entry_path(const std::string &dir, uint64_t hash, const char *suffix);
+
+    // Writes to a temporary file first and renames it into place, so that a
+    // compiler running at the same time never sees a partial entry
+    bool write_atomic(const std::string &path, const std::string &data);
+}
@@ -0,0 +1,188 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <unordered_map>
+#include <cstring>
+
+#include <ast/ast_binary.hpp>
+#include <parser/source_buffer.hpp>
+#include <parser/build_cache.hpp>
+#include <parser/import_cache.hpp>
+
+namespace ImportCache {
+
+//
+// A header is kept in the binary format, and each importer is given a tree
+// read back from it. The midends change trees in place, so two importers
+// must never hold the same statements.
+//
+struct Entry {
+    std::once_flag once;
+    std::string data;
+    std::vector<std::string> imports;
+};
+
+static std::mutex lock;
+static std::unordered_map<std::string, std::shared_ptr<Entry>> entries;
+
+static std::atomic<int> shared_hits(0);
+static std::atomic<int> disk_hits(0);
+static std::atomic<int> misses(0);
+
+//
+// Trees written by another version of the binary format are never loaded
+//
+static uint64_t cache_seed() {
+    uint32_t version = AstBinary::version;
+    return BuildCache::fnv(BuildCache::compiler_hash(), &version, sizeof(version));
+}
+
+static bool hash_file(const std::string &path, uint64_t &hash) {
+    SourceBuffer buffer(path);
+    if (!buffer.is_open()) return false;
+    hash = BuildCache::fnv(cache_seed(), buffer.begin(), buffer.size());
+    return true;
+}
+
+// Empty when there is no cache directory that is safe to use
+static std::string cache_path(uint64_t hash) {
+    static const std::string dir = BuildCache::private_dir("AST_CACHE_DIR", "ast-cache");
+    if (dir.empty()) return "";
+    return BuildCache::entry_path(dir, hash, ".ast");
+}
+
+//
+// A cache entry is the list of headers the tree was built from, each with the
+// hash of its contents at the time, followed by the tree itself
+//
+template<class T>
+static bool read_value(const char *&pos, const char *end, T &value) {
+    if ((size_t)(end - pos) < sizeof(T)) return false;
+    memcpy(&value, pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+template<class T>
+static void write_value(std::string &out, T value) {
+    out.append((const char *)&value, sizeof(T));
+}
+
+static std::shared_ptr<AstTree> load_disk(uint64_t hash, std::vector<std::string> &imports, std::string &data) {
+    std::string entry = cache_path(hash);
+    if (entry.empty()) return nullptr;
+
+    SourceBuffer buffer(entry);
+    if (!buffer.is_open()) return nullptr;
+
+    const char *pos = buffer.begin();
+    const char *end = buffer.end();
+
+    uint32_t count;
+    if (!read_value(pos, end, count)) return nullptr;
+
+    for (uint32_t i = 0; i<count; i++) {
+        uint32_t length;
+        if (!read_value(pos, end, length)) return nullptr;
+        if ((size_t)(end - pos) < length) return nullptr;
+
+        std::string path(pos, length);
+        pos += length;
+
+        uint64_t saved, current;
+        if (!read_value(pos, end, saved)) return nullptr;
+        if (!hash_file(path, current) || current != saved) return nullptr;
+
+        imports.push_back(path);
+    }
+
+    auto tree = AstBinary::read(pos, end - pos);
+    if (tree != nullptr) data.assign(pos, end - pos);
+    return tree;
+}
+
+static void save_disk(uint64_t hash, const std::vector<std::string> &imports, const std::string &tree) {
+    std::string entry = cache_path(hash);
+    if (entry.empty()) return;
+
+    std::string data;
+    write_value<uint32_t>(data, imports.size());
+
+    for (auto const &path : imports) {
+        uint64_t current;
+        if (!hash_file(path, current)) return;
+
+        write_value<uint32_t>(data, path.length());
+        data += path;
+        write_value<uint64_t>(data, current);
+    }
+
+    data += tree;
+    BuildCache::write_atomic(entry, data);
+}
+
+static void add_import(std::vector<std::string> &imports, const std::string &path) {
+    if (std::find(imports.begin(), imports.end(), path) == imports.end()) {
+        imports.push_back(path);
+    }
+}
+
+std::shared_ptr<AstTree> load(std::string path, std::vector<std::string> &imports, ParseFunc parse) {
+    std::shared_ptr<Entry> entry;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        auto &slot = entries[path];
+        if (slot == nullptr) slot = std::make_shared<Entry>();
+        entry = slot;
+    }
+
+    // Only one caller loads the header; the rest block until it is done, and
+    // then read their own copy
+    bool loaded = false;
+    std::shared_ptr<AstTree> tree;
+    std::call_once(entry->once, [&]() {
+        loaded = true;
+
+        uint64_t hash;
+        bool cacheable = hash_file(path, hash);
+        if (cacheable) {
+            tree = load_disk(hash, entry->imports, entry->data);
+            if (tree != nullptr) {
+                ++disk_hits;
+                return;
+            }
+            entry->imports.clear();
+        }
+
+        ++misses;
+        tree = parse(entry->imports);
+        if (tree == nullptr) return;
+
+        entry->data = AstBinary::write(tree);
+        if (cacheable) save_disk(hash, entry->imports, entry->data);
+    });
+
+    if (!loaded) {
+        ++shared_hits;
+        if (!entry->data.empty()) tree = AstBinary::read(entry->data.data(), entry->data.size());
+    }
+
+    add_import(imports, path);
+    for (auto const &import : entry->imports) add_import(imports, import);
+
+    return tree;
+}
+
+void print_stats(std::ostream &out) {
+    out << "Import cache:" << std::endl;
+    out << "    disk hits:   " << disk_hits << std::endl;
+    out << "    shared hits: " << shared_hits << std::endl;
+    out << "    misses:      " << misses << std::endl;
+}
+
+}
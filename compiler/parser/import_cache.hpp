@@ -0,0 +1,38 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <ostream>
+
+#include <ast/ast.hpp>
+
+//
+// Parsed headers, shared by every parser in the process and between builds
+//
+// The first parser to import a header parses it; any other parser importing
+// the same header at the same time waits for that result instead of parsing
+// it again. Each importer gets a tree of its own, so it may be changed.
+//
+// Parsed headers are also saved on disk in the binary AST format, keyed by a
+// hash of the header's contents and of the compiler itself. An entry records
+// the headers it imported in turn, and is only used while all of them are
+// unchanged. The cache lives in $AST_CACHE_DIR, or by default in ast-cache
+// under the user's cache directory. It is not used unless the directory is
+// private to the user.
+//
+namespace ImportCache {
+    // The parse callback fills in the paths of the headers it imported
+    using ParseFunc = std::function<std::shared_ptr<AstTree>(std::vector<std::string> &imports)>;
+
+    // Loads a header, and adds it and everything it imports to imports
+    std::shared_ptr<AstTree> load(std::string path, std::vector<std::string> &imports, ParseFunc parse);
+
+    void print_stats(std::ostream &out);
+}
@@ -0,0 +1,120 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#pragma once
+
+#include <cstdint>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+//
+// Skip kernels shared by the generated lexers
+//
+// Each kernel tests a whole chunk of input at once: 32 bytes with AVX2, or
+// 16 bytes with SSE2. The tail of the buffer (and targets without either
+// instruction set) is handled one byte at a time.
+//
+namespace LexScan {
+
+#if defined(__AVX2__)
+
+struct Chunk {
+    static constexpr int width = 32;
+    static constexpr uint32_t all = 0xFFFFFFFF;
+
+    explicit Chunk(const char *p) : v(_mm256_loadu_si256((const __m256i *)p)) {}
+
+    uint32_t match(char c) const {
+        return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(c)));
+    }
+
+    __m256i v;
+};
+
+#define LEX_SCAN_VECTOR
+
+#elif defined(__SSE2__)
+
+struct Chunk {
+    static constexpr int width = 16;
+    static constexpr uint32_t all = 0xFFFF;
+
+    explicit Chunk(const char *p) : v(_mm_loadu_si128((const __m128i *)p)) {}
+
+    uint32_t match(char c) const {
+        return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(c)));
+    }
+
+    __m128i v;
+};
+
+#define LEX_SCAN_VECTOR
+
+#endif
+
+//
+// Returns the first newline in [p, end), or end
+//
+inline const char *find_newline(const char *p, const char *end) {
+#ifdef LEX_SCAN_VECTOR
+    while (end - p >= Chunk::width) {
+        uint32_t mask = Chunk(p).match('\n');
+        if (mask) return p + __builtin_ctz(mask);
+        p += Chunk::width;
+    }
+#endif
+    while (p < end && *p != '\n') ++p;
+    return p;
+}
+
+//
+// Returns the first quote or backslash in [p, end), or end
+//
+inline const char *find_quote(const char *p, const char *end) {
+#ifdef LEX_SCAN_VECTOR
+    while (end - p >= Chunk::width) {
+        Chunk chunk(p);
+        uint32_t mask = chunk.match('\"') | chunk.match('\\');
+        if (mask) return p + __builtin_ctz(mask);
+        p += Chunk::width;
+    }
+#endif
+    while (p < end && *p != '\"' && *p != '\\') ++p;
+    return p;
+}
+
+//
+// Skips spaces and newlines, and returns the first other byte (or end)
+//
+// Each newline skipped is added to line_number.
+//
+inline const char *skip_blank(const char *p, const char *end, int &line_number) {
+#ifdef LEX_SCAN_VECTOR
+    while (end - p >= Chunk::width) {
+        Chunk chunk(p);
+        uint32_t newlines = chunk.match('\n');
+        uint32_t blank = chunk.match(' ') | newlines;
+
+        if (blank == Chunk::all) {
+            line_number += __builtin_popcount(newlines);
+            p += Chunk::width;
+            continue;
+        }
+
+        int n = __builtin_ctz(~blank);
+        line_number += __builtin_popcount(newlines & ((1u << n) - 1));
+        return p + n;
+    }
+#endif
+    while (p < end && (*p == ' ' || *p == '\n')) {
+        if (*p == '\n') ++line_number;
+        ++p;
+    }
+    return p;
+}
+
+}
@@ -0,0 +1,60 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#include <fstream>
+#include <sstream>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <parser/source_buffer.hpp>
+
+//
+// Maps the source file into memory
+//
+SourceBuffer::SourceBuffer(std::string path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+        open = true;
+
+        // Empty files cannot be mapped, but they are still valid input
+        if (info.st_size == 0) {
+            ::close(fd);
+            return;
+        }
+
+        void *addr = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            madvise(addr, info.st_size, MADV_SEQUENTIAL);
+            data = (const char *)addr;
+            length = info.st_size;
+            mapped = true;
+            ::close(fd);
+            return;
+        }
+    }
+    ::close(fd);
+
+    // Fall back to reading the whole file at once
+    std::ifstream reader(path, std::ios::binary);
+    if (!reader.is_open()) return;
+
+    std::stringstream ss;
+    ss << reader.rdbuf();
+    contents = ss.str();
+
+    data = contents.data();
+    length = contents.length();
+    open = true;
+}
+
+SourceBuffer::~SourceBuffer() {
+    if (mapped) munmap((void *)data, length);
+}
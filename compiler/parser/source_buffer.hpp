@@ -0,0 +1,36 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#pragma once
+
+#include <string>
+#include <string_view>
+
+//
+// A read-only view of an entire source file
+//
+// The file is memory-mapped when possible. If mapping fails (for instance, on
+// a pipe), the contents are read into a single buffer instead. Either way, the
+// lexers scan the data with plain pointers.
+//
+struct SourceBuffer {
+    explicit SourceBuffer(std::string path);
+    ~SourceBuffer();
+
+    SourceBuffer(const SourceBuffer &) = delete;
+    SourceBuffer &operator=(const SourceBuffer &) = delete;
+
+    bool is_open() { return open; }
+    const char *begin() { return data; }
+    const char *end() { return data + length; }
+    size_t size() { return length; }
+    std::string_view view() { return std::string_view(data, length); }
+private:
+    const char *data = "";
+    size_t length = 0;
+    bool open = false;
+    bool mapped = false;
+    std::string contents = "";
+};
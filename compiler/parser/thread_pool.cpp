@@ -0,0 +1,46 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#include <parser/thread_pool.hpp>
+
+ThreadPool::ThreadPool(size_t count) {
+    for (size_t i = 0; i<count; i++) {
+        workers.emplace_back(&ThreadPool::run, this);
+    }
+}
+
+//
+// Finishes the queued tasks, then joins the workers
+//
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    ready.notify_all();
+
+    for (auto &worker : workers) worker.join();
+}
+
+size_t ThreadPool::default_count() {
+    size_t count = std::thread::hardware_concurrency();
+    if (count == 0) count = 1;
+    return count;
+}
+
+void ThreadPool::run() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            ready.wait(guard, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) return;
+
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
@@ -0,0 +1,61 @@
+//
+// This software is licensed under BSD0 (public domain).
+// Therefore, this software belongs to humanity.
+// See COPYING for more info.
+//
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+
+//
+// A fixed-size pool of worker threads
+//
+// Tasks run in the order they are submitted. A pool with no threads runs
+// each task as soon as it is submitted, on the calling thread.
+//
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t count);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    static size_t default_count();
+
+    template<class F, class... Args>
+    auto submit(F &&func, Args &&...args) -> std::future<decltype(func(args...))> {
+        using R = decltype(func(args...));
+        auto task = std::make_shared<std::packaged_task<R()>>(
+            std::bind(std::forward<F>(func), std::forward<Args>(args)...)
+        );
+        std::future<R> result = task->get_future();
+
+        if (workers.empty()) {
+            (*task)();
+            return result;
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            tasks.push([task]() { (*task)(); });
+        }
+        ready.notify_one();
+        return result;
+    }
+private:
+    void run();
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex lock;
+    std::condition_variable ready;
+    bool stopping = false;
+};
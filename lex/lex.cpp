@@ -1,16 +1,21 @@
 #include <iostream>
 #include <cctype>
 
+#include <parser/lex_scan.hpp>
+
 #include "lex.hpp"
 
 //
 // Setups the lexical analyzer
 //
-Lex::Lex(std::string input) {
-    reader = std::ifstream(input);
-    if (!reader.is_open()) {
+Lex::Lex(std::string input) : source(input) {
+    if (!source.is_open()) {
         // TODO
     }
+    
+    pos = source.begin();
+    end = source.end();
+    raw_start = pos;
 }
 
 //
@@ -29,52 +34,60 @@ int Lex::get_next() {
         token_stack.pop();
         return t;
     }
+    
+    return scan();
+}
 
-    if (reader.eof()) {
-        return t_eof;
-    }
+//
+// Scans the next token from the source
+//
+token Lex::scan() {
+    if (pos >= end) return t_eof;
     
-    while (!reader.eof()) {
-        char c = reader.get();
-        if (!reader.eof()) raw_buffer += c;
+    while (pos < end) {
+        if (buffer.empty()) {
+            pos = LexScan::skip_blank(pos, end, line_number);
+            if (pos >= end) break;
+        }
+        
+        char c = *pos++;
         
         if (c == '#') {
-            c = reader.get();
-            raw_buffer += c;
-            while (c != '\n' && !reader.eof()) {
-                c = reader.get();
-                raw_buffer += c;
-            }
+            pos = LexScan::find_newline(pos, end);
             ++line_number;
+            if (pos >= end) break;
+            c = *pos++;
         }
         
         if (c == '\"') {
             value = "";
             
-            c = reader.get();
-            raw_buffer += c;
-            while (c != '\"' && !reader.eof()) {
-                if (c == '\\') {
-                    c = reader.get();
-                    if (c == 'n') {
-                        value += '\n';
-                    } else {
-                        value += '\\';
-                        value += c;
-                    }
+            const char *start = pos;
+            for (;;) {
+                pos = LexScan::find_quote(pos, end);
+                if (pos >= end || *pos == '\"') break;
+                
+                value.append(start, pos);
+                ++pos;
+                if (pos < end && *pos == 'n') {
+                    value += '\n';
                 } else {
-                    value += c;
+                    value += '\\';
+                    if (pos < end) value += *pos;
                 }
-                c = reader.get();   
+                if (pos < end) ++pos;
+                start = pos;
             }
+            value.append(start, pos);
+            if (pos < end) ++pos;
             
             return t_string_literal;
         }
         
         if (c == '\'') {
-            c = reader.get();
+            c = (pos < end) ? *pos++ : 0;
             if (c == '\\') {
-                c = reader.get();
+                c = (pos < end) ? *pos++ : 0;
                 if (c == 'n') {
                     c = '\n';
                 }
@@ -85,7 +98,7 @@ int Lex::get_next() {
             value = "";
             value += c;
             
-            reader.get();
+            if (pos < end) ++pos;
             return t;
         }
         
@@ -94,50 +107,72 @@ int Lex::get_next() {
             if (c == '\n') ++line_number;
         
             if (is_symbol(c)) {
-                token sym = get_symbol(c);
-                if (buffer == "") {
-                    return sym;
+                // A symbol that ends a word is scanned again on the next call
+                if (!buffer.empty()) {
+                    --pos;
+                } else {
+                    return get_symbol(c);
                 }
-                token_stack.push(sym);
             }
             
-            if (buffer == "") continue;
+            if (buffer.empty()) continue;
             
-            token t = t_none;
-            ///LEX_KEYWORD_CHECK
-            else if (is_integer()) {
+            token t = get_keyword();
+            if (t != t_none) {
+                // Keywords carry no value
+            } else if (is_integer()) {
                 t = t_int_literal;
                 value = buffer;
-                i_value = std::stoi(buffer);
+                i_value = std::stoi(value);
             } else if (is_hex()) {
                 t = t_int_literal;
                 value = buffer;
-                i_value = std::stoi(buffer, 0, 16);
+                i_value = std::stoi(value, 0, 16);
             } else if (is_float()) {
                 t = t_float_literal;
                 value = buffer;
-                f_value = std::stod(buffer);
+                f_value = std::stod(value);
             } else {
                 t = t_id;
                 value = buffer;
             }
             
-            buffer = "";
+            buffer = std::string_view();
             return t;
+        } else if (buffer.empty()) {
+            buffer = std::string_view(pos - 1, 1);
         } else {
-            buffer += c;
+            buffer = std::string_view(buffer.data(), pos - buffer.data());
         }
     }
     
     return t_eof;
 }
 
-std::string Lex::get_raw_buffer() {
-    std::string ret = raw_buffer;
-    raw_buffer = "";
+//
+// Returns the raw source text scanned since the last call
+//
+std::string_view Lex::get_raw_buffer() {
+    std::string_view ret(raw_start, pos - raw_start);
+    raw_start = pos;
     return ret;
 }
 
+//
+// Classifies the pending word as a keyword, or returns t_none
+//
+// The body is generated from the keyword list as a trie over the word, so
+// no string comparisons are needed.
+//
+token Lex::get_keyword() {
+    const char *s = buffer.data();
+    switch (buffer.length()) {
+        ///LEX_KEYWORD_CHECK
+        default: {}
+    }
+    return t_none;
+}
+
 bool Lex::is_symbol(char c) {
     switch (c) {
         ///LEX_SYMBOL_CHECK
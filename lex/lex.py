@@ -7,16 +7,134 @@ sys.path.append(os.getcwd())
 
 import config
 keywords = config.keywords
-symbols = dict()
 
-for item in config.symbols:
-	name = item[0]
-	value = item[1]
-	key = value[0]		# This is the first character of the symbol sequence
-	if key in symbols:
-		symbols[key].append((value, name))
-	else:
-		symbols[key] = [(value, name)]
+##
+## Builds a character trie from a list of (token, text) pairs
+##
+## Each node is a dict: "token" holds the token name ending at that node (or
+## None), and "next" maps the following character to the child node.
+##
+def build_trie(items):
+    root = { "token": None, "next": dict() }
+    for name, text in items:
+        node = root
+        for c in text:
+            if not c in node["next"]:
+                node["next"][c] = { "token": None, "next": dict() }
+            node = node["next"][c]
+        node["token"] = name
+    return root
+
+def char_literal(c):
+    if c == "\\" or c == "\'":
+        return "\'\\" + c + "\'"
+    return "\'" + c + "\'"
+
+##
+## Emits the keyword classifier
+##
+## Keywords are grouped by length first, and each group is walked as a trie
+## over the word. Once only one keyword is left, the remaining characters are
+## compared directly.
+##
+def write_keyword_node(writer, node, depth, indent):
+    tabs = "\t" * indent
+    if len(node["next"]) == 0:
+        writer.write(tabs + "return " + node["token"] + ";\n")
+        return
+
+    # A single remaining candidate: compare the rest of the word at once
+    if len(node["next"]) == 1:
+        checks = []
+        d = depth
+        while len(node["next"]) == 1:
+            c, node = list(node["next"].items())[0]
+            checks.append("s[" + str(d) + "] == " + char_literal(c))
+            d += 1
+        if len(node["next"]) == 0:
+            writer.write(tabs + "if (" + " && ".join(checks) + ") return " + node["token"] + ";\n")
+        else:
+            writer.write(tabs + "if (" + " && ".join(checks) + ") {\n")
+            write_keyword_node(writer, node, d, indent + 1)
+            writer.write(tabs + "}\n")
+        return
+
+    writer.write(tabs + "switch (s[" + str(depth) + "]) {\n")
+    for c, child in node["next"].items():
+        if len(child["next"]) == 0:
+            writer.write(tabs + "\tcase " + char_literal(c) + ": return " + child["token"] + ";\n")
+        else:
+            writer.write(tabs + "\tcase " + char_literal(c) + ": {\n")
+            write_keyword_node(writer, child, depth + 1, indent + 2)
+            writer.write(tabs + "\t} break;\n")
+    writer.write(tabs + "\tdefault: {}\n")
+    writer.write(tabs + "}\n")
+
+def write_keyword_check(writer):
+    by_length = dict()
+    for keyword in keywords:
+        length = len(keyword[1])
+        if length in by_length:
+            by_length[length].append(keyword)
+        else:
+            by_length[length] = [keyword]
+
+    for length in sorted(by_length):
+        writer.write("\t\tcase " + str(length) + ": {\n")
+        write_keyword_node(writer, build_trie(by_length[length]), 0, 3)
+        writer.write("\t\t} break;\n")
+
+##
+## Emits the symbol recognizer
+##
+## The first character has already been read; each deeper level peeks one
+## more character ahead, and the longest match wins.
+##
+def peek(depth):
+    if depth == 0:
+        return "(pos < end) ? *pos : 0"
+    return "(pos + " + str(depth) + " < end) ? pos[" + str(depth) + "] : 0"
+
+def advance(depth, indent):
+    if depth == 1:
+        return "\t" * indent + "++pos;\n"
+    return "\t" * indent + "pos += " + str(depth) + ";\n"
+
+def write_symbol_node(writer, node, depth, indent, fallback):
+    tabs = "\t" * indent
+    if node["token"] != None:
+        fallback = (node["token"], depth)
+
+    writer.write(tabs + "switch (" + peek(depth - 1) + ") {\n")
+    for c, child in node["next"].items():
+        writer.write(tabs + "\tcase " + char_literal(c) + ": {\n")
+        if len(child["next"]) == 0:
+            writer.write(advance(depth, indent + 2))
+            writer.write(tabs + "\t\treturn " + child["token"] + ";\n")
+        else:
+            write_symbol_node(writer, child, depth + 1, indent + 2, fallback)
+        writer.write(tabs + "\t}\n")
+    writer.write(tabs + "\tdefault: {}\n")
+    writer.write(tabs + "}\n")
+
+    # Nothing longer matched; fall back to the longest symbol seen so far
+    name, length = fallback
+    if name == None:
+        writer.write(tabs + "return t_none;\n")
+    else:
+        if length > 1:
+            writer.write(advance(length - 1, indent))
+        writer.write(tabs + "return " + name + ";\n")
+
+def write_symbol_return(writer):
+    symbols = build_trie(config.symbols)
+    for c, node in symbols["next"].items():
+        if len(node["next"]) == 0:
+            writer.write("\t\tcase " + char_literal(c) + ": return " + node["token"] + ";\n")
+        else:
+            writer.write("\t\tcase " + char_literal(c) + ": {\n")
+            write_symbol_node(writer, node, 1, 3, (None, 1))
+            writer.write("\t\t}\n")
 
 base_path = sys.argv[1]
 
@@ -54,17 +172,9 @@ with open(base_path + "/lex.cpp", "r") as reader:
     for line in reader:
         ln = line.strip()
         
-        # Keyword if-else block
+        # Keyword classifier
         if ln == "///LEX_KEYWORD_CHECK":
-            first = True
-            for keyword in keywords:
-                writer.write("\t\t\t")
-                if first:
-                    writer.write("if ")
-                    first = False
-                else:
-                    writer.write("else if ")
-                writer.write("(buffer == \"" + keyword[1] + "\") t = " + keyword[0] + ";\n")
+            write_keyword_check(writer)
         
         # Keyword debug section
         elif ln == "///LEX_KEYWORD_DEBUG":
@@ -78,45 +188,12 @@ with open(base_path + "/lex.cpp", "r") as reader:
         
         # Symbol checking
         elif ln == "///LEX_SYMBOL_CHECK":
-            for value, name in symbols.items():
-                writer.write("\t\tcase \'" + value[0] + "\': return true;\n")
+            for c in build_trie(config.symbols)["next"]:
+                writer.write("\t\tcase " + char_literal(c) + ": return true;\n")
         
         # Return the proper symbol
         elif ln == "///LEX_SYMBOL_RETURN":
-            for value, name_list in symbols.items():
-                if len(name_list) == 1 and len(name_list[0][0]) == 1:
-                    writer.write("\t\tcase \'" + value + "\': return " + name_list[0][1] + ";\n")
-                else:
-                    writer.write("\t\tcase \'" + value + "\': {\n")
-                    writer.write("\t\t\tchar c2 = reader.get();\n")
-
-                    found_first = False
-                    default_name = None
-
-                    for item in name_list:
-                        if len(item[0]) == 1:
-                            default_name = item[1]
-                            continue
-
-                        symbol = item[0]
-                        name = item[1]
-                        
-                        if found_first:
-                            writer.write("\t\t\t} else ")
-                        found_first = True
-                        writer.write("\t\t\tif (c2 == \'" + symbol[1] + "\') {\n")
-                        writer.write("\t\t\t\traw_buffer += c2;\n")
-                        writer.write("\t\t\t\treturn " + name + ";\n")
-                        
-                    # Final else statement
-                    writer.write("\t\t\t} else {\n")
-                    writer.write("\t\t\t\treader.unget();\n")
-                    if default_name != None:
-                        writer.write("\t\t\t\treturn " + default_name + ";\n")
-                    writer.write("\t\t\t}\n")
-
-                    # Closing brace of break statement
-                    writer.write("\t\t} break;\n")
+            write_symbol_return(writer)
                 
         else:
             writer.write(line)
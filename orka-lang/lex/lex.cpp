@@ -1,16 +1,21 @@
 #include <iostream>
 #include <cctype>
 
+#include <parser/lex_scan.hpp>
+
 #include "lex.hpp"
 
 //
 // Setups the lexical analyzer
 //
-Lex::Lex(std::string input) {
-    reader = std::ifstream(input);
-    if (!reader.is_open()) {
+Lex::Lex(std::string input) : source(input) {
+    if (!source.is_open()) {
         // TODO
     }
+    
+    pos = source.begin();
+    end = source.end();
+    raw_start = pos;
 }
 
 //
@@ -29,52 +34,60 @@ int Lex::get_next() {
         token_stack.pop();
         return t;
     }
+    
+    return scan();
+}
 
-    if (reader.eof()) {
-        return t_eof;
-    }
+//
+// Scans the next token from the source
+//
+token Lex::scan() {
+    if (pos >= end) return t_eof;
     
-    while (!reader.eof()) {
-        char c = reader.get();
-        if (!reader.eof()) raw_buffer += c;
+    while (pos < end) {
+        if (buffer.empty()) {
+            pos = LexScan::skip_blank(pos, end, line_number);
+            if (pos >= end) break;
+        }
+        
+        char c = *pos++;
         
         if (c == '#') {
-            c = reader.get();
-            raw_buffer += c;
-            while (c != '\n' && !reader.eof()) {
-                c = reader.get();
-                raw_buffer += c;
-            }
+            pos = LexScan::find_newline(pos, end);
             ++line_number;
+            if (pos >= end) break;
+            c = *pos++;
         }
         
         if (c == '\"') {
             value = "";
             
-            c = reader.get();
-            raw_buffer += c;
-            while (c != '\"' && !reader.eof()) {
-                if (c == '\\') {
-                    c = reader.get();
-                    if (c == 'n') {
-                        value += '\n';
-                    } else {
-                        value += '\\';
-                        value += c;
-                    }
+            const char *start = pos;
+            for (;;) {
+                pos = LexScan::find_quote(pos, end);
+                if (pos >= end || *pos == '\"') break;
+                
+                value.append(start, pos);
+                ++pos;
+                if (pos < end && *pos == 'n') {
+                    value += '\n';
                 } else {
-                    value += c;
+                    value += '\\';
+                    if (pos < end) value += *pos;
                 }
-                c = reader.get();   
+                if (pos < end) ++pos;
+                start = pos;
             }
+            value.append(start, pos);
+            if (pos < end) ++pos;
             
             return t_string_literal;
         }
         
         if (c == '\'') {
-            c = reader.get();
+            c = (pos < end) ? *pos++ : 0;
             if (c == '\\') {
-                c = reader.get();
+                c = (pos < end) ? *pos++ : 0;
                 if (c == 'n') {
                     c = '\n';
                 }
@@ -85,7 +98,7 @@ int Lex::get_next() {
             value = "";
             value += c;
             
-            reader.get();
+            if (pos < end) ++pos;
             return t;
         }
         
@@ -94,93 +107,274 @@ int Lex::get_next() {
             if (c == '\n') ++line_number;
         
             if (is_symbol(c)) {
-                token sym = get_symbol(c);
-                if (buffer == "") {
-                    return sym;
+                // A symbol that ends a word is scanned again on the next call
+                if (!buffer.empty()) {
+                    --pos;
+                } else {
+                    return get_symbol(c);
                 }
-                token_stack.push(sym);
             }
             
-            if (buffer == "") continue;
+            if (buffer.empty()) continue;
             
-            token t = t_none;
-			if (buffer == "extern") t = t_extern;
-			else if (buffer == "func") t = t_func;
-			else if (buffer == "struct") t = t_struct;
-			else if (buffer == "end") t = t_end;
-			else if (buffer == "return") t = t_return;
-			else if (buffer == "var") t = t_var;
-			else if (buffer == "array") t = t_array;
-			else if (buffer == "const") t = t_const;
-			else if (buffer == "bool") t = t_bool;
-			else if (buffer == "char") t = t_char;
-			else if (buffer == "str") t = t_string;
-			else if (buffer == "byte") t = t_i8;
-			else if (buffer == "ubyte") t = t_u8;
-			else if (buffer == "short") t = t_i16;
-			else if (buffer == "ushort") t = t_u16;
-			else if (buffer == "int") t = t_i32;
-			else if (buffer == "uint") t = t_u32;
-			else if (buffer == "int64") t = t_i64;
-			else if (buffer == "uint64") t = t_u64;
-			else if (buffer == "if") t = t_if;
-			else if (buffer == "elif") t = t_elif;
-			else if (buffer == "else") t = t_else;
-			else if (buffer == "while") t = t_while;
-			else if (buffer == "is") t = t_is;
-			else if (buffer == "then") t = t_then;
-			else if (buffer == "do") t = t_do;
-			else if (buffer == "break") t = t_break;
-			else if (buffer == "continue") t = t_continue;
-			else if (buffer == "import") t = t_import;
-			else if (buffer == "true") t = t_true;
-			else if (buffer == "false") t = t_false;
-			else if (buffer == "and") t = t_lgand;
-			else if (buffer == "or") t = t_lgor;
-			else if (buffer == "sizeof") t = t_sizeof;
-			else if (buffer == "for") t = t_for;
-			else if (buffer == "forall") t = t_forall;
-			else if (buffer == "in") t = t_in;
-			else if (buffer == "step") t = t_step;
-			else if (buffer == "repeat") t = t_repeat;
-			else if (buffer == "enum") t = t_enum;
-			else if (buffer == "class") t = t_class;
-			else if (buffer == "extends") t = t_extends;
-			else if (buffer == "float") t = t_float;
-			else if (buffer == "double") t = t_double;
-            else if (is_integer()) {
+            token t = get_keyword();
+            if (t != t_none) {
+                // Keywords carry no value
+            } else if (is_integer()) {
                 t = t_int_literal;
                 value = buffer;
-                i_value = std::stoi(buffer);
+                i_value = std::stoi(value);
             } else if (is_hex()) {
                 t = t_int_literal;
                 value = buffer;
-                i_value = std::stoi(buffer, 0, 16);
+                i_value = std::stoi(value, 0, 16);
             } else if (is_float()) {
                 t = t_float_literal;
                 value = buffer;
-                f_value = std::stod(buffer);
+                f_value = std::stod(value);
             } else {
                 t = t_id;
                 value = buffer;
             }
             
-            buffer = "";
+            buffer = std::string_view();
             return t;
+        } else if (buffer.empty()) {
+            buffer = std::string_view(pos - 1, 1);
         } else {
-            buffer += c;
+            buffer = std::string_view(buffer.data(), pos - buffer.data());
         }
     }
     
     return t_eof;
 }
 
-std::string Lex::get_raw_buffer() {
-    std::string ret = raw_buffer;
-    raw_buffer = "";
+//
+// Returns the raw source text scanned since the last call
+//
+std::string_view Lex::get_raw_buffer() {
+    std::string_view ret(raw_start, pos - raw_start);
+    raw_start = pos;
     return ret;
 }
 
+//
+// Classifies the pending word as a keyword, or returns t_none
+//
+// The body is generated from the keyword list as a trie over the word, so
+// no string comparisons are needed.
+//
+token Lex::get_keyword() {
+    const char *s = buffer.data();
+    switch (buffer.length()) {
+		case 2: {
+			switch (s[0]) {
+				case 'i': {
+					switch (s[1]) {
+						case 'f': return t_if;
+						case 's': return t_is;
+						case 'n': return t_in;
+						default: {}
+					}
+				} break;
+				case 'd': {
+					if (s[1] == 'o') return t_do;
+				} break;
+				case 'o': {
+					if (s[1] == 'r') return t_lgor;
+				} break;
+				default: {}
+			}
+		} break;
+		case 3: {
+			switch (s[0]) {
+				case 'e': {
+					if (s[1] == 'n' && s[2] == 'd') return t_end;
+				} break;
+				case 'v': {
+					if (s[1] == 'a' && s[2] == 'r') return t_var;
+				} break;
+				case 's': {
+					if (s[1] == 't' && s[2] == 'r') return t_string;
+				} break;
+				case 'i': {
+					if (s[1] == 'n' && s[2] == 't') return t_i32;
+				} break;
+				case 'a': {
+					if (s[1] == 'n' && s[2] == 'd') return t_lgand;
+				} break;
+				case 'f': {
+					if (s[1] == 'o' && s[2] == 'r') return t_for;
+				} break;
+				default: {}
+			}
+		} break;
+		case 4: {
+			switch (s[0]) {
+				case 'f': {
+					if (s[1] == 'u' && s[2] == 'n' && s[3] == 'c') return t_func;
+				} break;
+				case 'b': {
+					switch (s[1]) {
+						case 'o': {
+							if (s[2] == 'o' && s[3] == 'l') return t_bool;
+						} break;
+						case 'y': {
+							if (s[2] == 't' && s[3] == 'e') return t_i8;
+						} break;
+						default: {}
+					}
+				} break;
+				case 'c': {
+					if (s[1] == 'h' && s[2] == 'a' && s[3] == 'r') return t_char;
+				} break;
+				case 'u': {
+					if (s[1] == 'i' && s[2] == 'n' && s[3] == 't') return t_u32;
+				} break;
+				case 'e': {
+					switch (s[1]) {
+						case 'l': {
+							switch (s[2]) {
+								case 'i': {
+									if (s[3] == 'f') return t_elif;
+								} break;
+								case 's': {
+									if (s[3] == 'e') return t_else;
+								} break;
+								default: {}
+							}
+						} break;
+						case 'n': {
+							if (s[2] == 'u' && s[3] == 'm') return t_enum;
+						} break;
+						default: {}
+					}
+				} break;
+				case 't': {
+					switch (s[1]) {
+						case 'h': {
+							if (s[2] == 'e' && s[3] == 'n') return t_then;
+						} break;
+						case 'r': {
+							if (s[2] == 'u' && s[3] == 'e') return t_true;
+						} break;
+						default: {}
+					}
+				} break;
+				case 's': {
+					if (s[1] == 't' && s[2] == 'e' && s[3] == 'p') return t_step;
+				} break;
+				default: {}
+			}
+		} break;
+		case 5: {
+			switch (s[0]) {
+				case 'a': {
+					if (s[1] == 'r' && s[2] == 'r' && s[3] == 'a' && s[4] == 'y') return t_array;
+				} break;
+				case 'c': {
+					switch (s[1]) {
+						case 'o': {
+							if (s[2] == 'n' && s[3] == 's' && s[4] == 't') return t_const;
+						} break;
+						case 'l': {
+							if (s[2] == 'a' && s[3] == 's' && s[4] == 's') return t_class;
+						} break;
+						default: {}
+					}
+				} break;
+				case 'u': {
+					if (s[1] == 'b' && s[2] == 'y' && s[3] == 't' && s[4] == 'e') return t_u8;
+				} break;
+				case 's': {
+					if (s[1] == 'h' && s[2] == 'o' && s[3] == 'r' && s[4] == 't') return t_i16;
+				} break;
+				case 'i': {
+					if (s[1] == 'n' && s[2] == 't' && s[3] == '6' && s[4] == '4') return t_i64;
+				} break;
+				case 'w': {
+					if (s[1] == 'h' && s[2] == 'i' && s[3] == 'l' && s[4] == 'e') return t_while;
+				} break;
+				case 'b': {
+					if (s[1] == 'r' && s[2] == 'e' && s[3] == 'a' && s[4] == 'k') return t_break;
+				} break;
+				case 'f': {
+					switch (s[1]) {
+						case 'a': {
+							if (s[2] == 'l' && s[3] == 's' && s[4] == 'e') return t_false;
+						} break;
+						case 'l': {
+							if (s[2] == 'o' && s[3] == 'a' && s[4] == 't') return t_float;
+						} break;
+						default: {}
+					}
+				} break;
+				default: {}
+			}
+		} break;
+		case 6: {
+			switch (s[0]) {
+				case 'e': {
+					if (s[1] == 'x' && s[2] == 't' && s[3] == 'e' && s[4] == 'r' && s[5] == 'n') return t_extern;
+				} break;
+				case 's': {
+					switch (s[1]) {
+						case 't': {
+							if (s[2] == 'r' && s[3] == 'u' && s[4] == 'c' && s[5] == 't') return t_struct;
+						} break;
+						case 'i': {
+							if (s[2] == 'z' && s[3] == 'e' && s[4] == 'o' && s[5] == 'f') return t_sizeof;
+						} break;
+						default: {}
+					}
+				} break;
+				case 'r': {
+					if (s[1] == 'e') {
+						switch (s[2]) {
+							case 't': {
+								if (s[3] == 'u' && s[4] == 'r' && s[5] == 'n') return t_return;
+							} break;
+							case 'p': {
+								if (s[3] == 'e' && s[4] == 'a' && s[5] == 't') return t_repeat;
+							} break;
+							default: {}
+						}
+					}
+				} break;
+				case 'u': {
+					switch (s[1]) {
+						case 's': {
+							if (s[2] == 'h' && s[3] == 'o' && s[4] == 'r' && s[5] == 't') return t_u16;
+						} break;
+						case 'i': {
+							if (s[2] == 'n' && s[3] == 't' && s[4] == '6' && s[5] == '4') return t_u64;
+						} break;
+						default: {}
+					}
+				} break;
+				case 'i': {
+					if (s[1] == 'm' && s[2] == 'p' && s[3] == 'o' && s[4] == 'r' && s[5] == 't') return t_import;
+				} break;
+				case 'f': {
+					if (s[1] == 'o' && s[2] == 'r' && s[3] == 'a' && s[4] == 'l' && s[5] == 'l') return t_forall;
+				} break;
+				case 'd': {
+					if (s[1] == 'o' && s[2] == 'u' && s[3] == 'b' && s[4] == 'l' && s[5] == 'e') return t_double;
+				} break;
+				default: {}
+			}
+		} break;
+		case 7: {
+			if (s[0] == 'e' && s[1] == 'x' && s[2] == 't' && s[3] == 'e' && s[4] == 'n' && s[5] == 'd' && s[6] == 's') return t_extends;
+		} break;
+		case 8: {
+			if (s[0] == 'c' && s[1] == 'o' && s[2] == 'n' && s[3] == 't' && s[4] == 'i' && s[5] == 'n' && s[6] == 'u' && s[7] == 'e') return t_continue;
+		} break;
+        default: {}
+    }
+    return t_none;
+}
+
 bool Lex::is_symbol(char c) {
     switch (c) {
 		case '.': return true;
@@ -213,15 +407,15 @@ bool Lex::is_symbol(char c) {
 token Lex::get_symbol(char c) {
     switch (c) {
 		case '.': {
-			char c2 = reader.get();
-			if (c2 == '.') {
-				raw_buffer += c2;
-				return t_range;
-			} else {
-				reader.unget();
-				return t_dot;
+			switch ((pos < end) ? *pos : 0) {
+				case '.': {
+					++pos;
+					return t_range;
+				}
+				default: {}
 			}
-		} break;
+			return t_dot;
+		}
 		case ';': return t_semicolon;
 		case ',': return t_comma;
 		case '(': return t_lparen;
@@ -230,15 +424,15 @@ token Lex::get_symbol(char c) {
 		case ']': return t_rbracket;
 		case '+': return t_plus;
 		case '-': {
-			char c2 = reader.get();
-			if (c2 == '>') {
-				raw_buffer += c2;
-				return t_arrow;
-			} else {
-				reader.unget();
-				return t_minus;
+			switch ((pos < end) ? *pos : 0) {
+				case '>': {
+					++pos;
+					return t_arrow;
+				}
+				default: {}
 			}
-		} break;
+			return t_minus;
+		}
 		case '*': return t_mul;
 		case '/': return t_div;
 		case '%': return t_mod;
@@ -246,48 +440,50 @@ token Lex::get_symbol(char c) {
 		case '|': return t_or;
 		case '^': return t_xor;
 		case ':': {
-			char c2 = reader.get();
-			if (c2 == '=') {
-				raw_buffer += c2;
-				return t_assign;
-			} else 			if (c2 == ':') {
-				raw_buffer += c2;
-				return t_scope;
-			} else {
-				reader.unget();
-				return t_colon;
+			switch ((pos < end) ? *pos : 0) {
+				case '=': {
+					++pos;
+					return t_assign;
+				}
+				case ':': {
+					++pos;
+					return t_scope;
+				}
+				default: {}
 			}
-		} break;
+			return t_colon;
+		}
 		case '>': {
-			char c2 = reader.get();
-			if (c2 == '=') {
-				raw_buffer += c2;
-				return t_gte;
-			} else {
-				reader.unget();
-				return t_gt;
+			switch ((pos < end) ? *pos : 0) {
+				case '=': {
+					++pos;
+					return t_gte;
+				}
+				default: {}
 			}
-		} break;
+			return t_gt;
+		}
 		case '<': {
-			char c2 = reader.get();
-			if (c2 == '=') {
-				raw_buffer += c2;
-				return t_lte;
-			} else {
-				reader.unget();
-				return t_lt;
+			switch ((pos < end) ? *pos : 0) {
+				case '=': {
+					++pos;
+					return t_lte;
+				}
+				default: {}
 			}
-		} break;
+			return t_lt;
+		}
 		case '=': return t_eq;
 		case '!': {
-			char c2 = reader.get();
-			if (c2 == '=') {
-				raw_buffer += c2;
-				return t_neq;
-			} else {
-				reader.unget();
+			switch ((pos < end) ? *pos : 0) {
+				case '=': {
+					++pos;
+					return t_neq;
+				}
+				default: {}
 			}
-		} break;
+			return t_none;
+		}
 		case '@': return t_annot;
         default: return t_none;
     }
@@ -1,10 +1,11 @@
 #pragma once
 
 #include <string>
-#include <fstream>
+#include <string_view>
 #include <stack>
 
 #include <parser/base_lex.hpp>
+#include <parser/source_buffer.hpp>
 
 //
 // Represents token data
@@ -102,14 +103,18 @@ struct Lex : BaseLex {
     int get_next() override;
     void debug_token(int t) override;
     
-    std::string get_raw_buffer();
+    std::string_view get_raw_buffer();
 private:
-    std::ifstream reader;
-    std::string buffer = "";
-    std::string raw_buffer = "";
+    SourceBuffer source;
+    const char *pos = nullptr;
+    const char *end = nullptr;
+    const char *raw_start = nullptr;
+    std::string_view buffer;
     std::stack<token> token_stack;
     
     // Internal functions
+    token scan();
+    token get_keyword();
     bool is_symbol(char c);
     token get_symbol(char c);
     bool is_integer();
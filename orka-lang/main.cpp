@@ -8,32 +8,71 @@
 #include <cstdio>
 #include <memory>
 #include <cstdlib>
+#include <vector>
+#include <future>
 
 #include <parser/Parser.hpp>
 #include <ast/ast.hpp>
+#include <ast/ast_binary.hpp>
 #include <midend/midend.hpp>
 #include <midend/parallel_midend.hpp>
+#include <midend/constant_fold_midend.hpp>
+#include <midend/dead_code_midend.hpp>
+#include <parser/thread_pool.hpp>
+#include <parser/import_cache.hpp>
 
 #include <llvm/Compiler.hpp>
 
 bool isError = false;
 
-std::shared_ptr<AstTree> getAstTree(std::string input, bool testLex, bool printAst, bool emitDot) {
+std::shared_ptr<AstTree> parseFile(std::string input) {
     std::unique_ptr<Parser> frontend = std::make_unique<Parser>(input);
-    std::shared_ptr<AstTree> tree;
-    
+    if (!frontend->parse()) return nullptr;
+    return frontend->getTree();
+}
+
+//
+// Parses each input on the thread pool, then merges the trees in the order
+// the files were given on the command line
+//
+std::shared_ptr<AstTree> getAstTree(std::vector<std::string> inputs, size_t jobs, bool testLex, bool optimize, bool printStats) {
     if (testLex) {
-        frontend->debugScanner();
+        for (auto const &input : inputs) {
+            std::unique_ptr<Parser> frontend = std::make_unique<Parser>(input);
+            frontend->debugScanner();
+        }
         isError = false;
         return nullptr;
     }
     
-    if (!frontend->parse()) {
-        isError = true;
-        return nullptr;
+    std::vector<std::future<std::shared_ptr<AstTree>>> results;
+    {
+        ThreadPool pool(inputs.size() > 1 ? jobs : 0);
+        for (auto const &input : inputs) {
+            results.push_back(pool.submit(parseFile, input));
+        }
     }
     
-    tree = frontend->getTree();
+    std::shared_ptr<AstTree> tree;
+    for (auto &result : results) {
+        auto tree2 = result.get();
+        if (tree2 == nullptr) {
+            isError = true;
+        } else if (tree == nullptr) {
+            tree = tree2;
+        } else {
+            tree->merge(tree2);
+        }
+    }
+    
+    if (isError) return nullptr;
+    
+    // Fold constant expressions. This is left out when the tree is only being
+    // printed, so that the dump shows the program as written.
+    if (optimize) {
+        auto folder = std::make_unique<ConstantFoldMidend>(tree);
+        folder->run();
+    }
     
     // Run the general midend
     auto midend1 = std::make_unique<Midend>(tree);
@@ -45,24 +84,17 @@ std::shared_ptr<AstTree> getAstTree(std::string input, bool testLex, bool printA
     midend2->run();
     tree = midend2->tree;
     
-    if (printAst) {
-        tree->print();
-        return nullptr;
-    }
-    
-    if (emitDot) {
-        tree->dot();
-        return nullptr;
+    // Remove the code that main never reaches. Like folding, this is left out
+    // of the dumps.
+    if (optimize) {
+        auto dce = std::make_unique<DeadCodeMidend>(tree);
+        dce->run();
+        if (printStats) dce->print_stats(std::cerr);
     }
     
     return tree;
 }
 
-void assemble(CFlags cflags) {
-    std::string cmd = "as /tmp/" + cflags.name + ".asm -o /tmp/" + cflags.name + ".o";
-    system(cmd.c_str());
-}
-
 #ifdef DEV_LINK_MODE
 
 #ifndef LINK_CORELIB_LOCATION
@@ -77,39 +109,76 @@ void assemble(CFlags cflags) {
 #define LINK_MEMGC_LOCATION = "."
 #endif
 
-void link(CFlags cflags) {
-    std::string cmd = "ld ";
-    cmd += "/usr/lib/x86_64-linux-gnu/crt1.o ";
-    cmd += "/usr/lib/x86_64-linux-gnu/crti.o ";
-    cmd += "/usr/lib/x86_64-linux-gnu/crtn.o ";
-    cmd += "/tmp/" + cflags.name + ".o -o " + cflags.name;
-    cmd += " -L" + std::string(LINK_MEMGC_LOCATION) + " -lmemgc ";
-    //cmd += " -L" + std::string(LINK_STDLIB_LOCATION) + " -lstdlib ";
-    cmd += " -L" + std::string(LINK_CORELIB_LOCATION) + " -lcorelib ";
-    cmd += " -dynamic-linker /lib64/ld-linux-x86-64.so.2 ";
-    cmd += "-lc -lomp5";
-    //cmd += "-lomp5 ";
-    //cmd += " -L" + std::string(LINK_STDLIB_LOCATION) + " -lstdlib ";
-    system(cmd.c_str());
-    //printf("LINK: %s\n", cmd.c_str());
+bool link(CFlags cflags, std::vector<std::string> objects) {
+    std::vector<std::string> args;
+    args.push_back("/usr/lib/x86_64-linux-gnu/crt1.o");
+    args.push_back("/usr/lib/x86_64-linux-gnu/crti.o");
+    args.push_back("/usr/lib/x86_64-linux-gnu/crtn.o");
+    for (auto const &object : objects) args.push_back(object);
+    args.push_back("-o");
+    args.push_back(cflags.name);
+    args.push_back("-L" + std::string(LINK_MEMGC_LOCATION));
+    args.push_back("-lmemgc");
+    //args.push_back("-L" + std::string(LINK_STDLIB_LOCATION));
+    //args.push_back("-lstdlib");
+    args.push_back("-L" + std::string(LINK_CORELIB_LOCATION));
+    args.push_back("-lcorelib");
+    args.push_back("-dynamic-linker");
+    args.push_back("/lib64/ld-linux-x86-64.so.2");
+    args.push_back("-lc");
+    args.push_back("-lomp5");
+    return runLinker(args);
+}
+
+// The libraries that link() uses, for running in process
+std::vector<std::string> runtimeLibraries(CFlags cflags) {
+    return {
+        std::string(LINK_MEMGC_LOCATION) + "/libmemgc.a",
+        std::string(LINK_CORELIB_LOCATION) + "/libcorelib.a",
+        "libomp5.so"
+    };
 }
 
 #else
 
-void link(CFlags cflags) {
+bool link(CFlags cflags, std::vector<std::string> objects) {
     /*std::string cmd = "ld ";
     cmd += "/usr/local/lib/tinylang/ti_start.o ";
     cmd += "/tmp/" + cflags.name + ".o -o " + cflags.name;
     cmd += " -dynamic-linker /lib64/ld-linux-x86-64.so.2 ";
     cmd += "-ltinylang -lc";
     system(cmd.c_str());*/
+    return true;
+}
+
+std::vector<std::string> runtimeLibraries(CFlags cflags) {
+    return {};
 }
 
 #endif
 
-int compileLLVM(std::shared_ptr<AstTree> tree, CFlags flags, bool printLLVM, bool emitLLVM) {
+//
+// Builds one object per function, reusing the cached ones. Returns false if
+// the program has to be built as a whole instead.
+//
+bool compileIncremental(std::shared_ptr<AstTree> tree, CFlags flags, bool printStats) {
+    std::vector<std::string> objects;
+    std::unique_ptr<Compiler> compiler = std::make_unique<Compiler>(tree, flags);
+    if (!compiler->compileIncremental(objects)) return false;
+    
+    if (printStats) compiler->printIncrementalStats(std::cerr);
+    if (!link(flags, objects)) isError = true;
+    return true;
+}
+
+int compileLLVM(std::shared_ptr<AstTree> tree, CFlags flags, bool printLLVM, bool emitLLVM, bool emitAsm, bool run, bool lazy, bool incremental, bool printStats) {
+    if (incremental && !printLLVM && !emitLLVM && !emitAsm && !run) {
+        if (compileIncremental(tree, flags, printStats)) return isError ? 1 : 0;
+    }
+    
     std::unique_ptr<Compiler> compiler = std::make_unique<Compiler>(tree, flags);
     compiler->compile();
+    compiler->optimize();
         
     if (printLLVM) {
         compiler->debug();
@@ -125,12 +194,28 @@ int compileLLVM(std::shared_ptr<AstTree> tree, CFlags flags, bool printLLVM, boo
         compiler->emitLLVM(output);
         return 0;
     }
+    
+    if (emitAsm) {
+        std::string output = flags.name;
+        if (output == "a.out") {
+            output = "./out.s";
+        }
         
-    compiler->writeAssembly();
-    assemble(flags);
-    link(flags);
+        compiler->writeAssembly(output);
+        return 0;
+    }
+    
+    if (run) {
+        return compiler->run(runtimeLibraries(flags), { flags.name }, lazy);
+    }
     
-    return 0;
+    std::string object;
+    if (!compiler->writeObject(object)) return 1;
+    
+    bool linked = link(flags, { object });
+    remove(object.c_str());
+    
+    return linked ? 0 : 1;
 }
 
 int main(int argc, char **argv) {
@@ -145,13 +230,21 @@ int main(int argc, char **argv) {
     flags.use_memgc = true;
     
     // Other flags
-    std::string input = "";
+    std::vector<std::string> inputs;
+    size_t jobs = ThreadPool::default_count();
     bool emitPreproc = false;
     bool testLex = false;
     bool printAst = false;
     bool emitDot = false;
     bool printLLVM = false;
     bool emitLLVM = false;
+    bool emitAsm = false;
+    bool run = false;
+    bool lazy = false;
+    bool printStats = false;
+    bool incremental = false;
+    std::string emitAst = "";
+    std::string fromAst = "";
     
     for (int i = 1; i<argc; i++) {
         std::string arg = argv[i];
@@ -168,24 +261,91 @@ int main(int argc, char **argv) {
             printLLVM = true;
         } else if (arg == "--emit-llvm") {
             emitLLVM = true;
+        } else if (arg == "-S") {
+            emitAsm = true;
+        } else if (arg == "--run") {
+            run = true;
+        } else if (arg == "--lazy") {
+            lazy = true;
+        } else if (arg.rfind("--emit-ast=", 0) == 0) {
+            emitAst = arg.substr(11);
+        } else if (arg.rfind("--from-ast=", 0) == 0) {
+            fromAst = arg.substr(11);
+        } else if (arg == "--incremental") {
+            incremental = true;
+        } else if (arg == "--stats") {
+            printStats = true;
+        } else if (arg == "-O0" || arg == "-O1" || arg == "-O2" || arg == "-O3") {
+            flags.opt_level = arg[2] - '0';
+        } else if (arg == "-Os") {
+            flags.opt_level = 2;
+            flags.opt_size = true;
+        } else if (arg == "--time-passes") {
+            flags.time_passes = true;
+        } else if (arg.rfind("-march=", 0) == 0) {
+            flags.cpu = arg.substr(7);
+        } else if (arg.rfind("-mcpu=", 0) == 0) {
+            flags.cpu = arg.substr(6);
+        } else if (arg.rfind("-mattr=", 0) == 0) {
+            flags.features = arg.substr(7);
         } else if (arg == "-o") {
             flags.name = argv[i+1];
             i += 1;
+        } else if (arg == "-j") {
+            jobs = std::stoi(argv[i+1]);
+            i += 1;
         } else if (arg[0] == '-') {
             std::cerr << "Invalid option: " << arg << std::endl;
             return 1;
         } else {
-            input = arg;
+            inputs.push_back(arg);
+        }
+    }
+    
+    if (inputs.empty() && fromAst == "") {
+        std::cerr << "Error: No input file specified." << std::endl;
+        return 1;
+    }
+    
+    // A saved tree has already been through the midends, so it goes straight
+    // to the backend
+    std::shared_ptr<AstTree> tree;
+    if (fromAst != "") {
+        tree = AstBinary::load(fromAst);
+        if (tree == nullptr) {
+            std::cerr << "Error: Unable to load AST from " << fromAst << "." << std::endl;
+            return 1;
         }
+    } else {
+        tree = getAstTree(inputs, jobs, testLex, !printAst && !emitDot, printStats);
     }
     
-    std::shared_ptr<AstTree> tree = getAstTree(input, testLex, printAst, emitDot);
+    if (printStats) ImportCache::print_stats(std::cerr);
+    
     if (tree == nullptr) {
         if (isError) return 1;
         return 0;
     }
+    
+    if (printAst) {
+        tree->print();
+        return 0;
+    }
+    
+    if (emitDot) {
+        tree->dot();
+        return 0;
+    }
+    
+    if (emitAst != "") {
+        if (!AstBinary::save(tree, emitAst)) {
+            std::cerr << "Error: Unable to write AST to " << emitAst << "." << std::endl;
+            return 1;
+        }
+        return 0;
+    }
 
     // Compile
-    return compileLLVM(tree, flags, printLLVM, emitLLVM);
+    return compileLLVM(tree, flags, printLLVM, emitLLVM, emitAsm, run, lazy, incremental, printStats);
 }
 
@@ -11,6 +11,7 @@
 
 #include <parser/Parser.hpp>
 #include <ast/ast.hpp>
+#include <midend/constant_fold_midend.hpp>
 #include <java/JavaCompiler.hpp>
 
 int main(int argc, char **argv) {
@@ -52,6 +53,9 @@ int main(int argc, char **argv) {
         return 0;
     }
     
+    auto folder = std::make_unique<ConstantFoldMidend>(tree);
+    folder->run();
+    
     // Finally, run the java compiler
     std::string className = GetClassName(input);
     std::cout << "Output: " << className << ".class" << std::endl;
@@ -44,26 +44,26 @@ std::shared_ptr<AstExpression> Midend::process_binary_op(std::shared_ptr<AstBina
         return nullptr;
     }
     
-    auto args = std::make_shared<AstExprList>();
+    auto args = AstContext::make<AstExprList>();
     args->add_expression(lval);
     args->add_expression(rval);
 
     if (expr->type == V_AstType::EQ || expr->type == V_AstType::NEQ) {
-        auto fc = std::make_shared<AstFuncCallExpr>("stringcmp");
+        auto fc = AstContext::make<AstFuncCallExpr>(Symbol("stringcmp"));
         fc->args = args;
         expr->lval = fc;
         
         if (expr->type == V_AstType::NEQ)
-            expr->rval = std::make_shared<AstInt>(0);
+            expr->rval = AstContext::make<AstInt>(0);
         else
-            expr->rval = std::make_shared<AstInt>(1);
+            expr->rval = AstContext::make<AstInt>(1);
     } else if (expr->type == V_AstType::Add) {
         if (rval_str) {
-            auto fc = std::make_shared<AstFuncCallExpr>("strcat_str");
+            auto fc = AstContext::make<AstFuncCallExpr>(Symbol("strcat_str"));
             fc->args = args;
             return fc;
         } else {
-            auto fc = std::make_shared<AstFuncCallExpr>("strcat_char");
+            auto fc = AstContext::make<AstFuncCallExpr>(Symbol("strcat_char"));
             fc->args = args;
             return fc;
         }
@@ -14,9 +14,9 @@
 // Builds a constant expression value
 std::shared_ptr<AstExpression> Parser::build_constant(int tk) {
     switch (tk) {
-        case t_true: return std::make_shared<AstInt>(1);
-        case t_false: return std::make_shared<AstInt>(0);
-        case t_char_literal: return std::make_shared<AstChar>((char)lex->i_value);
+        case t_true: return AstContext::make<AstInt>(1);
+        case t_false: return AstContext::make<AstInt>(0);
+        case t_char_literal: return AstContext::make<AstChar>((char)lex->i_value);
         case t_int_literal: {
             int value = lex->i_value;
             int tk_next = lex->get_next();
@@ -30,13 +30,13 @@ std::shared_ptr<AstExpression> Parser::build_constant(int tk) {
                 int value2 = lex->i_value;
                 std::string buffer = std::to_string(value) + "." + std::to_string(value2);
                 double f_value = std::stod(buffer);
-                return std::make_shared<AstFloat>(f_value);
+                return AstContext::make<AstFloat>(f_value);
             }
             lex->unget(tk_next);
-            return std::make_shared<AstInt>(value);
+            return AstContext::make<AstInt>(value);
         }
-        case t_float_literal: return std::make_shared<AstFloat>(lex->f_value);
-        case t_string_literal: return std::make_shared<AstString>(lex->value);
+        case t_float_literal: return AstContext::make<AstFloat>(lex->f_value);
+        case t_string_literal: return AstContext::make<AstString>(lex->value);
         
         default: {}
     }
@@ -64,36 +64,39 @@ bool Parser::build_operator(int tk, std::shared_ptr<ExprContext> ctx) {
         case t_lte:
         case t_lgand:
         case t_lgor: {
-            std::shared_ptr<AstBinaryOp> op = std::make_shared<AstBinaryOp>();
-            std::shared_ptr<AstUnaryOp> op1 = std::make_shared<AstUnaryOp>();
+            std::shared_ptr<AstBinaryOp> op = nullptr;
+            std::shared_ptr<AstUnaryOp> op1 = nullptr;
             bool useUnary = false;
             switch (tk) {
-                case t_assign: op = std::make_shared<AstAssignOp>(); break;
-                case t_plus: op = std::make_shared<AstAddOp>(); break;
-                case t_mul: op = std::make_shared<AstMulOp>(); break;
-                case t_div: op = std::make_shared<AstDivOp>(); break;
-                case t_mod: op = std::make_shared<AstModOp>(); break;
-                case t_and: op = std::make_shared<AstAndOp>(); break;
-                case t_or: op = std::make_shared<AstOrOp>(); break;
-                case t_xor: op = std::make_shared<AstXorOp>(); break;
-                case t_eq: op = std::make_shared<AstEQOp>(); break;
-                case t_neq: op = std::make_shared<AstNEQOp>(); break;
-                case t_gt: op = std::make_shared<AstGTOp>(); break;
-                case t_lt: op = std::make_shared<AstLTOp>(); break;
-                case t_gte: op = std::make_shared<AstGTEOp>(); break;
-                case t_lte: op = std::make_shared<AstLTEOp>(); break;
-                case t_lgand: op = std::make_shared<AstLogicalAndOp>(); break;
-                case t_lgor: op = std::make_shared<AstLogicalOrOp>(); break;
+                case t_assign: op = AstContext::make<AstAssignOp>(); break;
+                case t_plus: op = AstContext::make<AstAddOp>(); break;
+                case t_mul: op = AstContext::make<AstMulOp>(); break;
+                case t_div: op = AstContext::make<AstDivOp>(); break;
+                case t_mod: op = AstContext::make<AstModOp>(); break;
+                case t_and: op = AstContext::make<AstAndOp>(); break;
+                case t_or: op = AstContext::make<AstOrOp>(); break;
+                case t_xor: op = AstContext::make<AstXorOp>(); break;
+                case t_eq: op = AstContext::make<AstEQOp>(); break;
+                case t_neq: op = AstContext::make<AstNEQOp>(); break;
+                case t_gt: op = AstContext::make<AstGTOp>(); break;
+                case t_lt: op = AstContext::make<AstLTOp>(); break;
+                case t_gte: op = AstContext::make<AstGTEOp>(); break;
+                case t_lte: op = AstContext::make<AstLTEOp>(); break;
+                case t_lgand: op = AstContext::make<AstLogicalAndOp>(); break;
+                case t_lgor: op = AstContext::make<AstLogicalOrOp>(); break;
                 case t_minus: {
                     if (ctx->lastWasOp) {
-                        op1 = std::make_shared<AstNegOp>();
+                        op1 = AstContext::make<AstNegOp>();
                         useUnary = true;
                     } else {
-                        op = std::make_shared<AstSubOp>();
+                        op = AstContext::make<AstSubOp>();
                     }
                 } break;
             }
             
+            // Only allocate a placeholder for operators with no node of their own
+            if (op == nullptr && !useUnary) op = AstContext::make<AstBinaryOp>();
+            
             post_process_operator(ctx, op, op1, useUnary);
         } break;
         
@@ -108,8 +111,9 @@ bool Parser::build_identifier(std::shared_ptr<AstBlock> block, int tk, std::shar
     int currentLine = 0;
 
     std::string name = lex->value;
+    Symbol sym = Symbol::find(name);
     if (ctx->varType && ctx->varType->type == V_AstType::Void) {
-        ctx->varType = block->getDataType(name);
+        ctx->varType = block->getDataType(sym);
         if (ctx->varType && ctx->varType->type == V_AstType::Ptr)
             ctx->varType = std::static_pointer_cast<AstPointerType>(ctx->varType)->base_type;
     }
@@ -122,12 +126,12 @@ bool Parser::build_identifier(std::shared_ptr<AstBlock> block, int tk, std::shar
             return false;
         }
         
-        if (block->symbolTable[name]->type == V_AstType::String) {
-            std::shared_ptr<AstArrayAccess> acc = std::make_shared<AstArrayAccess>(name);
+        if (block->getDataType(sym)->type == V_AstType::String) {
+            std::shared_ptr<AstArrayAccess> acc = AstContext::make<AstArrayAccess>(Symbol(name));
             acc->index = index;
             ctx->output.push(acc);
         } else {
-            std::shared_ptr<AstStructAccess> sa_acc = std::make_shared<AstStructAccess>(name, "ptr");
+            std::shared_ptr<AstStructAccess> sa_acc = AstContext::make<AstStructAccess>(Symbol(name), Symbol("ptr"));
             sa_acc->access_expression = index;
             ctx->output.push(sa_acc);
         }
@@ -136,12 +140,12 @@ bool Parser::build_identifier(std::shared_ptr<AstBlock> block, int tk, std::shar
             syntax->addWarning(0, "Function call on newline- possible logic error.");
         }
         
-        if (!block->isFunc(name) && !java) {
+        if (!block->isFunc(sym) && !java) {
             syntax->addError(0, "Unknown function call: " + name);
             return false;
         }
     
-        std::shared_ptr<AstFuncCallExpr> fc = std::make_shared<AstFuncCallExpr>(name);
+        std::shared_ptr<AstFuncCallExpr> fc = AstContext::make<AstFuncCallExpr>(Symbol(name));
         std::shared_ptr<AstExpression> args = buildExpression(block, ctx->varType, t_rparen, false, true);
         fc->args = args;
         
@@ -156,14 +160,16 @@ bool Parser::build_identifier(std::shared_ptr<AstBlock> block, int tk, std::shar
         
         tk = lex->get_next();
         if (tk == t_lparen) {
-            std::string className = classMap[name];
+            std::string className = "";
+            auto found = classMap.find(sym);
+            if (found != classMap.end()) className = found->second;
             std::string func_name = lex->value;
             if (!java) {
                 func_name = className + "_" + lex->value;
             }
             
-            auto fc = std::make_shared<AstFuncCallExpr>(func_name);
-            auto id = std::make_shared<AstID>(name);
+            auto fc = AstContext::make<AstFuncCallExpr>(Symbol(func_name));
+            auto id = AstContext::make<AstID>(Symbol(name));
             fc->object_name = id->value;
             
             std::shared_ptr<AstExpression> args2 = buildExpression(block, ctx->varType, t_rparen, false, true);
@@ -175,12 +181,12 @@ bool Parser::build_identifier(std::shared_ptr<AstBlock> block, int tk, std::shar
         } else {
             lex->unget(tk);
             
-            std::shared_ptr<AstStructAccess> val = std::make_shared<AstStructAccess>(name, id_value);
+            std::shared_ptr<AstStructAccess> val = AstContext::make<AstStructAccess>(Symbol(name), Symbol(id_value));
             ctx->output.push(val);
         }
         
     } else if (tk == t_scope) {
-        if (enums.find(name) == enums.end()) {
+        if (enums.find(sym) == enums.end()) {
             syntax->addError(lex->line_number, "Unknown enum.");
             return false;
         }
@@ -191,22 +197,16 @@ bool Parser::build_identifier(std::shared_ptr<AstBlock> block, int tk, std::shar
             return false;
         }
         
-        AstEnum dec = enums[name];
-        std::shared_ptr<AstExpression> val = dec.values[lex->value];
+        AstEnum dec = enums[sym];
+        std::shared_ptr<AstExpression> val = dec.values[Symbol::find(lex->value)];
         ctx->output.push(val);
     } else {
-        int constVal = block->isConstant(name);
-        if (constVal > 0) {
-            if (constVal == 1) {
-                std::shared_ptr<AstExpression> expr = block->globalConsts[name].second;
-                ctx->output.push(expr);
-            } else if (constVal == 2) {
-                std::shared_ptr<AstExpression> expr = block->localConsts[name].second;
-                ctx->output.push(expr);
-            }
+        std::shared_ptr<AstExpression> constant = block->getConstant(sym);
+        if (constant != nullptr) {
+            ctx->output.push(constant);
         } else {
-            if (block->isVar(name)) {
-                std::shared_ptr<AstID> id = std::make_shared<AstID>(name);
+            if (block->isVar(sym)) {
+                std::shared_ptr<AstID> id = AstContext::make<AstID>(sym);
                 ctx->output.push(id);
             } else {
                 syntax->addError(lex->line_number, "Unknown variable: " + name);
@@ -304,7 +304,7 @@ bool Parser::build_other_token(int tk, bool is_const, std::shared_ptr<ExprContex
                 return false;
             }
             
-            std::shared_ptr<AstStructAccess> val = std::make_shared<AstStructAccess>(token2_value, "size");
+            std::shared_ptr<AstStructAccess> val = AstContext::make<AstStructAccess>(Symbol(token2_value), Symbol("size"));
             ctx->output.push(val);
             
             return true;
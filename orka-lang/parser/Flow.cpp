@@ -20,15 +20,15 @@ std::shared_ptr<AstExpression> Parser::checkCondExpression(std::shared_ptr<AstBl
         case V_AstType::ID: {
             std::shared_ptr<AstID> id = std::static_pointer_cast<AstID>(toCheck);
             std::shared_ptr<AstDataType> dataType = block->getDataType(id->value);            
-            std::shared_ptr<AstEQOp> eq = std::make_shared<AstEQOp>();
+            std::shared_ptr<AstEQOp> eq = AstContext::make<AstEQOp>();
             eq->lval = id;
             
             switch (dataType->type) {
-                case V_AstType::Bool: eq->rval = std::make_shared<AstInt>(1); break;
-                case V_AstType::Int8: eq->rval = std::make_shared<AstInt>(1, 8); break;
-                case V_AstType::Int16: eq->rval = std::make_shared<AstInt>(1, 16); break;
-                case V_AstType::Int32: eq->rval = std::make_shared<AstInt>(1); break;
-                case V_AstType::Int64: eq->rval = std::make_shared<AstInt>(1, 64); break;
+                case V_AstType::Bool: eq->rval = AstContext::make<AstInt>(1); break;
+                case V_AstType::Int8: eq->rval = AstContext::make<AstInt>(1, 8); break;
+                case V_AstType::Int16: eq->rval = AstContext::make<AstInt>(1, 16); break;
+                case V_AstType::Int32: eq->rval = AstContext::make<AstInt>(1); break;
+                case V_AstType::Int64: eq->rval = AstContext::make<AstInt>(1, 64); break;
                 
                 default: {}
             }
@@ -37,9 +37,9 @@ std::shared_ptr<AstExpression> Parser::checkCondExpression(std::shared_ptr<AstBl
         } break;
         
         case V_AstType::IntL: {
-            std::shared_ptr<AstEQOp> eq = std::make_shared<AstEQOp>();
+            std::shared_ptr<AstEQOp> eq = AstContext::make<AstEQOp>();
             eq->lval = expr;
-            eq->rval = std::make_shared<AstInt>(1);
+            eq->rval = AstContext::make<AstInt>(1);
             expr = eq;
         } break;
         
@@ -51,7 +51,7 @@ std::shared_ptr<AstExpression> Parser::checkCondExpression(std::shared_ptr<AstBl
 
 // Builds a conditional statement
 bool Parser::buildConditional(std::shared_ptr<AstBlock> block) {
-    std::shared_ptr<AstIfStmt> cond = std::make_shared<AstIfStmt>();
+    std::shared_ptr<AstIfStmt> cond = AstContext::make<AstIfStmt>();
     std::shared_ptr<AstExpression> arg = buildExpression(block, nullptr, t_then);
     if (!arg) return false;
     cond->expression = arg;
@@ -60,12 +60,12 @@ bool Parser::buildConditional(std::shared_ptr<AstBlock> block) {
     std::shared_ptr<AstExpression> expr = checkCondExpression(block, cond->expression);
     cond->expression = expr;
     
-    std::shared_ptr<AstBlock> true_block = std::make_shared<AstBlock>();
-    true_block->mergeSymbols(block);
+    std::shared_ptr<AstBlock> true_block = AstContext::make<AstBlock>();
+    true_block->setParent(block);
     cond->true_block = true_block;
     
-    std::shared_ptr<AstBlock> false_block = std::make_shared<AstBlock>();
-    false_block->mergeSymbols(block);
+    std::shared_ptr<AstBlock> false_block = AstContext::make<AstBlock>();
+    false_block->setParent(block);
     cond->false_block = false_block;
     buildBlock(true_block, cond);
     
@@ -74,7 +74,7 @@ bool Parser::buildConditional(std::shared_ptr<AstBlock> block) {
 
 // Builds a while statement
 bool Parser::buildWhile(std::shared_ptr<AstBlock> block) {
-    std::shared_ptr<AstWhileStmt> loop = std::make_shared<AstWhileStmt>();
+    std::shared_ptr<AstWhileStmt> loop = AstContext::make<AstWhileStmt>();
     std::shared_ptr<AstExpression> arg = buildExpression(block, nullptr, t_do);
     if (!arg) return false;
     loop->expression = arg;
@@ -83,8 +83,8 @@ bool Parser::buildWhile(std::shared_ptr<AstBlock> block) {
     std::shared_ptr<AstExpression> expr = checkCondExpression(block, loop->expression);
     loop->expression = expr;
     
-    std::shared_ptr<AstBlock> block2 = std::make_shared<AstBlock>();
-    block2->mergeSymbols(block);
+    std::shared_ptr<AstBlock> block2 = AstContext::make<AstBlock>();
+    block2->setParent(block);
     buildBlock(block2);
     loop->block = block2;
     
@@ -93,11 +93,11 @@ bool Parser::buildWhile(std::shared_ptr<AstBlock> block) {
 
 // Builds an infinite loop statement
 bool Parser::buildRepeat(std::shared_ptr<AstBlock> block) {
-    std::shared_ptr<AstRepeatStmt> loop = std::make_shared<AstRepeatStmt>();
+    std::shared_ptr<AstRepeatStmt> loop = AstContext::make<AstRepeatStmt>();
     block->addStatement(loop);
     
-    std::shared_ptr<AstBlock> block2 = std::make_shared<AstBlock>();
-    block2->mergeSymbols(block);
+    std::shared_ptr<AstBlock> block2 = AstContext::make<AstBlock>();
+    block2->setParent(block);
     buildBlock(block2);
     loop->block = block2;
 
@@ -106,7 +106,7 @@ bool Parser::buildRepeat(std::shared_ptr<AstBlock> block) {
 
 // Builds a for loop
 bool Parser::buildFor(std::shared_ptr<AstBlock> block) {
-    std::shared_ptr<AstForStmt> loop = std::make_shared<AstForStmt>();
+    std::shared_ptr<AstForStmt> loop = AstContext::make<AstForStmt>();
     block->addStatement(loop);
     
     // Get the index
@@ -116,8 +116,8 @@ bool Parser::buildFor(std::shared_ptr<AstBlock> block) {
         return false;
     }
     
-    std::string idx_name = lex->value;
-    loop->index = std::make_shared<AstID>(idx_name);
+    Symbol idx_name(lex->value);
+    loop->index = AstContext::make<AstID>(idx_name);
     std::shared_ptr<AstDataType> dataType = AstBuilder::buildInt32Type();
     
     token = lex->get_next();
@@ -135,8 +135,8 @@ bool Parser::buildFor(std::shared_ptr<AstBlock> block) {
     loop->step = step;
     loop->data_type = dataType;
     
-    std::shared_ptr<AstBlock> block2 = std::make_shared<AstBlock>();
-    block2->mergeSymbols(block);
+    std::shared_ptr<AstBlock> block2 = AstContext::make<AstBlock>();
+    block2->setParent(block);
     block2->addSymbol(idx_name, dataType);
     buildBlock(block2);
     loop->block = block2;
@@ -146,7 +146,7 @@ bool Parser::buildFor(std::shared_ptr<AstBlock> block) {
 
 // Builds a forall loop
 bool Parser::buildForAll(std::shared_ptr<AstBlock> block) {
-    std::shared_ptr<AstForAllStmt> loop = std::make_shared<AstForAllStmt>();
+    std::shared_ptr<AstForAllStmt> loop = AstContext::make<AstForAllStmt>();
     block->addStatement(loop);
     
     // Get the index
@@ -156,8 +156,8 @@ bool Parser::buildForAll(std::shared_ptr<AstBlock> block) {
         return false;
     }
     
-    std::string idx_name = lex->value;
-    loop->index = std::make_shared<AstID>(idx_name);
+    Symbol idx_name(lex->value);
+    loop->index = AstContext::make<AstID>(idx_name);
     
     token = lex->get_next();
     if (token != t_in) {
@@ -172,10 +172,10 @@ bool Parser::buildForAll(std::shared_ptr<AstBlock> block) {
         return false;
     }
     
-    std::string array_name = lex->value;
-    loop->array = std::make_shared<AstID>(array_name);
+    Symbol array_name(lex->value);
+    loop->array = AstContext::make<AstID>(array_name);
     
-    auto ptrType = std::static_pointer_cast<AstStructType>(block->symbolTable[array_name]);
+    auto ptrType = std::static_pointer_cast<AstStructType>(block->getDataType(array_name));
     std::shared_ptr<AstDataType> dataType;
     for (auto const &s : tree->structs) {
         if (ptrType->name == s->name) {
@@ -191,8 +191,8 @@ bool Parser::buildForAll(std::shared_ptr<AstBlock> block) {
         return false;
     }
     
-    std::shared_ptr<AstBlock> block2 = std::make_shared<AstBlock>();
-    block2->mergeSymbols(block);
+    std::shared_ptr<AstBlock> block2 = AstContext::make<AstBlock>();
+    block2->setParent(block);
     block2->addSymbol(idx_name, dataType);
     buildBlock(block2);
     loop->block = block2;
@@ -202,8 +202,8 @@ bool Parser::buildForAll(std::shared_ptr<AstBlock> block) {
 
 // Builds a loop keyword
 bool Parser::buildLoopCtrl(std::shared_ptr<AstBlock> block, bool isBreak) {
-    if (isBreak) block->addStatement(std::make_shared<AstBreak>());
-    else block->addStatement(std::make_shared<AstContinue>());
+    if (isBreak) block->addStatement(AstContext::make<AstBreak>());
+    else block->addStatement(AstContext::make<AstContinue>());
     
     int tk = lex->get_next();
     if (tk != t_semicolon) {
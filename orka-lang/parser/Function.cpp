@@ -33,7 +33,7 @@ bool Parser::getFunctionArgs(std::shared_ptr<AstBlock> block, std::vector<Var> &
             }
             
             v.type = buildDataType();
-            v.name = name;
+            v.name = Symbol(name);
             
             tk = lex->get_next();
             if (tk == t_comma) {
@@ -73,14 +73,14 @@ bool Parser::buildFunction(int startToken, std::string className) {
     
     // Get arguments
     std::vector<Var> args;
-    std::shared_ptr<AstBlock> block = std::make_shared<AstBlock>();
+    std::shared_ptr<AstBlock> block = AstContext::make<AstBlock>();
     if (className != "") {
         Var classV;
-        classV.name = "this";
+        classV.name = Symbol("this");
         classV.type = AstBuilder::buildStructType(className);
         args.push_back(classV);
         
-        block->symbolTable["this"] = classV.type;
+        block->symbolTable[classV.name] = classV.type;
     }
     
     if (!getFunctionArgs(block, args)) return false;
@@ -105,21 +105,21 @@ bool Parser::buildFunction(int startToken, std::string className) {
     }
 
     // Create the function object
-    tree->block->funcs.push_back(funcName);
+    tree->block->funcs.insert(Symbol(funcName));
     
     if (isExtern) {
-        std::shared_ptr<AstExternFunction> ex = std::make_shared<AstExternFunction>(funcName);
+        std::shared_ptr<AstExternFunction> ex = AstContext::make<AstExternFunction>(Symbol(funcName));
         ex->args = args;
         ex->data_type = dataType;
         tree->addGlobalStatement(ex);
         return true;
     }
     
-    std::shared_ptr<AstFunction> func = std::make_shared<AstFunction>(funcName);
+    std::shared_ptr<AstFunction> func = AstContext::make<AstFunction>(Symbol(funcName));
     func->data_type = dataType;
     func->args = args;
     tree->addGlobalStatement(func);
-    func->block->mergeSymbols(tree->block);
+    func->block->setParent(tree->block);
     func->block->mergeSymbols(block);
     
     func->routine = true;
@@ -130,7 +130,7 @@ bool Parser::buildFunction(int startToken, std::string className) {
             func->routine = false;
         } else {
             std::string fullName = className + "_" + funcName;
-            func->name = fullName;
+            func->name = Symbol(fullName);
         }
     }
     
@@ -150,7 +150,7 @@ bool Parser::buildFunction(int startToken, std::string className) {
         }
     } else {
         if (func->data_type->type == V_AstType::Void) {
-            func->addStatement(std::make_shared<AstReturnStmt>());
+            func->addStatement(AstContext::make<AstReturnStmt>());
         } else {
             syntax->addError(0, "Expected return statement.");
             return false;
@@ -158,7 +158,7 @@ bool Parser::buildFunction(int startToken, std::string className) {
     }
     
     if (className != "") {
-        auto func2 = std::make_shared<AstFunction>(funcName);
+        auto func2 = AstContext::make<AstFunction>(Symbol(funcName));
         func2->data_type = dataType;
         func2->args = args;
         currentClass->addFunction(func2);
@@ -173,12 +173,12 @@ bool Parser::buildFunction(int startToken, std::string className) {
 // Builds a function call
 bool Parser::buildFunctionCallStmt(std::shared_ptr<AstBlock> block, std::string value) {
     // Make sure the function exists
-    if (!block->isFunc(value) && !java) {
+    if (!block->isFunc(Symbol::find(value)) && !java) {
         syntax->addError(lex->line_number, "Unknown function.");
         return false;
     }
 
-    std::shared_ptr<AstFuncCallStmt> fc = std::make_shared<AstFuncCallStmt>(value);
+    std::shared_ptr<AstFuncCallStmt> fc = AstContext::make<AstFuncCallStmt>(Symbol(value));
     block->addStatement(fc);
     
     std::shared_ptr<AstExpression> args = buildExpression(block, nullptr, t_semicolon, false, true);
@@ -190,7 +190,7 @@ bool Parser::buildFunctionCallStmt(std::shared_ptr<AstBlock> block, std::string
 
 // Builds a return statement
 bool Parser::buildReturn(std::shared_ptr<AstBlock> block) {
-    std::shared_ptr<AstReturnStmt> stmt = std::make_shared<AstReturnStmt>();
+    std::shared_ptr<AstReturnStmt> stmt = AstContext::make<AstReturnStmt>();
     block->addStatement(stmt);
     
     std::shared_ptr<AstExpression> arg = buildExpression(block, nullptr, t_semicolon);
@@ -6,11 +6,13 @@
 #include <iostream>
 #include <algorithm>
 #include <cstring>
+#include <cstdlib>
 #include <fstream>
 
 #include <parser/Parser.hpp>
 #include <ast/ast_builder.hpp>
 #include <lex/lex.hpp>
+#include <parser/import_cache.hpp>
 
 Parser::Parser(std::string input, bool java) : BaseParser(input) {
     lex = std::make_unique<Lex>(input);
@@ -19,122 +21,123 @@ Parser::Parser(std::string input, bool java) : BaseParser(input) {
 
 Parser::Parser(std::string input) : BaseParser(input) {
     lex = std::make_unique<Lex>(input);
+    AstContext::Scope scope(tree->context);
     
     // Add the built-in functions
     //string malloc(string)
-    tree->block->funcs.push_back("malloc");
-    std::shared_ptr<AstExternFunction> FT1 = std::make_shared<AstExternFunction>("malloc");
-    FT1->addArgument(Var(AstBuilder::buildInt32Type(), "size"));
+    tree->block->funcs.insert(Symbol("malloc"));
+    std::shared_ptr<AstExternFunction> FT1 = AstContext::make<AstExternFunction>(Symbol("malloc"));
+    FT1->addArgument(Var(AstBuilder::buildInt32Type(), Symbol("size")));
     FT1->data_type = AstBuilder::buildStringType();
     tree->addGlobalStatement(FT1);
     
     //println(string)
-    tree->block->funcs.push_back("println");
-    std::shared_ptr<AstExternFunction> FT2 = std::make_shared<AstExternFunction>("println");
+    tree->block->funcs.insert(Symbol("println"));
+    std::shared_ptr<AstExternFunction> FT2 = AstContext::make<AstExternFunction>(Symbol("println"));
     FT2->varargs = true;
-    FT2->addArgument(Var(AstBuilder::buildStringType(), "str"));
+    FT2->addArgument(Var(AstBuilder::buildStringType(), Symbol("str")));
     FT2->data_type = AstBuilder::buildVoidType();
     tree->addGlobalStatement(FT2);
     
     //print(string)
-    tree->block->funcs.push_back("print");
-    std::shared_ptr<AstExternFunction> FT3 = std::make_shared<AstExternFunction>("print");
+    tree->block->funcs.insert(Symbol("print"));
+    std::shared_ptr<AstExternFunction> FT3 = AstContext::make<AstExternFunction>(Symbol("print"));
     FT3->varargs = true;
-    FT3->addArgument(Var(AstBuilder::buildStringType(), "str"));
+    FT3->addArgument(Var(AstBuilder::buildStringType(), Symbol("str")));
     FT3->data_type = AstBuilder::buildVoidType();
     tree->addGlobalStatement(FT3);
     
     //i32 strlen(string)
-    tree->block->funcs.push_back("strlen");
-    std::shared_ptr<AstExternFunction> FT4 = std::make_shared<AstExternFunction>("strlen");
-    FT4->addArgument(Var(AstBuilder::buildStringType(), "str"));
+    tree->block->funcs.insert(Symbol("strlen"));
+    std::shared_ptr<AstExternFunction> FT4 = AstContext::make<AstExternFunction>(Symbol("strlen"));
+    FT4->addArgument(Var(AstBuilder::buildStringType(), Symbol("str")));
     FT4->data_type = AstBuilder::buildInt32Type();
     tree->addGlobalStatement(FT4);
     
     //i32 stringcmp(string, string)
-    tree->block->funcs.push_back("stringcmp");
-    std::shared_ptr<AstExternFunction> FT5 = std::make_shared<AstExternFunction>("stringcmp");
-    FT5->addArgument(Var(AstBuilder::buildStringType(), "str"));
-    FT5->addArgument(Var(AstBuilder::buildStringType(), "str"));
+    tree->block->funcs.insert(Symbol("stringcmp"));
+    std::shared_ptr<AstExternFunction> FT5 = AstContext::make<AstExternFunction>(Symbol("stringcmp"));
+    FT5->addArgument(Var(AstBuilder::buildStringType(), Symbol("str")));
+    FT5->addArgument(Var(AstBuilder::buildStringType(), Symbol("str")));
     FT5->data_type = AstBuilder::buildInt32Type();
     tree->addGlobalStatement(FT5);
     
     //string strcat_str(string, string)
-    tree->block->funcs.push_back("strcat_str");
-    std::shared_ptr<AstExternFunction> FT6 = std::make_shared<AstExternFunction>("strcat_str");
-    FT6->addArgument(Var(AstBuilder::buildStringType(), "str"));
-    FT6->addArgument(Var(AstBuilder::buildStringType(), "str"));
+    tree->block->funcs.insert(Symbol("strcat_str"));
+    std::shared_ptr<AstExternFunction> FT6 = AstContext::make<AstExternFunction>(Symbol("strcat_str"));
+    FT6->addArgument(Var(AstBuilder::buildStringType(), Symbol("str")));
+    FT6->addArgument(Var(AstBuilder::buildStringType(), Symbol("str")));
     FT6->data_type = AstBuilder::buildStringType();
     tree->addGlobalStatement(FT6);
     
     //string strcat_char(string, char)
-    tree->block->funcs.push_back("strcat_char");
-    std::shared_ptr<AstExternFunction> FT7 = std::make_shared<AstExternFunction>("strcat_char");
-    FT7->addArgument(Var(AstBuilder::buildStringType(), "str"));
-    FT7->addArgument(Var(AstBuilder::buildCharType(), "c"));
+    tree->block->funcs.insert(Symbol("strcat_char"));
+    std::shared_ptr<AstExternFunction> FT7 = AstContext::make<AstExternFunction>(Symbol("strcat_char"));
+    FT7->addArgument(Var(AstBuilder::buildStringType(), Symbol("str")));
+    FT7->addArgument(Var(AstBuilder::buildCharType(), Symbol("c")));
     FT7->data_type = AstBuilder::buildStringType();
     tree->addGlobalStatement(FT7);
     
     // Create structures for the internal arrays
     // Int8
-    auto int8ArrayStruct = std::make_shared<AstStruct>("__int8_array");
-    int8ArrayStruct->addItem(Var(AstBuilder::buildPointerType(AstBuilder::buildInt8Type()), "ptr"), nullptr);
-    int8ArrayStruct->addItem(Var(AstBuilder::buildInt32Type(), "size"), std::make_shared<AstInt>(0));
+    auto int8ArrayStruct = AstContext::make<AstStruct>(Symbol("__int8_array"));
+    int8ArrayStruct->addItem(Var(AstBuilder::buildPointerType(AstBuilder::buildInt8Type()), Symbol("ptr")), nullptr);
+    int8ArrayStruct->addItem(Var(AstBuilder::buildInt32Type(), Symbol("size")), AstContext::make<AstInt>(0));
     tree->addStruct(int8ArrayStruct);
     
     // Int16
-    auto int16ArrayStruct = std::make_shared<AstStruct>("__int16_array");
-    int16ArrayStruct->addItem(Var(AstBuilder::buildPointerType(AstBuilder::buildInt16Type()), "ptr"), nullptr);
-    int16ArrayStruct->addItem(Var(AstBuilder::buildInt32Type(), "size"), std::make_shared<AstInt>(0));
+    auto int16ArrayStruct = AstContext::make<AstStruct>(Symbol("__int16_array"));
+    int16ArrayStruct->addItem(Var(AstBuilder::buildPointerType(AstBuilder::buildInt16Type()), Symbol("ptr")), nullptr);
+    int16ArrayStruct->addItem(Var(AstBuilder::buildInt32Type(), Symbol("size")), AstContext::make<AstInt>(0));
     tree->addStruct(int16ArrayStruct);
     
     // Int32
-    auto int32ArrayStruct = std::make_shared<AstStruct>("__int32_array");
-    int32ArrayStruct->addItem(Var(AstBuilder::buildPointerType(AstBuilder::buildInt32Type()), "ptr"), nullptr);
-    int32ArrayStruct->addItem(Var(AstBuilder::buildInt32Type(), "size"), std::make_shared<AstInt>(0));
+    auto int32ArrayStruct = AstContext::make<AstStruct>(Symbol("__int32_array"));
+    int32ArrayStruct->addItem(Var(AstBuilder::buildPointerType(AstBuilder::buildInt32Type()), Symbol("ptr")), nullptr);
+    int32ArrayStruct->addItem(Var(AstBuilder::buildInt32Type(), Symbol("size")), AstContext::make<AstInt>(0));
     tree->addStruct(int32ArrayStruct);
     
     // Int64
-    auto int64ArrayStruct = std::make_shared<AstStruct>("__int64_array");
-    int64ArrayStruct->addItem(Var(AstBuilder::buildPointerType(AstBuilder::buildInt64Type()), "ptr"), nullptr);
-    int64ArrayStruct->addItem(Var(AstBuilder::buildInt32Type(), "size"), std::make_shared<AstInt>(0));
+    auto int64ArrayStruct = AstContext::make<AstStruct>(Symbol("__int64_array"));
+    int64ArrayStruct->addItem(Var(AstBuilder::buildPointerType(AstBuilder::buildInt64Type()), Symbol("ptr")), nullptr);
+    int64ArrayStruct->addItem(Var(AstBuilder::buildInt32Type(), Symbol("size")), AstContext::make<AstInt>(0));
     tree->addStruct(int64ArrayStruct);
     
     //
     // OpenMP functions
     //
     // Add built-in functions
-    auto fc1 = std::make_shared<AstExternFunction>("printf");
+    auto fc1 = AstContext::make<AstExternFunction>(Symbol("printf"));
     fc1->data_type = AstBuilder::buildVoidType();
     fc1->varargs = true;
-    fc1->addArgument(Var(AstBuilder::buildStringType(), "fmt"));
+    fc1->addArgument(Var(AstBuilder::buildStringType(), Symbol("fmt")));
     tree->block->addStatement(fc1);
-    tree->block->funcs.push_back("printf");
+    tree->block->funcs.insert(Symbol("printf"));
     
     // void __kmpc_fork_call(int *global_id, int *bound_id, int *func)
-    tree->block->funcs.push_back("__kmpc_fork_call");
-    auto omp_fc1 = std::make_shared<AstExternFunction>("__kmpc_fork_call");
-    omp_fc1->addArgument(Var(AstBuilder::buildInt32PointerType(), "global_id"));
-    omp_fc1->addArgument(Var(AstBuilder::buildInt32PointerType(), "bound_id"));
+    tree->block->funcs.insert(Symbol("__kmpc_fork_call"));
+    auto omp_fc1 = AstContext::make<AstExternFunction>(Symbol("__kmpc_fork_call"));
+    omp_fc1->addArgument(Var(AstBuilder::buildInt32PointerType(), Symbol("global_id")));
+    omp_fc1->addArgument(Var(AstBuilder::buildInt32PointerType(), Symbol("bound_id")));
     omp_fc1->varargs = true;
     omp_fc1->data_type = AstBuilder::buildVoidType();
     tree->addGlobalStatement(omp_fc1);
     
     // void __kmpc_for_static_init_4(0, *global_id, 34, &last, &lower, &upper, &stride, 1, 1);
-    tree->block->funcs.push_back("__kmpc_for_static_init_4");
-    auto omp_fc2 = std::make_shared<AstExternFunction>("__kmpc_for_static_init_4");
-    omp_fc2->addArgument(Var(AstBuilder::buildInt32PointerType(), "global_id"));
-    omp_fc2->addArgument(Var(AstBuilder::buildInt32PointerType(), "bound_id"));
-    omp_fc2->addArgument(Var(AstBuilder::buildInt32Type(), "schedule"));
+    tree->block->funcs.insert(Symbol("__kmpc_for_static_init_4"));
+    auto omp_fc2 = AstContext::make<AstExternFunction>(Symbol("__kmpc_for_static_init_4"));
+    omp_fc2->addArgument(Var(AstBuilder::buildInt32PointerType(), Symbol("global_id")));
+    omp_fc2->addArgument(Var(AstBuilder::buildInt32PointerType(), Symbol("bound_id")));
+    omp_fc2->addArgument(Var(AstBuilder::buildInt32Type(), Symbol("schedule")));
     omp_fc2->varargs = true;
     omp_fc2->data_type = AstBuilder::buildVoidType();
     tree->addGlobalStatement(omp_fc2);
     
     // void __kmpc_for_static_fini(0, *global_id);
-    tree->block->funcs.push_back("__kmpc_for_static_fini");
-    auto omp_fc3 = std::make_shared<AstExternFunction>("__kmpc_for_static_fini");
-    omp_fc3->addArgument(Var(AstBuilder::buildInt32PointerType(), "global_id"));
-    omp_fc3->addArgument(Var(AstBuilder::buildInt32PointerType(), "bound_id"));
+    tree->block->funcs.insert(Symbol("__kmpc_for_static_fini"));
+    auto omp_fc3 = AstContext::make<AstExternFunction>(Symbol("__kmpc_for_static_fini"));
+    omp_fc3->addArgument(Var(AstBuilder::buildInt32PointerType(), Symbol("global_id")));
+    omp_fc3->addArgument(Var(AstBuilder::buildInt32PointerType(), Symbol("bound_id")));
     omp_fc3->varargs = true;
     omp_fc3->data_type = AstBuilder::buildVoidType();
     tree->addGlobalStatement(omp_fc3);
@@ -144,21 +147,21 @@ Parser::Parser(std::string input) : BaseParser(input) {
     //
     
     // void gc_init()
-    tree->block->funcs.push_back("gc_init");
-    auto gc_func1 = std::make_shared<AstExternFunction>("gc_init");
+    tree->block->funcs.insert(Symbol("gc_init"));
+    auto gc_func1 = AstContext::make<AstExternFunction>(Symbol("gc_init"));
     gc_func1->data_type = AstBuilder::buildVoidType();
     tree->addGlobalStatement(gc_func1);
     
     // void gc_destroy()
-    tree->block->funcs.push_back("gc_destroy");
-    auto gc_func2 = std::make_shared<AstExternFunction>("gc_destroy");
+    tree->block->funcs.insert(Symbol("gc_destroy"));
+    auto gc_func2 = AstContext::make<AstExternFunction>(Symbol("gc_destroy"));
     gc_func2->data_type = AstBuilder::buildVoidType();
     tree->addGlobalStatement(gc_func2);
     
     // void *gc_alloc(int size)
-    tree->block->funcs.push_back("gc_alloc");
-    auto gc_func3 = std::make_shared<AstExternFunction>("gc_alloc");
-    gc_func3->addArgument(Var(AstBuilder::buildInt32Type(), "size"));
+    tree->block->funcs.insert(Symbol("gc_alloc"));
+    auto gc_func3 = AstContext::make<AstExternFunction>(Symbol("gc_alloc"));
+    gc_func3->addArgument(Var(AstBuilder::buildInt32Type(), Symbol("size")));
     gc_func3->data_type = AstBuilder::buildStringType();
     tree->addGlobalStatement(gc_func3);
 }
@@ -167,6 +170,7 @@ Parser::~Parser() {
 }
 
 bool Parser::parse() {
+    AstContext::Scope scope(tree->context);
     int tk;
     do {
         tk = lex->get_next();
@@ -225,18 +229,26 @@ bool Parser::build_import() {
         token = lex->get_next();
     }
 
-    // Load the include path
+    // Load the include path; $ORKA_INCLUDE_DIR replaces the default one
     // TODO: We need better path support
 #ifdef DEV_LINK_MODE
-    path = std::string(ORKA_HEADER_LOCATION) + "/" + path + ".oh";
+    std::string include = ORKA_HEADER_LOCATION;
 #else
-    path = "/usr/local/include/orka/" + path + ".oh";
+    std::string include = "/usr/local/include/orka";
 #endif
+    const char *env = getenv("ORKA_INCLUDE_DIR");
+    if (env != nullptr && env[0] != 0) include = env;
+    path = include + "/" + path + ".oh";
 
-    // Invoke another parser to load the path
-    auto parser = std::make_unique<Parser>(path);
-    parser->parse();
-    auto tree2 = parser->tree;
+    // Invoke another parser to load the path; a header imported by several
+    // files is only parsed once, and is loaded from the cache when unchanged
+    auto tree2 = ImportCache::load(path, imports, [path](std::vector<std::string> &imports) {
+        auto parser = std::make_unique<Parser>(path);
+        if (!parser->parse()) return std::shared_ptr<AstTree>();
+        imports = parser->imports;
+        return parser->tree;
+    });
+    if (tree2 == nullptr) return false;
     
     tree->block->mergeSymbols(tree2->block);
     for (auto const& stmt : tree2->block->block) {
@@ -309,7 +321,7 @@ bool Parser::buildBlock(std::shared_ptr<AstBlock> block, std::shared_ptr<AstNode
                 consume_token(t_id, "Expected block name.");
                 auto name = lex->value;
                 
-                auto annot_block = std::make_shared<AstBlockStmt>(name);
+                auto annot_block = AstContext::make<AstBlockStmt>(name);
                 block->addStatement(annot_block);
                 
                 int t = lex->get_next();
@@ -331,7 +343,7 @@ bool Parser::buildBlock(std::shared_ptr<AstBlock> block, std::shared_ptr<AstNode
                     return false;
                 }
                 
-                annot_block->block->mergeSymbols(block);
+                annot_block->block->setParent(block);
                 buildBlock(annot_block->block);
             } break;
             
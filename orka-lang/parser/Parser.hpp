@@ -80,10 +80,13 @@ protected:
     std::string getArrayType(std::shared_ptr<AstDataType> dataType);
     void consume_token(token t, std::string message);
 private:
-    std::map<std::string, AstEnum> enums;
+    SymbolMap<AstEnum> enums;
     
     std::shared_ptr<AstClass> currentClass = nullptr;
-    std::map<std::string, std::string> classMap;
+    SymbolMap<Symbol> classMap;
+    
+    // Every header this file imports, directly or not
+    std::vector<std::string> imports;
     
     bool java = false;
 };
@@ -59,7 +59,7 @@ bool Parser::buildEnum() {
     }
     
     // Loop and get all the values
-    std::map<std::string, std::shared_ptr<AstExpression>> values;
+    SymbolMap<std::shared_ptr<AstExpression>> values;
     int index = 0;
     
     while (token != t_end && token != t_eof) {
@@ -82,19 +82,19 @@ bool Parser::buildEnum() {
         }
         
         if (value == nullptr) {
-            value = checkExpression(std::make_shared<AstInt>(index), dataType);
+            value = checkExpression(AstContext::make<AstInt>(index), dataType);
             ++index;
         }
         
-        values[valName] = value;
+        values[Symbol(valName)] = value;
     }
     
     // Put it all together
     AstEnum theEnum;
-    theEnum.name = name;
+    theEnum.name = Symbol(name);
     theEnum.type = dataType;
     theEnum.values = values;
-    enums[name] = theEnum;
+    enums[theEnum.name] = theEnum;
     
     return true;
 }
@@ -116,7 +116,7 @@ bool Parser::buildStruct() {
     }
     
     // Builds the struct items
-    std::shared_ptr<AstStruct> str = std::make_shared<AstStruct>(name);
+    std::shared_ptr<AstStruct> str = AstContext::make<AstStruct>(Symbol(name));
     tk = lex->get_next();
     
     while (tk != t_end && tk != t_eof) {
@@ -154,7 +154,7 @@ bool Parser::buildStructMember(std::shared_ptr<AstStruct> str, int tk) {
         if (!expr) return false;
                 
         Var v;
-        v.name = valName;
+        v.name = Symbol(valName);
         v.type = dataType;
         str->addItem(v, expr);
     } else {
@@ -204,8 +204,8 @@ bool Parser::buildStructDec(std::shared_ptr<AstBlock> block) {
     }
     
     // Now build the declaration and push back
-    block->addSymbol(name, AstBuilder::buildStructType(structName));
-    std::shared_ptr<AstStructDec> dec = std::make_shared<AstStructDec>(name, structName);
+    block->addSymbol(Symbol(name), AstBuilder::buildStructType(structName));
+    std::shared_ptr<AstStructDec> dec = AstContext::make<AstStructDec>(Symbol(name), Symbol(structName));
     block->addStatement(dec);
     
     // Final syntax check
@@ -214,12 +214,12 @@ bool Parser::buildStructDec(std::shared_ptr<AstBlock> block) {
         return true;
     } else if (tk == t_assign) {
         dec->no_init = true;
-        std::shared_ptr<AstExprStatement> empty = std::make_shared<AstExprStatement>();
+        std::shared_ptr<AstExprStatement> empty = AstContext::make<AstExprStatement>();
         std::shared_ptr<AstExpression> arg = buildExpression(block, AstBuilder::buildStructType(structName), t_semicolon);
         if (!arg) return false;
         
-        std::shared_ptr<AstID> id = std::make_shared<AstID>(name);
-        std::shared_ptr<AstAssignOp> assign = std::make_shared<AstAssignOp>(id, arg);
+        std::shared_ptr<AstID> id = AstContext::make<AstID>(dec->var_name);
+        std::shared_ptr<AstAssignOp> assign = AstContext::make<AstAssignOp>(id, arg);
         
         empty->expression = assign;
         block->addStatement(empty);
@@ -264,10 +264,10 @@ bool Parser::buildClass() {
         return false;
     }
     
-    auto clazzStruct = std::make_shared<AstStruct>(name);
+    auto clazzStruct = AstContext::make<AstStruct>(Symbol(name));
     tree->addStruct(clazzStruct);
     
-    auto clazz = std::make_shared<AstClass>(name);
+    auto clazz = AstContext::make<AstClass>(Symbol(name));
     currentClass = clazz;
     
     if (baseClass != "") {
@@ -311,7 +311,7 @@ bool Parser::buildClass() {
             std::string newName = name + "_" + func->name;
             
             // Copy it
-            auto func2 = std::make_shared<AstFunction>(newName);
+            auto func2 = AstContext::make<AstFunction>(Symbol(newName));
             func2->data_type = func->data_type;
             func2->args = func->args;
             tree->addGlobalStatement(func2);
@@ -394,25 +394,25 @@ bool Parser::buildClassDec(std::shared_ptr<AstBlock> block) {
     // Build the structure declaration
     if (java) {
         auto data_type = AstBuilder::buildObjectType(className);
-        auto dec = std::make_shared<AstVarDec>(name, data_type);
-        dec->class_name = className;
+        auto dec = AstContext::make<AstVarDec>(Symbol(name), data_type);
+        dec->class_name = Symbol(className);
         block->addStatement(dec);
         
-        classMap[name] = className;
+        classMap[dec->name] = dec->class_name;
         
     } else {
-        auto dec = std::make_shared<AstStructDec>(name, className);
+        auto dec = AstContext::make<AstStructDec>(Symbol(name), Symbol(className));
         block->addStatement(dec);
         
-        classMap[name] = className;
+        classMap[dec->var_name] = dec->struct_name;
         
         // Call the constructor
-        auto classRef = std::make_shared<AstID>(name);
-        auto args = std::make_shared<AstExprList>();
+        auto classRef = AstContext::make<AstID>(dec->var_name);
+        auto args = AstContext::make<AstExprList>();
         args->add_expression(classRef);
         
         std::string constructor = className + "_" + className;
-        auto fc = std::make_shared<AstFuncCallStmt>(constructor);
+        auto fc = AstContext::make<AstFuncCallStmt>(Symbol(constructor));
         block->addStatement(fc);
         fc->expression = args;
     }
@@ -16,8 +16,8 @@
 // Builds a variable declaration
 bool Parser::buildVariableDec(std::shared_ptr<AstBlock> block) {
     int tk = lex->get_next();
-    std::vector<std::string> toDeclare;
-    toDeclare.push_back(lex->value);
+    std::vector<Symbol> toDeclare;
+    toDeclare.push_back(Symbol(lex->value));
     
     if (tk != t_id) {
         syntax->addError(lex->line_number, "Expected variable name.");
@@ -35,7 +35,7 @@ bool Parser::buildVariableDec(std::shared_ptr<AstBlock> block) {
                 return false;
             }
             
-            toDeclare.push_back(lex->value);
+            toDeclare.push_back(Symbol(lex->value));
         } else if (tk != t_colon) {
             syntax->addError(lex->line_number, "Invalt_id tk in variable declaration.");
             return false;
@@ -56,14 +56,14 @@ bool Parser::buildVariableDec(std::shared_ptr<AstBlock> block) {
     std::shared_ptr<AstExpression> arg = buildExpression(block, dataType, t_semicolon);
     if (!arg) return false;
 
-    for (std::string name : toDeclare) {
-        std::shared_ptr<AstVarDec> vd = std::make_shared<AstVarDec>(name, dataType);
+    for (Symbol name : toDeclare) {
+        std::shared_ptr<AstVarDec> vd = AstContext::make<AstVarDec>(name, dataType);
         block->addStatement(vd);
         
-        std::shared_ptr<AstID> id = std::make_shared<AstID>(name);
-        std::shared_ptr<AstAssignOp> assign = std::make_shared<AstAssignOp>(id, arg);
+        std::shared_ptr<AstID> id = AstContext::make<AstID>(name);
+        std::shared_ptr<AstAssignOp> assign = AstContext::make<AstAssignOp>(id, arg);
         
-        std::shared_ptr<AstExprStatement> va = std::make_shared<AstExprStatement>();
+        std::shared_ptr<AstExprStatement> va = AstContext::make<AstExprStatement>();
         va->setDataType(dataType);
         va->expression = assign;
         block->addStatement(va);
@@ -81,7 +81,7 @@ bool Parser::buildVariableDec(std::shared_ptr<AstBlock> block) {
 bool Parser::build_array_dec(std::shared_ptr<AstBlock> block) {
     // Get the array name
     consume_token(t_id, "Expected array name.");
-    std::string name = lex->value;
+    Symbol name(lex->value);
     
     // Get the colon
     consume_token(t_colon, "Expected \':\'.");
@@ -105,38 +105,38 @@ bool Parser::build_array_dec(std::shared_ptr<AstBlock> block) {
     // Consume the semicolon
     consume_token(t_semicolon, "Expected \';\'");
     
-    std::shared_ptr<AstStructDec> dec = std::make_shared<AstStructDec>(name, data_type_name);
+    std::shared_ptr<AstStructDec> dec = AstContext::make<AstStructDec>(name, Symbol(data_type_name));
     dec->no_init = true;
     block->addStatement(dec);
     
     //
     // Malloc
     //
-    auto list = std::make_shared<AstExprList>();
+    auto list = AstContext::make<AstExprList>();
     
     // Get the size
-    //std::shared_ptr<AstI32> size = std::make_shared<AstI32>(4);
+    //std::shared_ptr<AstI32> size = AstContext::make<AstI32>(4);
     std::shared_ptr<AstInt> size;
-    if (base_type->type == V_AstType::Int32) size = std::make_shared<AstInt>(4);
-    else if (base_type->type == V_AstType::Int64) size = std::make_shared<AstInt>(8);
-    else if (base_type->type == V_AstType::String) size = std::make_shared<AstInt>(8);
-    else size = std::make_shared<AstInt>(1);
+    if (base_type->type == V_AstType::Int32) size = AstContext::make<AstInt>(4);
+    else if (base_type->type == V_AstType::Int64) size = AstContext::make<AstInt>(8);
+    else if (base_type->type == V_AstType::String) size = AstContext::make<AstInt>(8);
+    else size = AstContext::make<AstInt>(1);
     
-    auto mul_op = std::make_shared<AstMulOp>();
+    auto mul_op = AstContext::make<AstMulOp>();
     mul_op->lval = size;
     mul_op->rval = size_arg;
     list->add_expression(mul_op);
     
     // Create the malloc call
-    auto call_malloc = std::make_shared<AstFuncCallExpr>("gc_alloc");
+    auto call_malloc = AstContext::make<AstFuncCallExpr>(Symbol("gc_alloc"));
     call_malloc->args = list;
     
-    auto lval_alloc = std::make_shared<AstStructAccess>(name, "ptr");
-    auto op1 = std::make_shared<AstAssignOp>();
+    auto lval_alloc = AstContext::make<AstStructAccess>(name, Symbol("ptr"));
+    auto op1 = AstContext::make<AstAssignOp>();
     op1->lval = lval_alloc;
     op1->rval = call_malloc;
     
-    auto va_ptr = std::make_shared<AstExprStatement>();
+    auto va_ptr = AstContext::make<AstExprStatement>();
     va_ptr->setDataType(data_type);
     va_ptr->expression = op1;
     block->addStatement(va_ptr);
@@ -145,13 +145,13 @@ bool Parser::build_array_dec(std::shared_ptr<AstBlock> block) {
     // Set the size
     //
     // expression
-    auto lval_size = std::make_shared<AstStructAccess>(name, "size");
-    auto op = std::make_shared<AstAssignOp>();
+    auto lval_size = AstContext::make<AstStructAccess>(name, Symbol("size"));
+    auto op = AstContext::make<AstAssignOp>();
     op->lval = lval_size;
     op->rval = size_arg;
     
     // The statement
-    auto va_size = std::make_shared<AstExprStatement>();
+    auto va_size = AstContext::make<AstExprStatement>();
     va_size->setDataType(data_type);
     va_size->expression = op;
     block->addStatement(va_size);
@@ -163,19 +163,19 @@ bool Parser::build_array_dec(std::shared_ptr<AstBlock> block) {
 
 // Builds a variable or an array assignment
 bool Parser::buildVariableAssign(std::shared_ptr<AstBlock> block, std::string value) {
-    std::shared_ptr<AstDataType> data_type = block->getDataType(value);
+    std::shared_ptr<AstDataType> data_type = block->getDataType(Symbol::find(value));
     
     std::shared_ptr<AstExpression> expr = buildExpression(block, data_type, t_semicolon);
     if (!expr) return false;
     
     if (java && expr->type == V_AstType::FuncCallExpr) {
         auto fc = std::static_pointer_cast<AstFuncCallExpr>(expr);
-        auto stmt = std::make_shared<AstFuncCallStmt>(fc->name);
+        auto stmt = AstContext::make<AstFuncCallStmt>(fc->name);
         stmt->object_name = fc->object_name;
         //stmt->expression = fc->args;
         block->addStatement(stmt);
     } else {
-        auto stmt = std::make_shared<AstExprStatement>();
+        auto stmt = AstContext::make<AstExprStatement>();
         stmt->setDataType(data_type);
         stmt->expression = expr;
         block->addStatement(stmt);
@@ -188,7 +188,7 @@ bool Parser::buildVariableAssign(std::shared_ptr<AstBlock> block, std::string va
 bool Parser::buildConst(std::shared_ptr<AstBlock> block, bool isGlobal) {
     // Make sure we have a name for our constant
     consume_token(t_id, "Expected constant name.");
-    std::string name = lex->value;
+    Symbol name(lex->value);
     
     // Syntax check
     consume_token(t_colon, "Expected \':\' in constant expression.");
@@ -8,41 +8,84 @@
 #include <cstdio>
 #include <memory>
 #include <cstdlib>
+#include <vector>
+#include <future>
 
 #include <parser/Parser.hpp>
 #include <ast/ast.hpp>
 #include <midend/midend.hpp>
+#include <midend/constant_fold_midend.hpp>
+#include <midend/dead_code_midend.hpp>
+#include <parser/thread_pool.hpp>
 
 #include <llvm/Compiler.hpp>
 
 bool isError = false;
 
-std::shared_ptr<AstTree> getAstTree(std::string input, bool testLex, bool printAst1, bool printAst, bool emitDot) {
+std::shared_ptr<AstTree> parseFile(std::string input) {
     std::unique_ptr<Parser> frontend = std::make_unique<Parser>(input);
-    std::shared_ptr<AstTree> tree;
-    
+    if (!frontend->parse()) return nullptr;
+    return frontend->getTree();
+}
+
+//
+// Parses each input on the thread pool, then merges the trees in the order
+// the files were given on the command line
+//
+std::shared_ptr<AstTree> getAstTree(std::vector<std::string> inputs, size_t jobs, bool testLex, bool printAst1, bool printAst, bool emitDot) {
     if (testLex) {
-        frontend->debugScanner();
+        for (auto const &input : inputs) {
+            std::unique_ptr<Parser> frontend = std::make_unique<Parser>(input);
+            frontend->debugScanner();
+        }
         isError = false;
         return nullptr;
     }
     
-    if (!frontend->parse()) {
-        isError = true;
-        return nullptr;
+    std::vector<std::future<std::shared_ptr<AstTree>>> results;
+    {
+        ThreadPool pool(inputs.size() > 1 ? jobs : 0);
+        for (auto const &input : inputs) {
+            results.push_back(pool.submit(parseFile, input));
+        }
+    }
+    
+    std::shared_ptr<AstTree> tree;
+    for (auto &result : results) {
+        auto tree2 = result.get();
+        if (tree2 == nullptr) {
+            isError = true;
+        } else if (tree == nullptr) {
+            tree = tree2;
+        } else {
+            tree->merge(tree2);
+        }
     }
     
-    tree = frontend->getTree();
+    if (isError) return nullptr;
     
     if (printAst1) {
         tree->print();
         return nullptr;
     }
     
+    // Only fold and remove dead code when the tree goes on to be compiled, so
+    // that the dumps show the program as written
+    bool optimize = !printAst && !emitDot;
+    if (optimize) {
+        auto folder = std::make_unique<ConstantFoldMidend>(tree);
+        folder->run();
+    }
+    
     std::unique_ptr<Midend> midend = std::make_unique<Midend>(tree);
     midend->run();
     tree = midend->tree;
     
+    if (optimize) {
+        auto dce = std::make_unique<DeadCodeMidend>(tree);
+        dce->run();
+    }
+    
     if (printAst) {
         tree->print();
         return nullptr;
@@ -56,42 +99,53 @@ std::shared_ptr<AstTree> getAstTree(std::string input, bool testLex, bool printA
     return tree;
 }
 
-void assemble(CFlags cflags) {
-    std::string cmd = "as /tmp/" + cflags.name + ".asm -o /tmp/" + cflags.name + ".o";
-    system(cmd.c_str());
-}
-
 #ifdef DEV_LINK_MODE
 
 #ifndef LINK_LOCATION
 #define LINK_LOCATION = "."
 #endif
 
-void link(CFlags cflags) {
-    std::string cmd = "ld ";
-    cmd += std::string(LINK_LOCATION) + "/amd64_start.o ";
-    cmd += "/tmp/" + cflags.name + ".o -o " + cflags.name;
-    cmd += " -L" + std::string(LINK_LOCATION) + "/corelib -lcorelib ";
-    system(cmd.c_str());
-    //printf("LINK: %s\n", cmd.c_str());
+bool link(CFlags cflags, std::string object) {
+    std::vector<std::string> args;
+    args.push_back(std::string(LINK_LOCATION) + "/amd64_start.o");
+    args.push_back(object);
+    args.push_back("-o");
+    args.push_back(cflags.name);
+    args.push_back("-L" + std::string(LINK_LOCATION) + "/corelib");
+    args.push_back("-lcorelib");
+    return runLinker(args);
+}
+
+// The libraries that link() uses, for running in process
+std::vector<std::string> runtimeLibraries(CFlags cflags) {
+    return {
+        std::string(LINK_LOCATION) + "/amd64_start.o",
+        std::string(LINK_LOCATION) + "/corelib/libcorelib.a"
+    };
 }
 
 #else
 
-void link(CFlags cflags) {
+bool link(CFlags cflags, std::string object) {
     /*std::string cmd = "ld ";
     cmd += "/usr/local/lib/tinylang/ti_start.o ";
     cmd += "/tmp/" + cflags.name + ".o -o " + cflags.name;
     cmd += " -dynamic-linker /lib64/ld-linux-x86-64.so.2 ";
     cmd += "-ltinylang -lc";
     system(cmd.c_str());*/
+    return true;
+}
+
+std::vector<std::string> runtimeLibraries(CFlags cflags) {
+    return {};
 }
 
 #endif
 
-int compileLLVM(std::shared_ptr<AstTree> tree, CFlags flags, bool printLLVM, bool emitLLVM) {
+int compileLLVM(std::shared_ptr<AstTree> tree, CFlags flags, bool printLLVM, bool emitLLVM, bool emitAsm, bool run, bool lazy) {
     std::unique_ptr<Compiler> compiler = std::make_unique<Compiler>(tree, flags);
     compiler->compile();
+    compiler->optimize();
         
     if (printLLVM) {
         compiler->debug();
@@ -107,12 +161,28 @@ int compileLLVM(std::shared_ptr<AstTree> tree, CFlags flags, bool printLLVM, boo
         compiler->emitLLVM(output);
         return 0;
     }
+    
+    if (emitAsm) {
+        std::string output = flags.name;
+        if (output == "a.out") {
+            output = "./out.s";
+        }
         
-    compiler->writeAssembly();
-    assemble(flags);
-    link(flags);
+        compiler->writeAssembly(output);
+        return 0;
+    }
+    
+    if (run) {
+        return compiler->run(runtimeLibraries(flags), { flags.name }, lazy);
+    }
+    
+    std::string object;
+    if (!compiler->writeObject(object)) return 1;
+    
+    bool linked = link(flags, object);
+    remove(object.c_str());
     
-    return 0;
+    return linked ? 0 : 1;
 }
 
 int main(int argc, char **argv) {
@@ -126,7 +196,8 @@ int main(int argc, char **argv) {
     flags.name = "a.out";
     
     // Other flags
-    std::string input = "";
+    std::vector<std::string> inputs;
+    size_t jobs = ThreadPool::default_count();
     bool emitPreproc = false;
     bool testLex = false;
     bool printAst1 = false;
@@ -134,6 +205,9 @@ int main(int argc, char **argv) {
     bool emitDot = false;
     bool printLLVM = false;
     bool emitLLVM = false;
+    bool emitAsm = false;
+    bool run = false;
+    bool lazy = false;
     
     for (int i = 1; i<argc; i++) {
         std::string arg = argv[i];
@@ -152,24 +226,51 @@ int main(int argc, char **argv) {
             printLLVM = true;
         } else if (arg == "--emit-llvm") {
             emitLLVM = true;
+        } else if (arg == "-S") {
+            emitAsm = true;
+        } else if (arg == "--run") {
+            run = true;
+        } else if (arg == "--lazy") {
+            lazy = true;
+        } else if (arg == "-O0" || arg == "-O1" || arg == "-O2" || arg == "-O3") {
+            flags.opt_level = arg[2] - '0';
+        } else if (arg == "-Os") {
+            flags.opt_level = 2;
+            flags.opt_size = true;
+        } else if (arg == "--time-passes") {
+            flags.time_passes = true;
+        } else if (arg.rfind("-march=", 0) == 0) {
+            flags.cpu = arg.substr(7);
+        } else if (arg.rfind("-mcpu=", 0) == 0) {
+            flags.cpu = arg.substr(6);
+        } else if (arg.rfind("-mattr=", 0) == 0) {
+            flags.features = arg.substr(7);
         } else if (arg == "-o") {
             flags.name = argv[i+1];
             i += 1;
+        } else if (arg == "-j") {
+            jobs = std::stoi(argv[i+1]);
+            i += 1;
         } else if (arg[0] == '-') {
             std::cerr << "Invalid option: " << arg << std::endl;
             return 1;
         } else {
-            input = arg;
+            inputs.push_back(arg);
         }
     }
     
-    std::shared_ptr<AstTree> tree = getAstTree(input, testLex, printAst1, printAst, emitDot);
+    if (inputs.empty()) {
+        std::cerr << "Error: No input file specified." << std::endl;
+        return 1;
+    }
+    
+    std::shared_ptr<AstTree> tree = getAstTree(inputs, jobs, testLex, printAst1, printAst, emitDot);
     if (tree == nullptr) {
         if (isError) return 1;
         return 0;
     }
 
     // Compile
-    return compileLLVM(tree, flags, printLLVM, emitLLVM);
+    return compileLLVM(tree, flags, printLLVM, emitLLVM, emitAsm, run, lazy);
 }
 
@@ -4,14 +4,63 @@
 // See COPYING for more info.
 //
 #include <iostream>
+#include <fstream>
 #include <string>
 #include <cstdio>
 #include <memory>
 #include <cstdlib>
+#include <vector>
 
 #include <parser/Parser.hpp>
 #include <ast/ast.hpp>
+#include <midend/midend.hpp>
+#include <midend/constant_fold_midend.hpp>
 #include <intr/interpreter.hpp>
+#include <intr/bytecode.hpp>
+#include <llvm/Tier.hpp>
+
+#ifdef DEV_LINK_MODE
+
+#ifndef LINK_LOCATION
+#define LINK_LOCATION = "."
+#endif
+
+// The runtime the native tier calls into
+std::vector<std::string> runtimeLibraries() {
+    return {
+        std::string(LINK_LOCATION) + "/amd64_start.o",
+        std::string(LINK_LOCATION) + "/corelib/libcorelib.a"
+    };
+}
+
+#else
+
+std::vector<std::string> runtimeLibraries() {
+    return {};
+}
+
+#endif
+
+//
+// The compiler needs the tree after the midend, which the interpreter cannot
+// run, so the input is parsed a second time for the tier. Functions the
+// compiler does not know are left to the interpreter, as they are here.
+//
+std::shared_ptr<NativeTier> createTier(std::string input) {
+    auto parser = std::make_unique<Parser>(input, true);
+    if (!parser->parse()) return nullptr;
+    
+    auto folder = std::make_unique<ConstantFoldMidend>(parser->getTree());
+    folder->run();
+    
+    auto midend = std::make_unique<Midend>(parser->getTree());
+    midend->run();
+    
+    CFlags flags;
+    flags.name = "riyai";
+    flags.opt_level = 2;
+    return std::make_shared<JITTier>(midend->tree, flags, runtimeLibraries());
+}
 
 int main(int argc, char **argv) {
     if (argc == 1) {
@@ -22,12 +71,32 @@ int main(int argc, char **argv) {
     // Parse the command line
     std::string input = "";
     bool print_ast = false;
+    bool use_vm = false;
+    bool print_bytecode = false;
+    bool tiered = false;
+    uint64_t threshold = 1000;
+    bool profile = false;
+    std::string profile_output = "riyai.folded";
     
     for (int i = 1; i<argc; i++) {
         std::string arg = argv[i];
         
         if (arg == "--ast") {
             print_ast = true;
+        } else if (arg == "--vm") {
+            use_vm = true;
+        } else if (arg == "--bytecode") {
+            print_bytecode = true;
+        } else if (arg == "--tier") {
+            tiered = true;
+        } else if (arg.find("--tier-threshold=") == 0) {
+            tiered = true;
+            threshold = std::stoull(arg.substr(17));
+        } else if (arg == "--profile") {
+            profile = true;
+        } else if (arg.find("--profile=") == 0) {
+            profile = true;
+            profile_output = arg.substr(10);
         } else if (arg[0] == '-') {
             std::cerr << "Invalid option: " << arg << std::endl;
             return 1;
@@ -49,8 +118,55 @@ int main(int argc, char **argv) {
         return 0;
     }
     
+    // The interpreters have no optimizer of their own
+    auto folder = std::make_unique<ConstantFoldMidend>(tree);
+    folder->run();
+    
+    // Programs the bytecode cannot run the same way are left to the tree
+    // interpreter. Profiles are only taken of the tree interpreter.
+    if ((use_vm && !profile) || print_bytecode) {
+        auto compiler = std::make_unique<BytecodeCompiler>(tree);
+        auto program = compiler->compile();
+        
+        if (program == nullptr) {
+            std::cerr << "Warning: " << compiler->error() << "; using the tree interpreter." << std::endl;
+            if (print_bytecode) return 1;
+        } else if (print_bytecode) {
+            program->print();
+            return 0;
+        } else {
+            auto vm = std::make_unique<BytecodeVM>(program);
+            return vm->run();
+        }
+    }
+    
     auto intr = std::make_unique<AstInterpreter>(tree);
+    if (tiered) {
+        auto tier = createTier(input);
+        if (tier) intr->set_tier(tier, threshold);
+    }
+    
+    // The report goes to stderr, so it is not mixed with the program's
+    // output, and the collapsed stacks to their own file
+    std::shared_ptr<IntrProfiler> profiler;
+    if (profile) {
+        profiler = std::make_shared<IntrProfiler>();
+        intr->set_profiler(profiler);
+    }
+    
     int code = intr->run();
+    
+    if (profiler) {
+        std::cout.flush();
+        profiler->write_report(std::cerr);
+        
+        std::ofstream file(profile_output);
+        if (!file) {
+            std::cerr << "Error: Unable to write " << profile_output << "." << std::endl;
+            return 1;
+        }
+        profiler->write_collapsed(file);
+    }
 
     return code;
 }
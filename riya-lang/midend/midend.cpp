@@ -5,6 +5,8 @@
 //
 #include <memory>
 
+#include <ast/ast_builder.hpp>
+
 #include "midend.hpp"
 
 void Midend::process_function_call(std::shared_ptr<AstFuncCallStmt> call, std::shared_ptr<AstBlock> block) {
@@ -13,7 +15,7 @@ void Midend::process_function_call(std::shared_ptr<AstFuncCallStmt> call, std::s
     }
 
     auto args = std::static_pointer_cast<AstExprList>(call->expression);
-    auto args2 = std::make_shared<AstExprList>();
+    auto args2 = AstContext::make<AstExprList>();
     std::string fmt = "";
     bool skip_next = false;
     
@@ -45,9 +47,13 @@ void Midend::process_function_call(std::shared_ptr<AstFuncCallStmt> call, std::s
                 
                 std::shared_ptr<AstDataType> dtype;
                 if (expr->type == V_AstType::ArrayAccess) {
-                    std::string name = std::static_pointer_cast<AstArrayAccess>(expr)->value;
+                    Symbol name = std::static_pointer_cast<AstArrayAccess>(expr)->value;
                     dtype = block->getDataType(name);
-                    dtype = std::static_pointer_cast<AstPointerType>(dtype)->base_type;
+                    if (dtype->type == V_AstType::Ptr) {
+                        dtype = std::static_pointer_cast<AstPointerType>(dtype)->base_type;
+                    } else if (dtype->type == V_AstType::String) {
+                        dtype = AstBuilder::buildCharType();
+                    }
                 } else if (expr->type == V_AstType::StructAccess) {
                     auto sa = std::static_pointer_cast<AstStructAccess>(expr);
                     auto sa_type = std::static_pointer_cast<AstStructType>(block->getDataType(sa->var));
@@ -64,7 +70,7 @@ void Midend::process_function_call(std::shared_ptr<AstFuncCallStmt> call, std::s
                         dtype = std::static_pointer_cast<AstPointerType>(dtype)->base_type;
                     }
                 } else {
-                    std::string name = std::static_pointer_cast<AstID>(expr)->value;
+                    Symbol name = std::static_pointer_cast<AstID>(expr)->value;
                     dtype = block->getDataType(name);
                     if (dtype->type == V_AstType::Ptr) {
                         dtype = std::static_pointer_cast<AstPointerType>(dtype)->base_type;
@@ -89,7 +95,7 @@ void Midend::process_function_call(std::shared_ptr<AstFuncCallStmt> call, std::s
     
     // Add the format
     //auto args2 = std::static_pointer_cast<AstExprList>(args);
-    std::shared_ptr<AstString> fmt_str = std::make_shared<AstString>(fmt);
+    std::shared_ptr<AstString> fmt_str = AstContext::make<AstString>(fmt);
     args2->list.insert(args2->list.begin(), fmt_str);
     call->expression = args2;
 }
@@ -131,26 +137,26 @@ std::shared_ptr<AstExpression> Midend::process_binary_op(std::shared_ptr<AstBina
         return nullptr;
     }
     
-    auto args = std::make_shared<AstExprList>();
+    auto args = AstContext::make<AstExprList>();
     args->add_expression(lval);
     args->add_expression(rval);
 
     if (expr->type == V_AstType::EQ || expr->type == V_AstType::NEQ) {
-        auto fc = std::make_shared<AstFuncCallExpr>("stringcmp");
+        auto fc = AstContext::make<AstFuncCallExpr>(Symbol("stringcmp"));
         fc->args = args;
         expr->lval = fc;
         
         if (expr->type == V_AstType::NEQ)
-            expr->rval = std::make_shared<AstInt>(0);
+            expr->rval = AstContext::make<AstInt>(0);
         else
-            expr->rval = std::make_shared<AstInt>(1);
+            expr->rval = AstContext::make<AstInt>(1);
     } else if (expr->type == V_AstType::Add) {
         if (rval_str) {
-            auto fc = std::make_shared<AstFuncCallExpr>("strcat_str");
+            auto fc = AstContext::make<AstFuncCallExpr>(Symbol("strcat_str"));
             fc->args = args;
             return fc;
         } else {
-            auto fc = std::make_shared<AstFuncCallExpr>("strcat_char");
+            auto fc = AstContext::make<AstFuncCallExpr>(Symbol("strcat_char"));
             fc->args = args;
             return fc;
         }
@@ -14,11 +14,29 @@
 // Builds a constant expression value
 std::shared_ptr<AstExpression> Parser::build_constant(int tk) {
     switch (tk) {
-        case t_true: return std::make_shared<AstInt>(1);
-        case t_false: return std::make_shared<AstInt>(0);
-        case t_char_literal: return std::make_shared<AstChar>((char)lex->i_value);
-        case t_int_literal: return std::make_shared<AstInt>(lex->i_value);
-        case t_string_literal: return std::make_shared<AstString>(lex->value);
+        case t_true: return AstContext::make<AstInt>(1);
+        case t_false: return AstContext::make<AstInt>(0);
+        case t_char_literal: return AstContext::make<AstChar>((char)lex->i_value);
+        case t_int_literal: {
+            // The lexer splits a float literal into an integer, a dot and
+            // another integer
+            std::string whole = lex->value;
+            int value = lex->i_value;
+            int tk_next = lex->get_next();
+            if (tk_next == t_dot) {
+                tk_next = lex->get_next();
+                if (tk_next != t_int_literal) {
+                    syntax->addError(lex->line_number, "Invalid integer or float literal.");
+                    return nullptr;
+                }
+                
+                return AstContext::make<AstFloat>(std::stod(whole + "." + lex->value));
+            }
+            lex->unget(tk_next);
+            return AstContext::make<AstInt>(value);
+        }
+        case t_float_literal: return AstContext::make<AstFloat>(lex->f_value);
+        case t_string_literal: return AstContext::make<AstString>(lex->value);
         
         default: {}
     }
@@ -46,36 +64,39 @@ bool Parser::build_operator(int tk, std::shared_ptr<ExprContext> ctx) {
         case t_lte:
         case t_lgand:
         case t_lgor: {
-            std::shared_ptr<AstBinaryOp> op = std::make_shared<AstBinaryOp>();
-            std::shared_ptr<AstUnaryOp> op1 = std::make_shared<AstUnaryOp>();
+            std::shared_ptr<AstBinaryOp> op = nullptr;
+            std::shared_ptr<AstUnaryOp> op1 = nullptr;
             bool useUnary = false;
             switch (tk) {
-                case t_assign: op = std::make_shared<AstAssignOp>(); break;
-                case t_plus: op = std::make_shared<AstAddOp>(); break;
-                case t_mul: op = std::make_shared<AstMulOp>(); break;
-                case t_div: op = std::make_shared<AstDivOp>(); break;
-                case t_mod: op = std::make_shared<AstModOp>(); break;
-                case t_and: op = std::make_shared<AstAndOp>(); break;
-                case t_or: op = std::make_shared<AstOrOp>(); break;
-                case t_xor: op = std::make_shared<AstXorOp>(); break;
-                case t_eq: op = std::make_shared<AstEQOp>(); break;
-                case t_neq: op = std::make_shared<AstNEQOp>(); break;
-                case t_gt: op = std::make_shared<AstGTOp>(); break;
-                case t_lt: op = std::make_shared<AstLTOp>(); break;
-                case t_gte: op = std::make_shared<AstGTEOp>(); break;
-                case t_lte: op = std::make_shared<AstLTEOp>(); break;
-                case t_lgand: op = std::make_shared<AstLogicalAndOp>(); break;
-                case t_lgor: op = std::make_shared<AstLogicalOrOp>(); break;
+                case t_assign: op = AstContext::make<AstAssignOp>(); break;
+                case t_plus: op = AstContext::make<AstAddOp>(); break;
+                case t_mul: op = AstContext::make<AstMulOp>(); break;
+                case t_div: op = AstContext::make<AstDivOp>(); break;
+                case t_mod: op = AstContext::make<AstModOp>(); break;
+                case t_and: op = AstContext::make<AstAndOp>(); break;
+                case t_or: op = AstContext::make<AstOrOp>(); break;
+                case t_xor: op = AstContext::make<AstXorOp>(); break;
+                case t_eq: op = AstContext::make<AstEQOp>(); break;
+                case t_neq: op = AstContext::make<AstNEQOp>(); break;
+                case t_gt: op = AstContext::make<AstGTOp>(); break;
+                case t_lt: op = AstContext::make<AstLTOp>(); break;
+                case t_gte: op = AstContext::make<AstGTEOp>(); break;
+                case t_lte: op = AstContext::make<AstLTEOp>(); break;
+                case t_lgand: op = AstContext::make<AstLogicalAndOp>(); break;
+                case t_lgor: op = AstContext::make<AstLogicalOrOp>(); break;
                 case t_minus: {
                     if (ctx->lastWasOp) {
-                        op1 = std::make_shared<AstNegOp>();
+                        op1 = AstContext::make<AstNegOp>();
                         useUnary = true;
                     } else {
-                        op = std::make_shared<AstSubOp>();
+                        op = AstContext::make<AstSubOp>();
                     }
                 } break;
             }
             
+            // Only allocate a placeholder for operators with no node of their own
+            if (op == nullptr && !useUnary) op = AstContext::make<AstBinaryOp>();
+            
             post_process_operator(ctx, op, op1, useUnary);
         } break;
         
@@ -90,8 +111,9 @@ bool Parser::build_identifier(std::shared_ptr<AstBlock> block, int tk, std::shar
     int currentLine = 0;
 
     std::string name = lex->value;
+    Symbol sym = Symbol::find(name);
     if (ctx->varType && ctx->varType->type == V_AstType::Void) {
-        ctx->varType = block->getDataType(name);
+        ctx->varType = block->getDataType(sym);
         if (ctx->varType && ctx->varType->type == V_AstType::Ptr)
             ctx->varType = std::static_pointer_cast<AstPointerType>(ctx->varType)->base_type;
     }
@@ -104,7 +126,7 @@ bool Parser::build_identifier(std::shared_ptr<AstBlock> block, int tk, std::shar
             return false;
         }
         
-        std::shared_ptr<AstArrayAccess> acc = std::make_shared<AstArrayAccess>(name);
+        std::shared_ptr<AstArrayAccess> acc = AstContext::make<AstArrayAccess>(Symbol(name));
         acc->index = index;
         ctx->output.push(acc);
     } else if (tk == t_lparen) {
@@ -112,12 +134,12 @@ bool Parser::build_identifier(std::shared_ptr<AstBlock> block, int tk, std::shar
             syntax->addWarning(lex->line_number, "Function call on newline- possible logic error.");
         }
         
-        if (!ignore_invalid_funcs && !block->isFunc(name)) {
+        if (!ignore_invalid_funcs && !block->isFunc(sym)) {
             syntax->addError(lex->line_number, "Unknown function call.");
             return false;
         }
     
-        std::shared_ptr<AstFuncCallExpr> fc = std::make_shared<AstFuncCallExpr>(name);
+        std::shared_ptr<AstFuncCallExpr> fc = AstContext::make<AstFuncCallExpr>(Symbol(name));
         std::shared_ptr<AstExpression> args = buildExpression(block, ctx->varType, t_rparen, false, true);
         fc->args = args;
         
@@ -128,21 +150,15 @@ bool Parser::build_identifier(std::shared_ptr<AstBlock> block, int tk, std::shar
         consume_token(t_id, "Expected identifier");
         std::string id_val = lex->value;
         
-        std::shared_ptr<AstStructAccess> val = std::make_shared<AstStructAccess>(name, id_val);
+        std::shared_ptr<AstStructAccess> val = AstContext::make<AstStructAccess>(Symbol(name), Symbol(id_val));
         ctx->output.push(val);
     } else {
-        int constVal = block->isConstant(name);
-        if (constVal > 0) {
-            if (constVal == 1) {
-                std::shared_ptr<AstExpression> expr = block->globalConsts[name].second;
-                ctx->output.push(expr);
-            } else if (constVal == 2) {
-                std::shared_ptr<AstExpression> expr = block->localConsts[name].second;
-                ctx->output.push(expr);
-            }
+        std::shared_ptr<AstExpression> constant = block->getConstant(sym);
+        if (constant != nullptr) {
+            ctx->output.push(constant);
         } else {
-            if (block->isVar(name)) {
-                std::shared_ptr<AstID> id = std::make_shared<AstID>(name);
+            if (block->isVar(sym)) {
+                std::shared_ptr<AstID> id = AstContext::make<AstID>(sym);
                 ctx->output.push(id);
             } else {
                 syntax->addError(lex->line_number, "Unknown variable: " + name);
@@ -163,6 +179,7 @@ bool Parser::is_constant(int tk) {
         case t_false:
         case t_char_literal:
         case t_int_literal:
+        case t_float_literal:
         case t_string_literal: return true;
         
         default: {}
@@ -19,15 +19,15 @@ std::shared_ptr<AstExpression> Parser::checkCondExpression(std::shared_ptr<AstBl
         case V_AstType::ID: {
             std::shared_ptr<AstID> id = std::static_pointer_cast<AstID>(toCheck);
             std::shared_ptr<AstDataType> dataType = block->getDataType(id->value);            
-            std::shared_ptr<AstEQOp> eq = std::make_shared<AstEQOp>();
+            std::shared_ptr<AstEQOp> eq = AstContext::make<AstEQOp>();
             eq->lval = id;
             
             switch (dataType->type) {
-                case V_AstType::Bool: eq->rval = std::make_shared<AstInt>(1); break;
-                case V_AstType::Int8: eq->rval = std::make_shared<AstInt>(1, 8); break;
-                case V_AstType::Int16: eq->rval = std::make_shared<AstInt>(1, 16); break;
-                case V_AstType::Int32: eq->rval = std::make_shared<AstInt>(1); break;
-                case V_AstType::Int64: eq->rval = std::make_shared<AstInt>(1, 64); break;
+                case V_AstType::Bool: eq->rval = AstContext::make<AstInt>(1); break;
+                case V_AstType::Int8: eq->rval = AstContext::make<AstInt>(1, 8); break;
+                case V_AstType::Int16: eq->rval = AstContext::make<AstInt>(1, 16); break;
+                case V_AstType::Int32: eq->rval = AstContext::make<AstInt>(1); break;
+                case V_AstType::Int64: eq->rval = AstContext::make<AstInt>(1, 64); break;
                 
                 default: {}
             }
@@ -36,9 +36,9 @@ std::shared_ptr<AstExpression> Parser::checkCondExpression(std::shared_ptr<AstBl
         } break;
         
         case V_AstType::IntL: {
-            std::shared_ptr<AstEQOp> eq = std::make_shared<AstEQOp>();
+            std::shared_ptr<AstEQOp> eq = AstContext::make<AstEQOp>();
             eq->lval = expr;
-            eq->rval = std::make_shared<AstInt>(1);
+            eq->rval = AstContext::make<AstInt>(1);
             expr = eq;
         } break;
         
@@ -50,7 +50,7 @@ std::shared_ptr<AstExpression> Parser::checkCondExpression(std::shared_ptr<AstBl
 
 // Builds a conditional statement
 bool Parser::buildConditional(std::shared_ptr<AstBlock> block) {
-    std::shared_ptr<AstIfStmt> cond = std::make_shared<AstIfStmt>();
+    std::shared_ptr<AstIfStmt> cond = AstContext::make<AstIfStmt>();
     std::shared_ptr<AstExpression> arg = buildExpression(block, nullptr, t_then);
     if (!arg) return false;
     cond->expression = arg;
@@ -59,12 +59,12 @@ bool Parser::buildConditional(std::shared_ptr<AstBlock> block) {
     std::shared_ptr<AstExpression> expr = checkCondExpression(block, cond->expression);
     cond->expression = expr;
     
-    std::shared_ptr<AstBlock> true_block = std::make_shared<AstBlock>();
-    true_block->mergeSymbols(block);
+    std::shared_ptr<AstBlock> true_block = AstContext::make<AstBlock>();
+    true_block->setParent(block);
     cond->true_block = true_block;
     
-    std::shared_ptr<AstBlock> false_block = std::make_shared<AstBlock>();
-    false_block->mergeSymbols(block);
+    std::shared_ptr<AstBlock> false_block = AstContext::make<AstBlock>();
+    false_block->setParent(block);
     cond->false_block = false_block;
     buildBlock(true_block, cond);
     
@@ -73,7 +73,7 @@ bool Parser::buildConditional(std::shared_ptr<AstBlock> block) {
 
 // Builds a while statement
 bool Parser::buildWhile(std::shared_ptr<AstBlock> block) {
-    std::shared_ptr<AstWhileStmt> loop = std::make_shared<AstWhileStmt>();
+    std::shared_ptr<AstWhileStmt> loop = AstContext::make<AstWhileStmt>();
     std::shared_ptr<AstExpression> arg = buildExpression(block, nullptr, t_do);
     if (!arg) return false;
     loop->expression = arg;
@@ -82,8 +82,8 @@ bool Parser::buildWhile(std::shared_ptr<AstBlock> block) {
     std::shared_ptr<AstExpression> expr = checkCondExpression(block, loop->expression);
     loop->expression = expr;
     
-    std::shared_ptr<AstBlock> block2 = std::make_shared<AstBlock>();
-    block2->mergeSymbols(block);
+    std::shared_ptr<AstBlock> block2 = AstContext::make<AstBlock>();
+    block2->setParent(block);
     buildBlock(block2);
     loop->block = block2;
     
@@ -92,8 +92,8 @@ bool Parser::buildWhile(std::shared_ptr<AstBlock> block) {
 
 // Builds a loop keyword
 bool Parser::buildLoopCtrl(std::shared_ptr<AstBlock> block, bool isBreak) {
-    if (isBreak) block->addStatement(std::make_shared<AstBreak>());
-    else block->addStatement(std::make_shared<AstContinue>());
+    if (isBreak) block->addStatement(AstContext::make<AstBreak>());
+    else block->addStatement(AstContext::make<AstContinue>());
     consume_token(t_semicolon, "Expected \';\' after break or continue.");
     return true;
 }
@@ -33,7 +33,7 @@ bool Parser::getFunctionArgs(std::shared_ptr<AstBlock> block, std::vector<Var> &
             }
             
             v.type = buildDataType();
-            v.name = name;
+            v.name = Symbol(name);
             
             tk = lex->get_next();
             if (tk == t_comma) {
@@ -63,10 +63,11 @@ bool Parser::buildFunction(int startToken, std::string className) {
     // Make sure we have a function name
     consume_token(t_id, "Expected function name.");
     std::string funcName = lex->value;
+    int line = lex->line_number + 1;
     
     // Get arguments
     std::vector<Var> args;
-    std::shared_ptr<AstBlock> block = std::make_shared<AstBlock>();
+    std::shared_ptr<AstBlock> block = AstContext::make<AstBlock>();
     if (!getFunctionArgs(block, args)) return false;
 
     // Check to see if there's any return type
@@ -89,21 +90,22 @@ bool Parser::buildFunction(int startToken, std::string className) {
     }
 
     // Create the function object
-    tree->block->funcs.push_back(funcName);
+    tree->block->funcs.insert(Symbol(funcName));
     
     if (isExtern) {
-        std::shared_ptr<AstExternFunction> ex = std::make_shared<AstExternFunction>(funcName);
+        std::shared_ptr<AstExternFunction> ex = AstContext::make<AstExternFunction>(Symbol(funcName));
         ex->args = args;
         ex->data_type = dataType;
         tree->addGlobalStatement(ex);
         return true;
     }
     
-    std::shared_ptr<AstFunction> func = std::make_shared<AstFunction>(funcName);
+    std::shared_ptr<AstFunction> func = AstContext::make<AstFunction>(Symbol(funcName));
     func->data_type = dataType;
     func->args = args;
+    func->line = line;
     tree->addGlobalStatement(func);
-    func->block->mergeSymbols(tree->block);
+    func->block->setParent(tree->block);
     func->block->mergeSymbols(block);
     
     // For the Java backend
@@ -127,7 +129,7 @@ bool Parser::buildFunction(int startToken, std::string className) {
         }
     } else {
         if (func->data_type->type == V_AstType::Void) {
-            func->addStatement(std::make_shared<AstReturnStmt>());
+            func->addStatement(AstContext::make<AstReturnStmt>());
         } else {
             syntax->addError(0, "Expected return statement.");
             return false;
@@ -141,12 +143,12 @@ bool Parser::buildFunction(int startToken, std::string className) {
 // TODO: Pass variable name in from block parser
 bool Parser::buildFunctionCallStmt(std::shared_ptr<AstBlock> block, std::string fc_name) {
     // Make sure the function exists
-    if (!ignore_invalid_funcs && !block->isFunc(fc_name)) {
+    if (!ignore_invalid_funcs && !block->isFunc(Symbol::find(fc_name))) {
         syntax->addError(0, "Unknown function.");
         return false;
     }
 
-    std::shared_ptr<AstFuncCallStmt> fc = std::make_shared<AstFuncCallStmt>(fc_name);
+    std::shared_ptr<AstFuncCallStmt> fc = AstContext::make<AstFuncCallStmt>(Symbol(fc_name));
     block->addStatement(fc);
     
     std::shared_ptr<AstExpression> args = buildExpression(block, nullptr, t_semicolon, false, true);
@@ -158,7 +160,7 @@ bool Parser::buildFunctionCallStmt(std::shared_ptr<AstBlock> block, std::string
 
 // Builds a return statement
 bool Parser::buildReturn(std::shared_ptr<AstBlock> block) {
-    std::shared_ptr<AstReturnStmt> stmt = std::make_shared<AstReturnStmt>();
+    std::shared_ptr<AstReturnStmt> stmt = AstContext::make<AstReturnStmt>();
     block->addStatement(stmt);
     
     std::shared_ptr<AstExpression> arg = buildExpression(block, nullptr, t_semicolon);
@@ -15,51 +15,52 @@
 Parser::Parser(std::string input, bool ignore_invalid_funcs) : BaseParser(input) {
     lex = std::make_unique<Lex>(input);
     this->ignore_invalid_funcs = ignore_invalid_funcs;
+    AstContext::Scope scope(tree->context);
     
     // Add the built-in functions
     //string malloc(string)
-    tree->block->funcs.push_back("malloc");
-    std::shared_ptr<AstExternFunction> FT1 = std::make_shared<AstExternFunction>("malloc");
-    FT1->addArgument(Var(AstBuilder::buildInt32Type(), "size"));
+    tree->block->funcs.insert(Symbol("malloc"));
+    std::shared_ptr<AstExternFunction> FT1 = AstContext::make<AstExternFunction>(Symbol("malloc"));
+    FT1->addArgument(Var(AstBuilder::buildInt32Type(), Symbol("size")));
     FT1->data_type = AstBuilder::buildStringType();
     tree->addGlobalStatement(FT1);
     
     //print(string)
-    tree->block->funcs.push_back("print");
-    std::shared_ptr<AstExternFunction> FT3 = std::make_shared<AstExternFunction>("print");
+    tree->block->funcs.insert(Symbol("print"));
+    std::shared_ptr<AstExternFunction> FT3 = AstContext::make<AstExternFunction>(Symbol("print"));
     FT3->varargs = true;
-    FT3->addArgument(Var(AstBuilder::buildStringType(), "str"));
+    FT3->addArgument(Var(AstBuilder::buildStringType(), Symbol("str")));
     FT3->data_type = AstBuilder::buildVoidType();
     tree->addGlobalStatement(FT3);
     
     //i32 strlen(string)
-    tree->block->funcs.push_back("strlen");
-    std::shared_ptr<AstExternFunction> FT4 = std::make_shared<AstExternFunction>("strlen");
-    FT4->addArgument(Var(AstBuilder::buildStringType(), "str"));
+    tree->block->funcs.insert(Symbol("strlen"));
+    std::shared_ptr<AstExternFunction> FT4 = AstContext::make<AstExternFunction>(Symbol("strlen"));
+    FT4->addArgument(Var(AstBuilder::buildStringType(), Symbol("str")));
     FT4->data_type = AstBuilder::buildInt32Type();
     tree->addGlobalStatement(FT4);
     
     //i32 stringcmp(string, string)
-    tree->block->funcs.push_back("stringcmp");
-    std::shared_ptr<AstExternFunction> FT5 = std::make_shared<AstExternFunction>("stringcmp");
-    FT5->addArgument(Var(AstBuilder::buildStringType(), "str"));
-    FT5->addArgument(Var(AstBuilder::buildStringType(), "str"));
+    tree->block->funcs.insert(Symbol("stringcmp"));
+    std::shared_ptr<AstExternFunction> FT5 = AstContext::make<AstExternFunction>(Symbol("stringcmp"));
+    FT5->addArgument(Var(AstBuilder::buildStringType(), Symbol("str")));
+    FT5->addArgument(Var(AstBuilder::buildStringType(), Symbol("str")));
     FT5->data_type = AstBuilder::buildInt32Type();
     tree->addGlobalStatement(FT5);
     
     //string strcat_str(string, string)
-    tree->block->funcs.push_back("strcat_str");
-    std::shared_ptr<AstExternFunction> FT6 = std::make_shared<AstExternFunction>("strcat_str");
-    FT6->addArgument(Var(AstBuilder::buildStringType(), "str"));
-    FT6->addArgument(Var(AstBuilder::buildStringType(), "str"));
+    tree->block->funcs.insert(Symbol("strcat_str"));
+    std::shared_ptr<AstExternFunction> FT6 = AstContext::make<AstExternFunction>(Symbol("strcat_str"));
+    FT6->addArgument(Var(AstBuilder::buildStringType(), Symbol("str")));
+    FT6->addArgument(Var(AstBuilder::buildStringType(), Symbol("str")));
     FT6->data_type = AstBuilder::buildStringType();
     tree->addGlobalStatement(FT6);
     
     //string strcat_char(string, char)
-    tree->block->funcs.push_back("strcat_char");
-    std::shared_ptr<AstExternFunction> FT7 = std::make_shared<AstExternFunction>("strcat_char");
-    FT7->addArgument(Var(AstBuilder::buildStringType(), "str"));
-    FT7->addArgument(Var(AstBuilder::buildCharType(), "c"));
+    tree->block->funcs.insert(Symbol("strcat_char"));
+    std::shared_ptr<AstExternFunction> FT7 = AstContext::make<AstExternFunction>(Symbol("strcat_char"));
+    FT7->addArgument(Var(AstBuilder::buildStringType(), Symbol("str")));
+    FT7->addArgument(Var(AstBuilder::buildCharType(), Symbol("c")));
     FT7->data_type = AstBuilder::buildStringType();
     tree->addGlobalStatement(FT7);
 }
@@ -68,6 +69,7 @@ Parser::~Parser() {
 }
 
 bool Parser::parse() {
+    AstContext::Scope scope(tree->context);
     int tk;
     do {
         tk = lex->get_next();
@@ -110,6 +112,8 @@ bool Parser::buildBlock(std::shared_ptr<AstBlock> block, std::shared_ptr<AstNode
     while (tk != t_end && tk != t_eof) {
         bool code = true;
         bool end = false;
+        int line = lex->line_number + 1;        // The lexer counts from 0
+        size_t first = block->block.size();
         
         switch (tk) {
             case t_var: code = buildVariableDec(block); break;
@@ -160,6 +164,11 @@ bool Parser::buildBlock(std::shared_ptr<AstBlock> block, std::shared_ptr<AstNode
             }
         }
         
+        // Every statement the token started gets its line
+        for (size_t i = first; i<block->block.size(); i++) {
+            if (block->block[i]->line == 0) block->block[i]->line = line;
+        }
+        
         if (end) break;
         if (!code) return false;
         tk = lex->get_next();
@@ -197,6 +206,8 @@ std::shared_ptr<AstDataType> Parser::buildDataType(bool checkBrackets) {
         case t_u32: dataType = AstBuilder::buildInt32Type(true); break;
         case t_i64: dataType = AstBuilder::buildInt64Type(); break;
         case t_u64: dataType = AstBuilder::buildInt64Type(true); break;
+        case t_f32: dataType = AstBuilder::buildFloat32Type(); break;
+        case t_f64: dataType = AstBuilder::buildFloat64Type(); break;
         case t_string: dataType = AstBuilder::buildStringType(); break;
         
         case t_id: {
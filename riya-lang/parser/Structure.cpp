@@ -22,7 +22,7 @@ bool Parser::buildStruct() {
     consume_token(t_is, "Expected \"is\".");
     
     // Builds the struct items
-    std::shared_ptr<AstStruct> str = std::make_shared<AstStruct>(name);
+    std::shared_ptr<AstStruct> str = AstContext::make<AstStruct>(Symbol(name));
     int tk = lex->get_next();
     
     while (tk != t_end && tk != t_eof) {
@@ -56,7 +56,7 @@ bool Parser::buildStructMember(std::shared_ptr<AstStruct> str, int tk) {
         if (!expr) return false;
                 
         Var v;
-        v.name = valName;
+        v.name = Symbol(valName);
         v.type = dataType;
         str->addItem(v, expr);
     } else {
@@ -92,8 +92,8 @@ bool Parser::buildStructDec(std::shared_ptr<AstBlock> block) {
     }
     
     // Now build the declaration and push back
-    block->addSymbol(name, AstBuilder::buildStructType(structName));
-    std::shared_ptr<AstStructDec> dec = std::make_shared<AstStructDec>(name, structName);
+    block->addSymbol(Symbol(name), AstBuilder::buildStructType(structName));
+    std::shared_ptr<AstStructDec> dec = AstContext::make<AstStructDec>(Symbol(name), Symbol(structName));
     block->addStatement(dec);
     
     // Final syntax check
@@ -102,12 +102,12 @@ bool Parser::buildStructDec(std::shared_ptr<AstBlock> block) {
         return true;
     } else if (tk == t_assign) {
         dec->no_init = true;
-        std::shared_ptr<AstExprStatement> empty = std::make_shared<AstExprStatement>();
+        std::shared_ptr<AstExprStatement> empty = AstContext::make<AstExprStatement>();
         std::shared_ptr<AstExpression> arg = buildExpression(block, AstBuilder::buildStructType(structName), t_semicolon);
         if (!arg) return false;
         
-        std::shared_ptr<AstID> id = std::make_shared<AstID>(name);
-        std::shared_ptr<AstAssignOp> assign = std::make_shared<AstAssignOp>(id, arg);
+        std::shared_ptr<AstID> id = AstContext::make<AstID>(dec->var_name);
+        std::shared_ptr<AstAssignOp> assign = AstContext::make<AstAssignOp>(id, arg);
         
         empty->expression = assign;
         block->addStatement(empty);
@@ -16,8 +16,8 @@
 // Builds a variable declaration
 bool Parser::buildVariableDec(std::shared_ptr<AstBlock> block) {
     int tk = lex->get_next();
-    std::vector<std::string> toDeclare;
-    toDeclare.push_back(lex->value);
+    std::vector<Symbol> toDeclare;
+    toDeclare.push_back(Symbol(lex->value));
     
     if (tk != t_id) {
         syntax->addError(lex->line_number, "Expected variable name.");
@@ -35,7 +35,7 @@ bool Parser::buildVariableDec(std::shared_ptr<AstBlock> block) {
                 return false;
             }
             
-            toDeclare.push_back(lex->value);
+            toDeclare.push_back(Symbol(lex->value));
         } else if (tk != t_colon) {
             syntax->addError(lex->line_number, "Invalt_id tk in variable declaration.");
             return false;
@@ -56,14 +56,14 @@ bool Parser::buildVariableDec(std::shared_ptr<AstBlock> block) {
     std::shared_ptr<AstExpression> arg = buildExpression(block, dataType, t_semicolon);
     if (!arg) return false;
 
-    for (std::string name : toDeclare) {
-        std::shared_ptr<AstVarDec> vd = std::make_shared<AstVarDec>(name, dataType);
+    for (Symbol name : toDeclare) {
+        std::shared_ptr<AstVarDec> vd = AstContext::make<AstVarDec>(name, dataType);
         block->addStatement(vd);
         
-        std::shared_ptr<AstID> id = std::make_shared<AstID>(name);
-        std::shared_ptr<AstAssignOp> assign = std::make_shared<AstAssignOp>(id, arg);
+        std::shared_ptr<AstID> id = AstContext::make<AstID>(name);
+        std::shared_ptr<AstAssignOp> assign = AstContext::make<AstAssignOp>(id, arg);
         
-        std::shared_ptr<AstExprStatement> va = std::make_shared<AstExprStatement>();
+        std::shared_ptr<AstExprStatement> va = AstContext::make<AstExprStatement>();
         va->setDataType(dataType);
         va->expression = assign;
         block->addStatement(va);
@@ -81,7 +81,7 @@ bool Parser::buildVariableDec(std::shared_ptr<AstBlock> block) {
 bool Parser::build_array_dec(std::shared_ptr<AstBlock> block) {
     // Get the array name
     consume_token(t_id, "Expected array name.");
-    std::string name = lex->value;
+    Symbol name(lex->value);
     
     // Get the colon
     consume_token(t_colon, "Expected \':\'.");
@@ -98,34 +98,34 @@ bool Parser::build_array_dec(std::shared_ptr<AstBlock> block) {
     
     consume_token(t_semicolon, "Error: Expected \';\'.");
     
-    std::shared_ptr<AstVarDec> vd = std::make_shared<AstVarDec>(name, dataType);
+    std::shared_ptr<AstVarDec> vd = AstContext::make<AstVarDec>(name, dataType);
     block->addStatement(vd);
     vd->expression = arg;
     
     // Create an assignment to a malloc call
-    std::shared_ptr<AstExprStatement> va = std::make_shared<AstExprStatement>();
+    std::shared_ptr<AstExprStatement> va = AstContext::make<AstExprStatement>();
     va->setDataType(dataType);
     block->addStatement(va);
     
-    std::shared_ptr<AstID> id = std::make_shared<AstID>(name);
-    std::shared_ptr<AstFuncCallExpr> callMalloc = std::make_shared<AstFuncCallExpr>("malloc");
-    std::shared_ptr<AstAssignOp> assign = std::make_shared<AstAssignOp>(id, callMalloc);
+    std::shared_ptr<AstID> id = AstContext::make<AstID>(name);
+    std::shared_ptr<AstFuncCallExpr> callMalloc = AstContext::make<AstFuncCallExpr>(Symbol("malloc"));
+    std::shared_ptr<AstAssignOp> assign = AstContext::make<AstAssignOp>(id, callMalloc);
     
     va->expression = assign;
     
     // In order to get a proper malloc, we need to multiply the argument by
     // the size of the type. Get the arguments, and do that
-    std::shared_ptr<AstExprList> list = std::make_shared<AstExprList>();
+    std::shared_ptr<AstExprList> list = AstContext::make<AstExprList>();
     callMalloc->args = list;
     
     std::shared_ptr<AstInt> size;
     std::shared_ptr<AstDataType> baseType = std::static_pointer_cast<AstPointerType>(dataType)->base_type;
-    if (baseType->type == V_AstType::Int32) size = std::make_shared<AstInt>(4);
-    else if (baseType->type == V_AstType::Int64) size = std::make_shared<AstInt>(8);
-    else if (baseType->type == V_AstType::String) size = std::make_shared<AstInt>(8);
-    else size = std::make_shared<AstInt>(1);
+    if (baseType->type == V_AstType::Int32) size = AstContext::make<AstInt>(4);
+    else if (baseType->type == V_AstType::Int64) size = AstContext::make<AstInt>(8);
+    else if (baseType->type == V_AstType::String) size = AstContext::make<AstInt>(8);
+    else size = AstContext::make<AstInt>(1);
     
-    std::shared_ptr<AstMulOp> op = std::make_shared<AstMulOp>();
+    std::shared_ptr<AstMulOp> op = AstContext::make<AstMulOp>();
     op->lval = size;
     op->rval = vd->expression;
     list->add_expression(op);
@@ -137,12 +137,12 @@ bool Parser::build_array_dec(std::shared_ptr<AstBlock> block) {
 
 // Builds a variable or an array assignment
 bool Parser::buildVariableAssign(std::shared_ptr<AstBlock> block, std::string value) {
-    std::shared_ptr<AstDataType> dataType = block->getDataType(value);
+    std::shared_ptr<AstDataType> dataType = block->getDataType(Symbol::find(value));
     
     std::shared_ptr<AstExpression> expr = buildExpression(block, dataType, t_semicolon);
     if (!expr) return false;
     
-    std::shared_ptr<AstExprStatement> stmt = std::make_shared<AstExprStatement>();
+    std::shared_ptr<AstExprStatement> stmt = AstContext::make<AstExprStatement>();
     stmt->setDataType(dataType);
     stmt->expression = expr;
     block->addStatement(stmt);
@@ -154,7 +154,7 @@ bool Parser::buildVariableAssign(std::shared_ptr<AstBlock> block, std::string va
 bool Parser::buildConst(std::shared_ptr<AstBlock> block, bool isGlobal) {
     // Make sure we have a name for our constant
     consume_token(t_id, "Expected constant name.");
-    std::string name = lex->value;
+    Symbol name(lex->value);
     
     // Syntax check
     consume_token(t_colon, "Expected \':\' in constant expression.");